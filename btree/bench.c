@@ -0,0 +1,655 @@
+/*
+ * Měření výkonu binárního vyhledávacího stromu.
+ *
+ * Výstup je ve formátu CSV popsaném v common/bench.c. Základní operace se
+ * měří pro náhodné, seřazené a Zipfovy klíče s počtem operací od
+ * BENCH_MIN_OPS do max_operací (po násobcích deseti). Vyhledávání podle
+ * stejných posloupností klíčů se dále porovnává se splay stromem (splay.c),
+ * oba stromy přitom obsahují všechny klíče vložené v náhodném pořadí.
+ * Odstraňování se dále měří ve stromu s náhrobky (lazy.c), včetně
+ * průběžného zhušťování.
+ * Sloučení dvou stromů se sčítáním hodnot se měří jako vložení uzlů
+ * jednoho stromu do druhého a jako bst_union (setops.c) pro 1 až max_vláken
+ * vláken.
+ *
+ * Použití: ./bench [max_vláken] [opakování] [max_operací]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "../common/bench.h"
+#include "btree.h"
+#include "bulk.h"
+#include "character_store.h"
+#include "concurrent.h"
+#include "lazy.h"
+#include "parallel.h"
+#include "perf.h"
+#include "setops.h"
+#include "splay.h"
+#include <limits.h>
+#include <pthread.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/*
+ * Sestaví strom se všemi možnými klíči typu char.
+ */
+static int build_full_tree(bst_node_t **tree)
+{
+  char keys[UCHAR_MAX + 1];
+  bst_node_content_t values[UCHAR_MAX + 1];
+  int count = 0;
+
+  for (int key = CHAR_MIN; key <= CHAR_MAX; key++)
+  {
+    keys[count] = (char)key;
+    values[count].type = INTEGER;
+    values[count].value = malloc(sizeof(int));
+    *(int *)values[count].value = key;
+    count++;
+  }
+  bst_build_from_unsorted(tree, keys, values, count, false);
+  return count;
+}
+
+static void bench_parallel(int max_threads, int rounds)
+{
+  bst_node_t *tree;
+  bst_items_t items = {NULL, 0, 0};
+
+  for (int threads = 1; threads <= max_threads; threads++)
+  {
+    int count = build_full_tree(&tree);
+    double start = bench_now_ns();
+    for (int i = 0; i < rounds; i++)
+    {
+      items.size = 0;
+      bst_inorder_parallel(tree, &items, threads);
+    }
+    bench_report("inorder_parallel", "-", threads, rounds, count,
+                 bench_now_ns() - start);
+    bst_dispose(&tree);
+
+    double elapsed = 0;
+    for (int i = 0; i < rounds; i++)
+    {
+      build_full_tree(&tree);
+      start = bench_now_ns();
+      bst_dispose_parallel(&tree, threads);
+      elapsed += bench_now_ns() - start;
+    }
+    bench_report("dispose_parallel", "-", threads, rounds, count, elapsed);
+  }
+  free(items.nodes);
+}
+
+static unsigned next_random(unsigned *state)
+{
+  *state ^= *state << 13;
+  *state ^= *state >> 17;
+  *state ^= *state << 5;
+  return *state;
+}
+
+static bst_node_content_t bench_content(int value)
+{
+  bst_node_content_t content = {.type = INTEGER, .value = malloc(sizeof(int))};
+  *(int *)content.value = value;
+  return content;
+}
+
+// Největší výška stromu, pro kterou se měří průchody (iterativní průchody
+// mají zásobník pevné velikosti, viz iter/Makefile)
+#ifndef BST_TRAVERSAL_MAX_HEIGHT
+#define BST_TRAVERSAL_MAX_HEIGHT INT_MAX
+#endif
+
+// Počet odstranění, po kterých se odstraněné klíče vrátí do stromu
+#define DELETE_BATCH (UCHAR_MAX + 1)
+
+/*
+ * Pomocná funkce pro převod vygenerovaného klíče na klíč stromu.
+ */
+static char bench_tree_key(int key)
+{
+  return (char)(CHAR_MIN + key);
+}
+
+/*
+ * Pomocná funkce pro výpočet výšky stromu.
+ */
+static int bench_tree_height(bst_node_t *tree)
+{
+  if (tree == NULL)
+  {
+    return 0;
+  }
+  int left = bench_tree_height(tree->left);
+  int right = bench_tree_height(tree->right);
+  return 1 + (left > right ? left : right);
+}
+
+/*
+ * Vkládání, vyhledávání, průchody a odstraňování pro ops klíčů
+ * s rozdělením distribution.
+ */
+static void bench_tree_operations(bench_distribution_t distribution, long ops)
+{
+  const char *name = bench_distribution_name(distribution);
+  int key_space = UCHAR_MAX + 1;
+  int *keys = malloc(ops * sizeof(int));
+  bst_items_t items = {NULL, 0, 0};
+  bst_node_content_t *found;
+  bst_node_t *tree;
+  long hits = 0;
+
+  bench_keys(distribution, keys, ops, key_space, 2463534242u + distribution);
+
+  bst_init(&tree);
+  double start = bench_now_ns();
+  for (long i = 0; i < ops; i++)
+  {
+    bst_insert(&tree, bench_tree_key(keys[i]), bench_content(i));
+  }
+  bench_report("insert", name, 1, ops, key_space, bench_now_ns() - start);
+
+  start = bench_now_ns();
+  for (long i = 0; i < ops; i++)
+  {
+    hits += bst_search(tree, bench_tree_key(keys[i]), &found);
+  }
+  bench_report("search", name, 1, ops, key_space, bench_now_ns() - start);
+
+  void (*traversals[])(bst_node_t *, bst_items_t *) = {
+      bst_preorder, bst_inorder, bst_postorder};
+  const char *traversal_names[] = {"preorder", "inorder", "postorder"};
+  int height = bench_tree_height(tree);
+  for (int t = 0; t < 3 && height > BST_TRAVERSAL_MAX_HEIGHT; t++)
+  {
+    fprintf(stderr, "[W] Skipping %s of a tree with height %d\n",
+            traversal_names[t], height);
+  }
+  for (int t = 0; t < 3 && height <= BST_TRAVERSAL_MAX_HEIGHT; t++)
+  {
+    long visited = 0;
+    start = bench_now_ns();
+    while (visited < ops)
+    {
+      items.size = 0;
+      traversals[t](tree, &items);
+      visited += items.size;
+    }
+    bench_report(traversal_names[t], name, 1, visited, key_space,
+                 bench_now_ns() - start);
+  }
+
+  double elapsed = 0;
+  for (long batch = 0; batch < ops; batch += DELETE_BATCH)
+  {
+    long end = batch + DELETE_BATCH < ops ? batch + DELETE_BATCH : ops;
+    start = bench_now_ns();
+    for (long i = batch; i < end; i++)
+    {
+      bst_delete(&tree, bench_tree_key(keys[i]));
+    }
+    elapsed += bench_now_ns() - start;
+    for (long i = batch; i < end; i++)
+    {
+      bst_insert(&tree, bench_tree_key(keys[i]), bench_content(i));
+    }
+  }
+  bench_report("delete", name, 1, ops, key_space, elapsed);
+
+  if (hits != ops)
+  {
+    fprintf(stderr, "[W] Search missed inserted keys\n");
+  }
+  bst_dispose(&tree);
+  free(items.nodes);
+  free(keys);
+}
+
+/*
+ * Vyhledávání ops klíčů s rozdělením distribution v obyčejném a splay
+ * stromu. Oba stromy obsahují všechny klíče vložené ve stejném náhodném
+ * pořadí, takže poloha často hledaných klíčů na něm nezávisí.
+ */
+static void bench_splay_operations(bench_distribution_t distribution,
+                                   long ops)
+{
+  const char *name = bench_distribution_name(distribution);
+  int key_space = UCHAR_MAX + 1;
+  int *keys = malloc(ops * sizeof(int));
+  int order[UCHAR_MAX + 1];
+  bst_node_content_t *found;
+  bst_node_t *tree;
+  bst_node_t *splay_tree;
+  uint64_t state = 88172645463325252u;
+  long hits = 0;
+
+  bench_keys(distribution, keys, ops, key_space, 2463534242u + distribution);
+  for (int i = 0; i < key_space; i++)
+  {
+    order[i] = i;
+  }
+  for (int i = key_space - 1; i > 0; i--)
+  {
+    int j = bench_random(&state) % (i + 1);
+    int swap = order[i];
+    order[i] = order[j];
+    order[j] = swap;
+  }
+
+  bst_init(&tree);
+  bst_init(&splay_tree);
+  for (int i = 0; i < key_space; i++)
+  {
+    bst_insert(&tree, bench_tree_key(order[i]), bench_content(i));
+    bst_splay_insert(&splay_tree, bench_tree_key(order[i]), bench_content(i));
+  }
+
+  double start = bench_now_ns();
+  for (long i = 0; i < ops; i++)
+  {
+    hits += bst_search(tree, bench_tree_key(keys[i]), &found);
+  }
+  bench_report("shuffled_search", name, 1, ops, key_space,
+               bench_now_ns() - start);
+
+  start = bench_now_ns();
+  for (long i = 0; i < ops; i++)
+  {
+    hits -= bst_splay_search(&splay_tree, bench_tree_key(keys[i]), &found);
+  }
+  bench_report("splay_search", name, 1, ops, key_space,
+               bench_now_ns() - start);
+
+  if (hits != 0)
+  {
+    fprintf(stderr, "[W] Search and splay search disagree\n");
+  }
+  bst_splay_dispose(&splay_tree);
+  bst_dispose(&tree);
+  free(keys);
+}
+
+/*
+ * Odstraňování a vyhledávání ve stromu s náhrobky pro ops klíčů
+ * s rozdělením distribution, měřené stejně jako v bench_tree_operations.
+ */
+static void bench_lazy_operations(bench_distribution_t distribution, long ops)
+{
+  const char *name = bench_distribution_name(distribution);
+  int key_space = UCHAR_MAX + 1;
+  int *keys = malloc(ops * sizeof(int));
+  bst_node_content_t *found;
+  bst_lazy_t tree;
+  long hits = 0;
+
+  bench_keys(distribution, keys, ops, key_space, 2463534242u + distribution);
+
+  bst_lazy_init(&tree);
+  for (long i = 0; i < ops; i++)
+  {
+    bst_lazy_insert(&tree, bench_tree_key(keys[i]), bench_content(i));
+  }
+
+  double elapsed = 0;
+  for (long batch = 0; batch < ops; batch += DELETE_BATCH)
+  {
+    long end = batch + DELETE_BATCH < ops ? batch + DELETE_BATCH : ops;
+    double start = bench_now_ns();
+    for (long i = batch; i < end; i++)
+    {
+      bst_lazy_delete(&tree, bench_tree_key(keys[i]));
+    }
+    elapsed += bench_now_ns() - start;
+    for (long i = batch; i < end; i++)
+    {
+      bst_lazy_insert(&tree, bench_tree_key(keys[i]), bench_content(i));
+    }
+  }
+  bench_report("lazy_delete", name, 1, ops, key_space, elapsed);
+
+  double start = bench_now_ns();
+  for (long i = 0; i < ops; i++)
+  {
+    hits += bst_lazy_search(&tree, bench_tree_key(keys[i]), &found);
+  }
+  bench_report("lazy_search", name, 1, ops, key_space,
+               bench_now_ns() - start);
+
+  if (hits != ops)
+  {
+    fprintf(stderr, "[W] Lazy search missed inserted keys\n");
+  }
+  bst_lazy_dispose(&tree);
+  free(keys);
+}
+
+static void bench_tree(long max_ops)
+{
+  for (int distribution = 0; distribution < BENCH_DISTRIBUTIONS;
+       distribution++)
+  {
+    for (long ops = BENCH_MIN_OPS; ops <= max_ops; ops *= 10)
+    {
+      bench_tree_operations(distribution, ops);
+      bench_splay_operations(distribution, ops);
+      bench_lazy_operations(distribution, ops);
+    }
+  }
+}
+
+/*
+ * Pomocná funkce pro sestavení dvou treapů z náhodných polovin klíčů.
+ */
+static void bench_set_trees(bst_node_t **tree, bst_node_t **other,
+                            uint64_t *state)
+{
+  bst_init(tree);
+  bst_init(other);
+  for (int key = 0; key <= UCHAR_MAX; key++)
+  {
+    uint64_t r = bench_random(state);
+    if (r & 1)
+    {
+      bst_treap_insert(tree, bench_tree_key(key), bench_content(key));
+    }
+    if (r & 2)
+    {
+      bst_treap_insert(other, bench_tree_key(key), bench_content(key));
+    }
+  }
+}
+
+/*
+ * Sloučení dvou stromů se sčítáním hodnot: vložením všech uzlů druhého
+ * stromu do prvního a funkcí bst_union.
+ */
+static void bench_setops(int max_threads, int rounds)
+{
+  bst_items_t items = {NULL, 0, 0};
+  bst_node_t *tree;
+  bst_node_t *other;
+  uint64_t state = 88172645463325252u;
+  double elapsed = 0;
+
+  for (int i = 0; i < rounds; i++)
+  {
+    bench_set_trees(&tree, &other, &state);
+    double start = bench_now_ns();
+    items.size = 0;
+    bst_inorder(other, &items);
+    for (int j = 0; j < items.size; j++)
+    {
+      bst_node_content_t *found;
+      bst_node_t *node = items.nodes[j];
+      if (bst_search(tree, node->key, &found))
+      {
+        bst_merge_sum(found, &node->content);
+      }
+      else
+      {
+        bst_insert(&tree, node->key, bench_content(*(int *)node->content.value));
+      }
+    }
+    bst_dispose(&other);
+    elapsed += bench_now_ns() - start;
+    bst_dispose(&tree);
+  }
+  bench_report("merge_insert", "-", 1, rounds, UCHAR_MAX + 1, elapsed);
+
+  for (int threads = 1; threads <= max_threads; threads++)
+  {
+    elapsed = 0;
+    for (int i = 0; i < rounds; i++)
+    {
+      bench_set_trees(&tree, &other, &state);
+      double start = bench_now_ns();
+      bst_union(&tree, &other, bst_merge_sum, threads);
+      elapsed += bench_now_ns() - start;
+      bst_dispose(&tree);
+    }
+    bench_report("union", "-", threads, rounds, UCHAR_MAX + 1, elapsed);
+  }
+  free(items.nodes);
+}
+
+// Počet klíčů, se kterými pracuje smíšená zátěž
+#define MIXED_KEYS 128
+// Podíl zápisů ve smíšené zátěži v procentech
+#define MIXED_WRITE_PERCENT 10
+
+// Parametry vlákna smíšené zátěže
+typedef struct mixed_worker {
+  bst_conc_t *conc_tree;     // souběžný strom, nebo NULL
+  bst_node_t **tree;         // strom chráněný zámkem lock
+  pthread_rwlock_t *lock;    // zámek celého stromu
+  unsigned seed;             // semínko generátoru klíčů
+  int ops;                   // počet operací
+} mixed_worker_t;
+
+/*
+ * Smíšená zátěž — vyhledávání s MIXED_WRITE_PERCENT procenty vkládání
+ * a odstraňování náhodných klíčů.
+ */
+static void *mixed_worker(void *arg)
+{
+  mixed_worker_t *worker = arg;
+  bst_node_content_t *found;
+  bst_node_content_t copy;
+
+  for (int i = 0; i < worker->ops; i++)
+  {
+    unsigned r = next_random(&worker->seed);
+    char key = (char)(r % MIXED_KEYS);
+    bool write = (r >> 8) % 100 < MIXED_WRITE_PERCENT;
+    bool insert = (r >> 16) & 1;
+
+    if (worker->conc_tree != NULL)
+    {
+      if (!write)
+      {
+        bst_conc_search(worker->conc_tree, key, &copy);
+      }
+      else if (insert)
+      {
+        bst_conc_insert(worker->conc_tree, key, bench_content(i));
+      }
+      else
+      {
+        bst_conc_delete(worker->conc_tree, key);
+      }
+    }
+    else if (!write)
+    {
+      pthread_rwlock_rdlock(worker->lock);
+      bst_search(*worker->tree, key, &found);
+      pthread_rwlock_unlock(worker->lock);
+    }
+    else
+    {
+      pthread_rwlock_wrlock(worker->lock);
+      if (insert)
+      {
+        bst_insert(worker->tree, key, bench_content(i));
+      }
+      else
+      {
+        bst_delete(worker->tree, key);
+      }
+      pthread_rwlock_unlock(worker->lock);
+    }
+  }
+  if (worker->conc_tree != NULL)
+  {
+    bst_conc_thread_exit();
+  }
+  return NULL;
+}
+
+/*
+ * Propustnost smíšené zátěže pro souběžný strom a pro strom chráněný
+ * jedním zámkem pro čtení a zápis.
+ */
+static void bench_mixed(int max_threads, int rounds)
+{
+  pthread_t threads[max_threads];
+  mixed_worker_t workers[max_threads];
+  int ops = rounds * 100;
+
+  for (int count = 1; count <= max_threads; count++)
+  {
+    for (int variant = 0; variant < 2; variant++)
+    {
+      bst_conc_t conc_tree;
+      bst_node_t *tree;
+      pthread_rwlock_t lock;
+
+      bst_conc_init(&conc_tree);
+      bst_init(&tree);
+      pthread_rwlock_init(&lock, NULL);
+      for (int key = 0; key < MIXED_KEYS; key += 2)
+      {
+        if (variant == 0)
+        {
+          bst_conc_insert(&conc_tree, key, bench_content(key));
+        }
+        else
+        {
+          bst_insert(&tree, key, bench_content(key));
+        }
+      }
+
+      double start = bench_now_ns();
+      for (int i = 0; i < count; i++)
+      {
+        workers[i].conc_tree = variant == 0 ? &conc_tree : NULL;
+        workers[i].tree = &tree;
+        workers[i].lock = &lock;
+        workers[i].seed = 2463534242u + i;
+        workers[i].ops = ops;
+        pthread_create(&threads[i], NULL, mixed_worker, &workers[i]);
+      }
+      for (int i = 0; i < count; i++)
+      {
+        pthread_join(threads[i], NULL);
+      }
+      bench_report(variant == 0 ? "mixed_concurrent" : "mixed_rwlock", "-",
+                   count, (long)ops * count, MIXED_KEYS / 2,
+                   bench_now_ns() - start);
+
+      bst_conc_dispose(&conc_tree);
+      bst_dispose(&tree);
+      pthread_rwlock_destroy(&lock);
+    }
+  }
+}
+
+// Počet postav pro měření filtru
+#define STORE_CHARACTERS (1 << 21)
+
+/*
+ * Dotaz "Wizard od úrovně 10" nad sloupcovým úložištěm a nad samostatně
+ * alokovanými záznamy character_t.
+ */
+static void bench_store(int rounds)
+{
+  character_store_t store;
+  character_t **records = malloc(STORE_CHARACTERS * sizeof(character_t *));
+  int *found = malloc(STORE_CHARACTERS * sizeof(int));
+  unsigned seed = 2463534242u;
+  char name[32];
+
+  character_store_init(&store);
+  for (int i = 0; i < STORE_CHARACTERS; i++)
+  {
+    unsigned r = next_random(&seed);
+    snprintf(name, sizeof(name), "Hero%u", r % 100000);
+    character_class_t character_class = r % (Fighter + 1);
+    unsigned char level = (r >> 20) % 21;
+
+    character_store_add(&store, name, character_class, level);
+    records[i] = malloc(sizeof(character_t));
+    records[i]->name = malloc(strlen(name) + 1);
+    strcpy(records[i]->name, name);
+    records[i]->character_class = character_class;
+    records[i]->level = level;
+  }
+
+  long expected = 0;
+  long counted = 0;
+  long filtered = 0;
+  double start = bench_now_ns();
+  for (int round = 0; round < rounds; round++)
+  {
+    for (int i = 0; i < STORE_CHARACTERS; i++)
+    {
+      expected += records[i]->character_class == Wizard && records[i]->level >= 10;
+    }
+  }
+  bench_report("filter_records", "-", 1, (long)rounds * STORE_CHARACTERS,
+               STORE_CHARACTERS, bench_now_ns() - start);
+
+  start = bench_now_ns();
+  for (int round = 0; round < rounds; round++)
+  {
+    counted += character_store_count(&store, Wizard, 10);
+  }
+  bench_report("count_store", "-", 1, (long)rounds * STORE_CHARACTERS,
+               STORE_CHARACTERS, bench_now_ns() - start);
+
+  start = bench_now_ns();
+  for (int round = 0; round < rounds; round++)
+  {
+    filtered += character_store_filter(&store, Wizard, 10, found);
+  }
+  bench_report("filter_store", "-", 1, (long)rounds * STORE_CHARACTERS,
+               STORE_CHARACTERS, bench_now_ns() - start);
+
+  if (counted != expected || filtered != expected)
+  {
+    fprintf(stderr, "[W] Store and record filters disagree\n");
+  }
+
+  for (int i = 0; i < STORE_CHARACTERS; i++)
+  {
+    free(records[i]->name);
+    free(records[i]);
+  }
+  free(records);
+  free(found);
+  character_store_dispose(&store);
+}
+
+int main(int argc, char *argv[])
+{
+  int max_threads = argc > 1 ? atoi(argv[1]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+  int rounds = argc > 2 ? atoi(argv[2]) : 1000;
+  long max_ops = argc > 3 ? atol(argv[3]) : BENCH_DEFAULT_MAX_OPS;
+
+  if (max_threads < 1)
+  {
+    max_threads = 1;
+  }
+  if (rounds < 1)
+  {
+    rounds = 1;
+  }
+
+  // Měříme samotné paralelní zpracování i pro malé stromy
+  bst_set_parallel_cutoff(0);
+
+  bench_header();
+  bench_tree(max_ops);
+  bench_parallel(max_threads, rounds);
+  bench_setops(max_threads, rounds);
+  bench_mixed(max_threads, rounds);
+  bench_store(rounds / 100 > 0 ? rounds / 100 : 1);
+  BST_PERF_REPORT(stderr);
+  return 0;
+}
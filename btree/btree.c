@@ -1,5 +1,6 @@
 #include "btree.h"
 #include "character.h"
+#include "dump.h"
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -8,9 +9,10 @@
  */
 void bst_print_node(bst_node_t *node)
 {
-  printf("[%c,", node->key);
-  bst_print_node_content(&node->content);
-  printf("]");
+  writer_t writer;
+  writer_init(&writer, stdout);
+  bst_write_node(&writer, node);
+  writer_flush(&writer);
 }
 
 /*
@@ -18,24 +20,10 @@ void bst_print_node(bst_node_t *node)
  */
 void bst_print_node_content(bst_node_content_t *content)
 {
-  if (content == NULL)
-  {
-    printf("NULL");
-    return;
-  }
-  switch (content->type)
-  {
-  case INTEGER:
-    printf("%d",*(int *)content->value);
-    break;
-
-  case CHARACTER_T:
-    print_character((character_t*)content->value);
-
-  default:
-    printf("Unknown");
-    break;
-  }
+  writer_t writer;
+  writer_init(&writer, stdout);
+  bst_write_node_content(&writer, content);
+  writer_flush(&writer);
 }
 
 
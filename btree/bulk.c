@@ -0,0 +1,194 @@
+/*
+ * Hromadné sestavení binárního vyhledávacího stromu
+ *
+ * Místo postupného vkládání klíčů funkcí bst_insert (pro seřazený vstup
+ * degraduje strom na lineární seznam a celková složitost je O(n^2)) se strom
+ * sestaví přímo jako výškově vyvážený v čase O(n).
+ *
+ * Uzly lze volitelně alokovat v jednom souvislém bloku. Takový strom má uzly
+ * uložené v pořadí preorder, kořen je prvním prvkem bloku a musí se uvolnit
+ * funkcí bst_dispose_contiguous. Do struktury souvislého stromu se nesmí
+ * zasahovat funkcemi bst_insert, bst_delete ani bst_dispose.
+ */
+
+#include "bulk.h"
+#include <limits.h>
+#include <stdlib.h>
+
+/*
+ * Pomocná funkce pro sestavení podstromu z prvků order[low..high].
+ *
+ * Kořenem podstromu se stane prostřední prvek, levý a pravý podstrom se
+ * sestaví ze zbývajících polovin. Pokud je block různý od NULL, berou se uzly
+ * postupně z bloku (index next), jinak se alokují samostatně.
+ */
+static bst_node_t *bst_build_range(const char keys[],
+                                   const bst_node_content_t values[],
+                                   const int order[], int low, int high,
+                                   bst_node_t *block, int *next)
+{
+  if (low > high)
+  {
+    return NULL;
+  }
+
+  int mid = low + (high - low) / 2;
+  bst_node_t *node = block != NULL ? &block[(*next)++]
+                                   : malloc(sizeof(bst_node_t));
+  if (node == NULL)
+  {
+    return NULL;
+  }
+
+  node->key = keys[order[mid]];
+  node->content = values[order[mid]];
+  node->left = bst_build_range(keys, values, order, low, mid - 1, block, next);
+  node->right = bst_build_range(keys, values, order, mid + 1, high, block, next);
+  return node;
+}
+
+/*
+ * Pomocná funkce která sestaví strom z prvků určených polem indexů order.
+ *
+ * Indexy musí být seřazené vzestupně podle klíče a klíče se nesmí opakovat.
+ */
+static void bst_build_from_order(bst_node_t **tree, const char keys[],
+                                 const bst_node_content_t values[],
+                                 const int order[], int count, bool contiguous)
+{
+  bst_node_t *block = NULL;
+  int next = 0;
+
+  if (count == 0)
+  {
+    return;
+  }
+  if (contiguous)
+  {
+    block = malloc(count * sizeof(bst_node_t));
+    if (block == NULL)
+    {
+      return;
+    }
+  }
+
+  *tree = bst_build_range(keys, values, order, 0, count - 1, block, &next);
+}
+
+/*
+ * Sestavení vyváženého stromu ze seřazeného vstupu.
+ *
+ * Funkce inicializuje strom a vloží do něj count dvojic keys[i], values[i].
+ * Klíče musí být seřazené neklesajícím způsobem. Pro opakující se klíč platí
+ * stejně jako u bst_insert poslední hodnota, obsah předchozích se uvolní.
+ * Strom přebírá vlastnictví hodnot.
+ *
+ * Výsledný strom má minimální výšku a sestaví se v čase O(n).
+ */
+void bst_build_from_sorted(bst_node_t **tree, const char keys[],
+                           const bst_node_content_t values[], int count,
+                           bool contiguous)
+{
+  bst_init(tree);
+
+  int *order = malloc((count > 0 ? count : 1) * sizeof(int));
+  if (order == NULL)
+  {
+    return;
+  }
+
+  int unique = 0;
+  for (int i = 0; i < count; i++)
+  {
+    if (unique > 0 && keys[order[unique - 1]] == keys[i])
+    {
+      if (values[order[unique - 1]].value != NULL)
+      {
+        free(values[order[unique - 1]].value);
+      }
+      order[unique - 1] = i;
+    }
+    else
+    {
+      order[unique++] = i;
+    }
+  }
+
+  bst_build_from_order(tree, keys, values, order, unique, contiguous);
+  free(order);
+}
+
+/*
+ * Sestavení vyváženého stromu z neseřazeného vstupu.
+ *
+ * Chová se stejně jako bst_build_from_sorted, klíče však mohou být
+ * v libovolném pořadí. Protože jsou klíče typu char, seřadí se počítáním
+ * výskytů v čase O(n) a výsledný strom je shodný s tím, který by vznikl
+ * z předem seřazeného vstupu.
+ */
+void bst_build_from_unsorted(bst_node_t **tree, const char keys[],
+                             const bst_node_content_t values[], int count,
+                             bool contiguous)
+{
+  int last[UCHAR_MAX + 1];
+  int order[UCHAR_MAX + 1];
+  int unique = 0;
+
+  bst_init(tree);
+
+  for (int i = 0; i <= UCHAR_MAX; i++)
+  {
+    last[i] = -1;
+  }
+
+  for (int i = 0; i < count; i++)
+  {
+    unsigned char slot = (unsigned char)keys[i];
+    if (last[slot] >= 0 && values[last[slot]].value != NULL)
+    {
+      free(values[last[slot]].value);
+    }
+    last[slot] = i;
+  }
+
+  // Průchod v pořadí, v jakém klíče porovnává strom (char může být znaménkový)
+  for (int key = CHAR_MIN; key <= CHAR_MAX; key++)
+  {
+    unsigned char slot = (unsigned char)key;
+    if (last[slot] >= 0)
+    {
+      order[unique++] = last[slot];
+    }
+  }
+
+  bst_build_from_order(tree, keys, values, order, unique, contiguous);
+}
+
+/*
+ * Zrušení stromu sestaveného v souvislém bloku.
+ *
+ * Uvolní obsah všech uzlů a následně celý blok. Po zrušení je strom ve
+ * stejném stavu jako po inicializaci.
+ */
+void bst_dispose_contiguous(bst_node_t **tree)
+{
+  bst_items_t items = {NULL, 0, 0};
+
+  if (*tree == NULL)
+  {
+    return;
+  }
+
+  bst_preorder(*tree, &items);
+  for (int i = 0; i < items.size; i++)
+  {
+    if (items.nodes[i]->content.value != NULL)
+    {
+      free(items.nodes[i]->content.value);
+    }
+  }
+  free(items.nodes);
+
+  free(*tree);
+  *tree = NULL;
+}
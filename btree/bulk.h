@@ -0,0 +1,19 @@
+/*
+ * Hlavičkový soubor pro hromadné sestavení binárního vyhledávacího stromu.
+ */
+
+#ifndef IAL_BTREE_BULK_H
+#define IAL_BTREE_BULK_H
+
+#include "btree.h"
+#include <stdbool.h>
+
+void bst_build_from_sorted(bst_node_t **tree, const char keys[],
+                           const bst_node_content_t values[], int count,
+                           bool contiguous);
+void bst_build_from_unsorted(bst_node_t **tree, const char keys[],
+                             const bst_node_content_t values[], int count,
+                             bool contiguous);
+void bst_dispose_contiguous(bst_node_t **tree);
+
+#endif
@@ -0,0 +1,257 @@
+/*
+ * Strom postav se sekundárními indexy
+ *
+ * Postavy jsou uložené ve stromu pod klíčem typu char. Vedle stromu se
+ * udržují tři indexy, které se aktualizují při každém vložení, změně
+ * i odstranění postavy:
+ *
+ *   - rozptylová tabulka jmen, synonyma jsou zřetězená přes klíče,
+ *   - bitová mapa klíčů pro každé povolání (CHARACTER_CLASSES),
+ *   - pole klíčů seřazené podle úrovně (a při shodě podle klíče).
+ *
+ * Klíčů je nejvýše CHARACTER_INDEX_KEYS, indexy jsou proto pole pevné
+ * velikosti indexovaná hodnotou klíče převedenou na unsigned char. Indexy
+ * odkazují přímo na záznamy character_t; bst_delete při náhradě uzlu
+ * přesouvá ukazatel na hodnotu, takže odkazy zůstávají platné.
+ */
+
+#include "character_index.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Počet 64bitových slov bitové mapy
+#define CHARACTER_INDEX_WORDS (CHARACTER_INDEX_KEYS / 64)
+
+/* Pozice klíče v polích indexů */
+static int character_index_slot(char key)
+{
+  return (unsigned char)key;
+}
+
+/* Seznam synonym pro jméno */
+static int character_index_bucket(const char *name)
+{
+  unsigned result = 2166136261u;
+  for (; *name != '\0'; name++)
+  {
+    result ^= (unsigned char)*name;
+    result *= 16777619u;
+  }
+  return result % CHARACTER_INDEX_BUCKETS;
+}
+
+/*
+ * Porovnání pořadí dvou postav v indexu úrovní — vrací true, pokud postava
+ * s klíčem a leží před postavou s klíčem b.
+ */
+static bool character_index_level_before(character_index_t *index, char a,
+                                         char b)
+{
+  unsigned char level_a = index->records[character_index_slot(a)]->level;
+  unsigned char level_b = index->records[character_index_slot(b)]->level;
+  return level_a != level_b ? level_a < level_b : a < b;
+}
+
+/*
+ * Inicializace prázdného stromu a indexů.
+ */
+void character_index_init(character_index_t *index)
+{
+  bst_init(&index->tree);
+  for (int i = 0; i < CHARACTER_INDEX_KEYS; i++)
+  {
+    index->records[i] = NULL;
+    index->name_next[i] = -1;
+  }
+  for (int i = 0; i < CHARACTER_INDEX_BUCKETS; i++)
+  {
+    index->name_buckets[i] = -1;
+  }
+  memset(index->class_bitmap, 0, sizeof(index->class_bitmap));
+  index->size = 0;
+}
+
+/*
+ * Pomocná funkce pro přidání postavy s klíčem key do indexů.
+ */
+static void character_index_add(character_index_t *index, char key,
+                                character_t *character)
+{
+  int slot = character_index_slot(key);
+  index->records[slot] = character;
+
+  int bucket = character_index_bucket(character->name);
+  index->name_next[slot] = index->name_buckets[bucket];
+  index->name_buckets[bucket] = slot;
+
+  index->class_bitmap[character->character_class][slot / 64] |=
+      UINT64_C(1) << (slot % 64);
+
+  int position = index->size++;
+  while (position > 0 &&
+         character_index_level_before(index, key,
+                                      (char)index->by_level[position - 1]))
+  {
+    index->by_level[position] = index->by_level[position - 1];
+    position--;
+  }
+  index->by_level[position] = (unsigned char)slot;
+}
+
+/*
+ * Pomocná funkce pro odebrání postavy s klíčem key z indexů.
+ */
+static void character_index_remove(character_index_t *index, char key)
+{
+  int slot = character_index_slot(key);
+  character_t *character = index->records[slot];
+
+  int *link = &index->name_buckets[character_index_bucket(character->name)];
+  while (*link != slot)
+  {
+    link = &index->name_next[*link];
+  }
+  *link = index->name_next[slot];
+  index->name_next[slot] = -1;
+
+  index->class_bitmap[character->character_class][slot / 64] &=
+      ~(UINT64_C(1) << (slot % 64));
+
+  int position = 0;
+  while (index->by_level[position] != slot)
+  {
+    position++;
+  }
+  memmove(&index->by_level[position], &index->by_level[position + 1],
+          index->size - position - 1);
+  index->size--;
+
+  index->records[slot] = NULL;
+}
+
+/*
+ * Vložení postavy do stromu.
+ *
+ * Pokud postava se zadaným klíčem už existuje, nahradí se (stejně jako
+ * u bst_insert se uvolní původní záznam). Strom přebírá vlastnictví záznamu.
+ * Indexy se aktualizují.
+ */
+void character_index_insert(character_index_t *index, char key,
+                            character_t *character)
+{
+  bst_node_content_t content = {.value = character, .type = CHARACTER_T};
+
+  if (index->records[character_index_slot(key)] != NULL)
+  {
+    character_index_remove(index, key);
+  }
+  bst_insert(&index->tree, key, content);
+  character_index_add(index, key, character);
+}
+
+/*
+ * Odstranění postavy ze stromu i z indexů.
+ *
+ * Pokud postava se zadaným klíčem neexistuje, funkce nic nedělá.
+ */
+void character_index_delete(character_index_t *index, char key)
+{
+  if (index->records[character_index_slot(key)] != NULL)
+  {
+    character_index_remove(index, key);
+    bst_delete(&index->tree, key);
+  }
+}
+
+/*
+ * Zrušení stromu i indexů. Po zrušení jsou ve stavu po inicializaci.
+ */
+void character_index_dispose(character_index_t *index)
+{
+  bst_dispose(&index->tree);
+  character_index_init(index);
+}
+
+/*
+ * Vyhledání postav podle jména.
+ *
+ * Klíče nalezených postav zapíše do pole keys (nejvýše CHARACTER_INDEX_KEYS
+ * položek) a vrátí jejich počet.
+ */
+int character_index_find_name(character_index_t *index, const char *name,
+                              char keys[])
+{
+  int count = 0;
+
+  for (int slot = index->name_buckets[character_index_bucket(name)];
+       slot >= 0; slot = index->name_next[slot])
+  {
+    if (strcmp(index->records[slot]->name, name) == 0)
+    {
+      keys[count++] = (char)slot;
+    }
+  }
+  return count;
+}
+
+/*
+ * Vyhledání postav podle povolání.
+ *
+ * Klíče nalezených postav zapíše vzestupně do pole keys (nejvýše
+ * CHARACTER_INDEX_KEYS položek) a vrátí jejich počet.
+ */
+int character_index_find_class(character_index_t *index,
+                               character_class_t character_class, char keys[])
+{
+  int count = 0;
+
+  // Slova se procházejí od klíče CHAR_MIN, aby odpovídalo pořadí ve stromu
+  for (int i = 0; i < CHARACTER_INDEX_WORDS; i++)
+  {
+    int word = (character_index_slot(CHAR_MIN) / 64 + i) % CHARACTER_INDEX_WORDS;
+    uint64_t bits = index->class_bitmap[character_class][word];
+    while (bits != 0)
+    {
+      keys[count++] = (char)(word * 64 + __builtin_ctzll(bits));
+      bits &= bits - 1;
+    }
+  }
+  return count;
+}
+
+/*
+ * Vyhledání postav s úrovní v intervalu <min_level, max_level>.
+ *
+ * Klíče nalezených postav zapíše do pole keys (nejvýše CHARACTER_INDEX_KEYS
+ * položek) seřazené podle úrovně a vrátí jejich počet.
+ */
+int character_index_find_level(character_index_t *index,
+                               unsigned char min_level,
+                               unsigned char max_level, char keys[])
+{
+  int low = 0;
+  int high = index->size;
+  int count = 0;
+
+  // Binární vyhledání první postavy s úrovní alespoň min_level
+  while (low < high)
+  {
+    int mid = (low + high) / 2;
+    if (index->records[index->by_level[mid]]->level < min_level)
+    {
+      low = mid + 1;
+    }
+    else
+    {
+      high = mid;
+    }
+  }
+
+  for (int i = low;
+       i < index->size && index->records[index->by_level[i]]->level <= max_level;
+       i++)
+  {
+    keys[count++] = (char)index->by_level[i];
+  }
+  return count;
+}
@@ -0,0 +1,52 @@
+/*
+ * Hlavičkový soubor pro strom postav se sekundárními indexy.
+ */
+
+#ifndef IAL_CHARACTER_INDEX_H
+#define IAL_CHARACTER_INDEX_H
+
+#include "btree.h"
+#include "character.h"
+#include <limits.h>
+#include <stdint.h>
+
+// Počet možných klíčů stromu
+#define CHARACTER_INDEX_KEYS (UCHAR_MAX + 1)
+
+// Počet seznamů synonym indexu jmen
+#define CHARACTER_INDEX_BUCKETS 64
+
+// Počet povolání
+enum {
+#define X(name) +1
+  CHARACTER_CLASS_COUNT = 0 CHARACTER_CLASSES
+#undef X
+};
+
+// Strom postav (hodnoty typu CHARACTER_T) s indexy podle jména, povolání a úrovně
+typedef struct character_index {
+  bst_node_t *tree;                           // strom postav
+  character_t *records[CHARACTER_INDEX_KEYS]; // postava podle klíče, nebo NULL
+  int name_buckets[CHARACTER_INDEX_BUCKETS];  // první klíč seznamu, nebo -1
+  int name_next[CHARACTER_INDEX_KEYS];        // další klíč se stejným hashem
+  uint64_t class_bitmap[CHARACTER_CLASS_COUNT][CHARACTER_INDEX_KEYS / 64];
+                                              // klíče podle povolání
+  unsigned char by_level[CHARACTER_INDEX_KEYS]; // klíče seřazené podle úrovně
+  int size;                                   // počet postav
+} character_index_t;
+
+void character_index_init(character_index_t *index);
+void character_index_insert(character_index_t *index, char key,
+                            character_t *character);
+void character_index_delete(character_index_t *index, char key);
+void character_index_dispose(character_index_t *index);
+
+int character_index_find_name(character_index_t *index, const char *name,
+                              char keys[]);
+int character_index_find_class(character_index_t *index,
+                               character_class_t character_class, char keys[]);
+int character_index_find_level(character_index_t *index,
+                               unsigned char min_level,
+                               unsigned char max_level, char keys[]);
+
+#endif
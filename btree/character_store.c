@@ -0,0 +1,200 @@
+/*
+ * Sloupcové úložiště postav
+ *
+ * Místo samostatně alokovaných záznamů character_t s vlastním řetězcem jména
+ * jsou povolání, úrovně a jména všech postav uložena ve třech souvislých
+ * polích. Dotaz typu "všichni Wizard od úrovně 10" tak prochází jen dvě pole
+ * bajtů bez dereferencí a překladač smyčku vektorizuje.
+ *
+ * Jména se ukládají jen jednou do společného úložiště řetězců
+ * (common/intern.c), které sdílí i tabulky; postava si pamatuje ukazatel na
+ * své jméno. Uzel stromu odkazuje na postavu jejím id
+ * uloženým jako hodnota typu INTEGER (viz character_store_ref).
+ */
+
+#include "character_store.h"
+#include "../common/intern.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Velikost bloku, po kterém filtr porovnává postavy
+#define CHARACTER_STORE_BLOCK 64
+
+/*
+ * Inicializace prázdného úložiště.
+ */
+void character_store_init(character_store_t *store)
+{
+  store->classes = NULL;
+  store->levels = NULL;
+  store->names = NULL;
+  store->capacity = 0;
+  store->size = 0;
+}
+
+/*
+ * Přidání postavy do úložiště.
+ *
+ * Vrací id nové postavy, nebo -1 při nedostatku paměti. Jméno se zkopíruje
+ * do společného úložiště, pokud tam už není.
+ */
+int character_store_add(character_store_t *store, const char *name,
+                        character_class_t character_class,
+                        unsigned char level)
+{
+  if (store->capacity < store->size + 1)
+  {
+    int capacity = store->capacity * 2 + 8;
+    unsigned char *classes = realloc(store->classes, capacity);
+    if (classes != NULL)
+    {
+      store->classes = classes;
+    }
+    unsigned char *levels = realloc(store->levels, capacity);
+    if (levels != NULL)
+    {
+      store->levels = levels;
+    }
+    const char **names =
+        realloc(store->names, capacity * sizeof(const char *));
+    if (names != NULL)
+    {
+      store->names = names;
+    }
+    if (classes == NULL || levels == NULL || names == NULL)
+    {
+      return -1;
+    }
+    store->capacity = capacity;
+  }
+
+  const char *interned = intern(intern_global(), name);
+  if (interned == NULL)
+  {
+    return -1;
+  }
+
+  store->classes[store->size] = (unsigned char)character_class;
+  store->levels[store->size] = level;
+  store->names[store->size] = interned;
+  return store->size++;
+}
+
+/*
+ * Jméno postavy s daným id. Řetězec patří společnému úložišti řetězců.
+ */
+const char *character_store_name(character_store_t *store, int id)
+{
+  return store->names[id];
+}
+
+/*
+ * Naplnění záznamu character_t údaji postavy s daným id.
+ *
+ * Jméno ukazuje do úložiště, záznam se proto nesmí uvolňovat ani měnit jeho
+ * jméno.
+ */
+void character_store_get(character_store_t *store, int id,
+                         character_t *character)
+{
+  character->name = (char *)store->names[id];
+  character->character_class = (character_class_t)store->classes[id];
+  character->level = store->levels[id];
+}
+
+/*
+ * Počet postav daného povolání s úrovní alespoň min_level.
+ */
+int character_store_count(character_store_t *store,
+                          character_class_t character_class,
+                          unsigned char min_level)
+{
+  const unsigned char *classes = store->classes;
+  const unsigned char *levels = store->levels;
+  unsigned char wanted = (unsigned char)character_class;
+  int count = 0;
+
+  for (int i = 0; i < store->size; i++)
+  {
+    count += (classes[i] == wanted) & (levels[i] >= min_level);
+  }
+  return count;
+}
+
+/*
+ * Vyhledání postav daného povolání s úrovní alespoň min_level.
+ *
+ * Id nalezených postav se vzestupně zapíší do pole result, které musí mít
+ * místo alespoň pro character_store_count postav. Vrací počet nalezených.
+ *
+ * Porovnání probíhá po blocích CHARACTER_STORE_BLOCK postav bez větvení
+ * (vektorizovatelně), id se vypisují jen z bloků s alespoň jednou shodou.
+ * Za poslední nalezené id se do pole result nic nezapisuje.
+ */
+int character_store_filter(character_store_t *store,
+                           character_class_t character_class,
+                           unsigned char min_level, int result[])
+{
+  const unsigned char *classes = store->classes;
+  const unsigned char *levels = store->levels;
+  unsigned char wanted = (unsigned char)character_class;
+  unsigned char match[CHARACTER_STORE_BLOCK];
+  int count = 0;
+
+  for (int start = 0; start < store->size; start += CHARACTER_STORE_BLOCK)
+  {
+    int block = store->size - start < CHARACTER_STORE_BLOCK
+                    ? store->size - start
+                    : CHARACTER_STORE_BLOCK;
+    unsigned char any = 0;
+
+    for (int i = 0; i < block; i++)
+    {
+      match[i] = (classes[start + i] == wanted) &
+                 (levels[start + i] >= min_level);
+      any |= match[i];
+    }
+    if (!any)
+    {
+      continue;
+    }
+
+    // Zápis bez větvení předbíhá počet nalezených, proto smí skončit až na
+    // poslední shodě bloku, jinak by zapsal za konec pole result
+    int last = block - 1;
+    while (!match[last])
+    {
+      last--;
+    }
+    for (int i = 0; i <= last; i++)
+    {
+      result[count] = start + i;
+      count += match[i];
+    }
+  }
+  return count;
+}
+
+/*
+ * Hodnota uzlu stromu odkazující na postavu s daným id.
+ */
+bst_node_content_t character_store_ref(int id)
+{
+  bst_node_content_t content = {.type = INTEGER, .value = malloc(sizeof(int))};
+  if (content.value != NULL)
+  {
+    *(int *)content.value = id;
+  }
+  return content;
+}
+
+/*
+ * Uvolnění úložiště. Po uvolnění je úložiště ve stavu po inicializaci.
+ */
+void character_store_dispose(character_store_t *store)
+{
+  free(store->classes);
+  free(store->levels);
+  free(store->names);
+  character_store_init(store);
+}
@@ -0,0 +1,36 @@
+/*
+ * Hlavičkový soubor pro sloupcové úložiště postav.
+ */
+
+#ifndef IAL_CHARACTER_STORE_H
+#define IAL_CHARACTER_STORE_H
+
+#include "btree.h"
+#include "character.h"
+
+// Úložiště postav — každá vlastnost je v samostatném poli, index je id postavy
+typedef struct character_store {
+  unsigned char *classes; // povolání
+  unsigned char *levels;  // úrovně
+  const char **names;     // jména ze společného úložiště intern_global()
+  int capacity;           // kapacita polí v počtu postav
+  int size;               // počet postav
+} character_store_t;
+
+void character_store_init(character_store_t *store);
+int character_store_add(character_store_t *store, const char *name,
+                        character_class_t character_class,
+                        unsigned char level);
+const char *character_store_name(character_store_t *store, int id);
+void character_store_get(character_store_t *store, int id,
+                         character_t *character);
+int character_store_count(character_store_t *store,
+                          character_class_t character_class,
+                          unsigned char min_level);
+int character_store_filter(character_store_t *store,
+                           character_class_t character_class,
+                           unsigned char min_level, int result[]);
+bst_node_content_t character_store_ref(int id);
+void character_store_dispose(character_store_t *store);
+
+#endif
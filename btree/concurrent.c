@@ -0,0 +1,513 @@
+/*
+ * Binární vyhledávací strom se souběžným přístupem
+ *
+ * Vyhledávání nepoužívá žádné zámky. Zapisující vlákna zamykají jen uzly,
+ * které mění (rodiče a měněný uzel, při odstranění uzlu se dvěma podstromy
+ * navíc nejpravější uzel levého podstromu a jeho rodiče). Zámky se vždy
+ * získávají ve směru od kořene, takže nemůže dojít k uváznutí.
+ *
+ * Zveřejněný uzel se nikdy nemění kromě svých potomků. Změna hodnoty
+ * i náhrada odstraněného uzlu nejpravějším uzlem vytvoří nový uzel, který se
+ * zapojí místo původního, a původní uzel se označí jako odstraněný. Čtenář,
+ * který se nachází v původním uzlu, tak vždy vidí konzistentní stav.
+ *
+ * Jedinou operací, při které může čtenář klíč přehlédnout, je přesun
+ * nejpravějšího uzlu výše ve stromu. Přesuny se počítají a neúspěšné
+ * vyhledávání, během kterého nějaký přesun proběhl, se opakuje.
+ *
+ * Odstraněné uzly a hodnoty se uvolňují až ve chvíli, kdy je žádný čtenář
+ * nemůže používat (epochová správa paměti). Uvolnění proběhne dvě epochy po
+ * odstranění, epocha se posune, jakmile všichni aktivní čtenáři vstoupili do
+ * stromu v té aktuální.
+ */
+
+#include "concurrent.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Obsazené pozice vláken v poli čtenářů
+static atomic_bool bst_conc_slots[BST_CONC_MAX_THREADS];
+
+// Pozice aktuálního vlákna v poli čtenářů
+static _Thread_local int bst_conc_slot = -1;
+
+/*
+ * Pomocná funkce která vrátí pozici aktuálního vlákna v poli čtenářů.
+ *
+ * Při prvním volání vlákno obsadí volnou pozici. Pokud žádná volná pozice
+ * neexistuje, čeká, dokud se některá neuvolní.
+ */
+static int bst_conc_thread_slot()
+{
+  bool warned = false;
+
+  while (bst_conc_slot < 0)
+  {
+    for (int i = 0; i < BST_CONC_MAX_THREADS && bst_conc_slot < 0; i++)
+    {
+      bool expected = false;
+      if (atomic_compare_exchange_strong(&bst_conc_slots[i], &expected, true))
+      {
+        bst_conc_slot = i;
+      }
+    }
+    if (bst_conc_slot < 0 && !warned)
+    {
+      fprintf(stderr, "[W] Too many threads\n");
+      warned = true;
+    }
+  }
+  return bst_conc_slot;
+}
+
+/*
+ * Uvolnění pozice aktuálního vlákna.
+ *
+ * Vlákno ji volá před svým ukončením. Vlákno se v tu chvíli nesmí nacházet
+ * mezi bst_conc_read_begin a bst_conc_read_end.
+ */
+void bst_conc_thread_exit()
+{
+  if (bst_conc_slot >= 0)
+  {
+    atomic_store(&bst_conc_slots[bst_conc_slot], false);
+    bst_conc_slot = -1;
+  }
+}
+
+/*
+ * Vstup čtenáře do stromu.
+ *
+ * Dokud vlákno nezavolá bst_conc_read_end, nebude uvolněn žádný uzel ani
+ * hodnota, kterou ve stromu nalezlo. Volání lze zanořovat.
+ */
+void bst_conc_read_begin(bst_conc_t *tree)
+{
+  bst_conc_reader_t *reader = &tree->readers[bst_conc_thread_slot()];
+
+  if (reader->depth++ == 0)
+  {
+    atomic_store(&reader->active, true);
+    atomic_store(&reader->epoch, atomic_load(&tree->epoch));
+  }
+}
+
+/*
+ * Výstup čtenáře ze stromu.
+ */
+void bst_conc_read_end(bst_conc_t *tree)
+{
+  bst_conc_reader_t *reader = &tree->readers[bst_conc_thread_slot()];
+
+  if (--reader->depth == 0)
+  {
+    atomic_store(&reader->active, false);
+  }
+}
+
+/*
+ * Pomocná funkce pro uvolnění paměti ze seznamu.
+ */
+static void bst_conc_free_retired(bst_conc_retired_t *list)
+{
+  for (int i = 0; i < list->size; i++)
+  {
+    if (list->items[i].node)
+    {
+      pthread_mutex_destroy(&((bst_conc_node_t *)list->items[i].pointer)->lock);
+    }
+    free(list->items[i].pointer);
+  }
+  list->size = 0;
+}
+
+/*
+ * Pomocná funkce která posune epochu, pokud jsou všichni aktivní čtenáři
+ * v té aktuální, a uvolní paměť odstraněnou před dvěma epochami.
+ *
+ * Volá se se zamčeným tree->retired_lock.
+ */
+static void bst_conc_try_advance(bst_conc_t *tree)
+{
+  unsigned epoch = atomic_load(&tree->epoch);
+
+  for (int i = 0; i < BST_CONC_MAX_THREADS; i++)
+  {
+    if (atomic_load(&tree->readers[i].active) &&
+        atomic_load(&tree->readers[i].epoch) != epoch)
+    {
+      return;
+    }
+  }
+
+  atomic_store(&tree->epoch, epoch + 1);
+  bst_conc_free_retired(&tree->retired[(epoch + 1) % 3]);
+}
+
+/*
+ * Pomocná funkce která odloží uvolnění paměti do doby, kdy ji žádný čtenář
+ * nemůže používat.
+ */
+static void bst_conc_retire(bst_conc_t *tree, void *pointer, bool node)
+{
+  if (pointer == NULL)
+  {
+    return;
+  }
+
+  pthread_mutex_lock(&tree->retired_lock);
+  bst_conc_retired_t *list = &tree->retired[atomic_load(&tree->epoch) % 3];
+  if (list->capacity < list->size + 1)
+  {
+    list->capacity = list->capacity * 2 + 8;
+    list->items = realloc(list->items,
+                          list->capacity * sizeof(bst_conc_garbage_t));
+  }
+  list->items[list->size].pointer = pointer;
+  list->items[list->size].node = node;
+  list->size++;
+  bst_conc_try_advance(tree);
+  pthread_mutex_unlock(&tree->retired_lock);
+}
+
+/*
+ * Pomocná funkce pro vytvoření nového uzlu.
+ */
+static bst_conc_node_t *bst_conc_node_new(int key, bst_node_content_t content,
+                                          bst_conc_node_t *left,
+                                          bst_conc_node_t *right)
+{
+  bst_conc_node_t *node = malloc(sizeof(bst_conc_node_t));
+  if (node != NULL)
+  {
+    node->key = key;
+    node->content = content;
+    atomic_init(&node->left, left);
+    atomic_init(&node->right, right);
+    pthread_mutex_init(&node->lock, NULL);
+    node->removed = false;
+  }
+  return node;
+}
+
+/*
+ * Pomocná funkce která vrátí odkaz rodiče, pod kterým leží klíč key.
+ */
+static _Atomic(bst_conc_node_t *) *bst_conc_link(bst_conc_node_t *parent,
+                                                 char key)
+{
+  return key < parent->key ? &parent->left : &parent->right;
+}
+
+/*
+ * Pomocná funkce pro vyhledání uzlu s klíčem key a jeho rodiče.
+ *
+ * Pokud uzel neexistuje, vrátí NULL a do parent uloží uzel, pod který by se
+ * klíč vložil.
+ */
+static bst_conc_node_t *bst_conc_find(bst_conc_t *tree, char key,
+                                      bst_conc_node_t **parent)
+{
+  *parent = &tree->root;
+  bst_conc_node_t *node = atomic_load(&tree->root.left);
+
+  while (node != NULL && node->key != key)
+  {
+    *parent = node;
+    node = atomic_load(bst_conc_link(node, key));
+  }
+  return node;
+}
+
+/*
+ * Inicializace stromu.
+ */
+void bst_conc_init(bst_conc_t *tree)
+{
+  tree->root.key = INT_MAX;
+  tree->root.content.value = NULL;
+  tree->root.content.type = INTEGER;
+  atomic_init(&tree->root.left, NULL);
+  atomic_init(&tree->root.right, NULL);
+  pthread_mutex_init(&tree->root.lock, NULL);
+  tree->root.removed = false;
+
+  atomic_init(&tree->moves_started, 0);
+  atomic_init(&tree->moves_finished, 0);
+  atomic_init(&tree->epoch, 0);
+  pthread_mutex_init(&tree->retired_lock, NULL);
+  for (int i = 0; i < 3; i++)
+  {
+    tree->retired[i].items = NULL;
+    tree->retired[i].capacity = 0;
+    tree->retired[i].size = 0;
+  }
+  for (int i = 0; i < BST_CONC_MAX_THREADS; i++)
+  {
+    atomic_init(&tree->readers[i].epoch, 0);
+    atomic_init(&tree->readers[i].active, false);
+    tree->readers[i].depth = 0;
+  }
+}
+
+/*
+ * Vyhledání uzlu ve stromu.
+ *
+ * V případě úspěchu vrátí funkce hodnotu true a do proměnné value zkopíruje
+ * obsah daného uzlu. V opačném případě funkce vrátí hodnotu false a proměnná
+ * value zůstává nezměněná.
+ *
+ * Funkce nepoužívá zámky. Ukazatel value->value zůstává platný jen v případě,
+ * že volání proběhlo mezi bst_conc_read_begin a bst_conc_read_end.
+ */
+bool bst_conc_search(bst_conc_t *tree, char key, bst_node_content_t *value)
+{
+  bst_conc_node_t *parent;
+  bst_conc_node_t *node;
+  unsigned moves;
+
+  bst_conc_read_begin(tree);
+  do
+  {
+    moves = atomic_load(&tree->moves_finished);
+    node = bst_conc_find(tree, key, &parent);
+  } while (node == NULL && atomic_load(&tree->moves_started) != moves);
+
+  if (node != NULL)
+  {
+    *value = node->content;
+  }
+  bst_conc_read_end(tree);
+  return node != NULL;
+}
+
+/*
+ * Vložení uzlu do stromu.
+ *
+ * Pokud uzel se zadaným klíčem už ve stromu existuje, nahradí se novým uzlem
+ * s hodnotou value a původní hodnota se uvolní. Jinak se vloží nový listový
+ * uzel. Strom přebírá vlastnictví hodnoty.
+ */
+void bst_conc_insert(bst_conc_t *tree, char key, bst_node_content_t value)
+{
+  bst_conc_node_t *parent;
+  bst_conc_node_t *node;
+  bool done = false;
+  unsigned moves;
+
+  bst_conc_read_begin(tree);
+  while (!done)
+  {
+    moves = atomic_load(&tree->moves_finished);
+    node = bst_conc_find(tree, key, &parent);
+    if (node == NULL && atomic_load(&tree->moves_started) != moves)
+    {
+      // Klíč mohl být právě přesouvaný, vložením by vznikl duplicitní uzel
+      continue;
+    }
+    _Atomic(bst_conc_node_t *) *link = bst_conc_link(parent, key);
+
+    pthread_mutex_lock(&parent->lock);
+    if (node != NULL)
+    {
+      pthread_mutex_lock(&node->lock);
+    }
+
+    done = !parent->removed && atomic_load(link) == node &&
+           (node == NULL || !node->removed);
+    if (done)
+    {
+      bst_conc_node_t *fresh = bst_conc_node_new(
+          key, value, node != NULL ? atomic_load(&node->left) : NULL,
+          node != NULL ? atomic_load(&node->right) : NULL);
+      if (fresh != NULL)
+      {
+        atomic_store(link, fresh);
+        if (node != NULL)
+        {
+          node->removed = true;
+        }
+      }
+      else
+      {
+        node = NULL;
+      }
+    }
+
+    if (node != NULL)
+    {
+      pthread_mutex_unlock(&node->lock);
+    }
+    pthread_mutex_unlock(&parent->lock);
+  }
+
+  if (node != NULL)
+  {
+    bst_conc_retire(tree, node->content.value, false);
+    bst_conc_retire(tree, node, true);
+  }
+  bst_conc_read_end(tree);
+}
+
+/*
+ * Odstranění uzlu ze stromu.
+ *
+ * Pokud uzel se zadaným klíčem neexistuje, funkce nic nedělá.
+ * Pokud má odstraněný uzel jeden podstrom, zdědí ho rodič odstraněného uzlu.
+ * Pokud má odstraněný uzel oba podstromy, je nahrazený kopií nejpravějšího
+ * uzlu levého podstromu a nejpravější uzel se odstraní.
+ *
+ * Hodnota odstraněného uzlu se uvolní, jakmile ji nemůže používat žádný
+ * čtenář.
+ */
+void bst_conc_delete(bst_conc_t *tree, char key)
+{
+  bst_conc_node_t *parent;
+  bst_conc_node_t *node;
+  bst_conc_node_t *rightmost = NULL;
+  unsigned moves;
+
+  bst_conc_read_begin(tree);
+  while (true)
+  {
+    moves = atomic_load(&tree->moves_finished);
+    node = bst_conc_find(tree, key, &parent);
+    if (node == NULL)
+    {
+      if (atomic_load(&tree->moves_started) == moves)
+      {
+        break;
+      }
+      continue;
+    }
+    _Atomic(bst_conc_node_t *) *link = bst_conc_link(parent, key);
+
+    pthread_mutex_lock(&parent->lock);
+    pthread_mutex_lock(&node->lock);
+    if (parent->removed || atomic_load(link) != node || node->removed)
+    {
+      pthread_mutex_unlock(&node->lock);
+      pthread_mutex_unlock(&parent->lock);
+      continue;
+    }
+
+    bst_conc_node_t *left = atomic_load(&node->left);
+    bst_conc_node_t *right = atomic_load(&node->right);
+    if (left == NULL || right == NULL)
+    {
+      atomic_store(link, left != NULL ? left : right);
+      node->removed = true;
+      pthread_mutex_unlock(&node->lock);
+      pthread_mutex_unlock(&parent->lock);
+      break;
+    }
+
+    // Uzel má oba podstromy, najdeme nejpravější uzel levého podstromu
+    bst_conc_node_t *rightmost_parent = node;
+    bst_conc_node_t *next;
+    rightmost = left;
+    while ((next = atomic_load(&rightmost->right)) != NULL)
+    {
+      rightmost_parent = rightmost;
+      rightmost = next;
+    }
+
+    if (rightmost_parent != node)
+    {
+      pthread_mutex_lock(&rightmost_parent->lock);
+    }
+    pthread_mutex_lock(&rightmost->lock);
+
+    bool valid = !rightmost_parent->removed && !rightmost->removed &&
+                 atomic_load(&rightmost->right) == NULL &&
+                 (rightmost_parent == node
+                      ? left == rightmost
+                      : atomic_load(&rightmost_parent->right) == rightmost);
+    bst_conc_node_t *fresh = NULL;
+    if (valid)
+    {
+      fresh = bst_conc_node_new(
+          rightmost->key, rightmost->content,
+          rightmost_parent == node ? atomic_load(&rightmost->left) : left,
+          right);
+    }
+    if (fresh != NULL)
+    {
+      atomic_fetch_add(&tree->moves_started, 1);
+      atomic_store(link, fresh);
+      if (rightmost_parent != node)
+      {
+        atomic_store(&rightmost_parent->right, atomic_load(&rightmost->left));
+      }
+      atomic_fetch_add(&tree->moves_finished, 1);
+      node->removed = true;
+      rightmost->removed = true;
+    }
+
+    pthread_mutex_unlock(&rightmost->lock);
+    if (rightmost_parent != node)
+    {
+      pthread_mutex_unlock(&rightmost_parent->lock);
+    }
+    pthread_mutex_unlock(&node->lock);
+    pthread_mutex_unlock(&parent->lock);
+
+    if (fresh != NULL)
+    {
+      break;
+    }
+    rightmost = NULL;
+  }
+
+  if (node != NULL)
+  {
+    bst_conc_retire(tree, node->content.value, false);
+    bst_conc_retire(tree, node, true);
+  }
+  if (rightmost != NULL)
+  {
+    // Hodnota nejpravějšího uzlu přešla do jeho kopie
+    bst_conc_retire(tree, rightmost, true);
+  }
+  bst_conc_read_end(tree);
+}
+
+/*
+ * Pomocná funkce pro uvolnění podstromu.
+ */
+static void bst_conc_dispose_subtree(bst_conc_node_t *tree)
+{
+  if (tree != NULL)
+  {
+    bst_conc_dispose_subtree(atomic_load(&tree->left));
+    bst_conc_dispose_subtree(atomic_load(&tree->right));
+    if (tree->content.value != NULL)
+    {
+      free(tree->content.value);
+    }
+    pthread_mutex_destroy(&tree->lock);
+    free(tree);
+  }
+}
+
+/*
+ * Zrušení celého stromu.
+ *
+ * Po zrušení se celý strom bude nacházet ve stejném stavu jako po
+ * inicializaci. Funkce korektně uvolní všechny uzly, hodnoty i paměť čekající
+ * na uvolnění. Se stromem přitom nesmí pracovat žádné jiné vlákno.
+ */
+void bst_conc_dispose(bst_conc_t *tree)
+{
+  bst_conc_dispose_subtree(atomic_load(&tree->root.left));
+  atomic_store(&tree->root.left, NULL);
+
+  for (int i = 0; i < 3; i++)
+  {
+    bst_conc_free_retired(&tree->retired[i]);
+    free(tree->retired[i].items);
+    tree->retired[i].items = NULL;
+    tree->retired[i].capacity = 0;
+  }
+}
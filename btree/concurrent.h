@@ -0,0 +1,67 @@
+/*
+ * Hlavičkový soubor pro binární vyhledávací strom se souběžným přístupem.
+ */
+
+#ifndef IAL_BTREE_CONCURRENT_H
+#define IAL_BTREE_CONCURRENT_H
+
+#include "btree.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
+// Maximální počet vláken, která mohou se stromy současně pracovat
+#define BST_CONC_MAX_THREADS 64
+
+// Uzel stromu
+typedef struct bst_conc_node {
+  int key;                                // klíč
+  bst_node_content_t content;             // hodnota, po zveřejnění se nemění
+  _Atomic(struct bst_conc_node *) left;   // levý potomek
+  _Atomic(struct bst_conc_node *) right;  // pravý potomek
+  pthread_mutex_t lock;                   // zámek pro změnu potomků
+  bool removed;                           // uzel byl odstraněný ze stromu
+} bst_conc_node_t;
+
+// Stav čtenáře pro epochovou správu paměti
+typedef struct bst_conc_reader {
+  atomic_uint epoch;  // epocha, ve které čtenář vstoupil do stromu
+  atomic_bool active; // čtenář se nachází uvnitř stromu
+  int depth;          // hloubka zanoření bst_conc_read_begin
+} bst_conc_reader_t;
+
+// Uvolňovaný ukazatel
+typedef struct bst_conc_garbage {
+  void *pointer; // uvolňovaná paměť
+  bool node;     // jde o uzel, jehož zámek je nutné zrušit
+} bst_conc_garbage_t;
+
+// Seznam uvolňovaných ukazatelů
+typedef struct bst_conc_retired {
+  bst_conc_garbage_t *items; // pole ukazatelů
+  int capacity;              // kapacita alokované paměti v počtu položek
+  int size;                  // aktuální velikost pole v počtu položek
+} bst_conc_retired_t;
+
+// Strom
+typedef struct bst_conc {
+  bst_conc_node_t root;           // zarážka, celý strom je jejím levým podstromem
+  atomic_uint moves_started;      // počet započatých přesunů uzlu
+  atomic_uint moves_finished;     // počet dokončených přesunů uzlu
+  atomic_uint epoch;              // globální epocha
+  pthread_mutex_t retired_lock;   // zámek seznamů uvolňovaných ukazatelů
+  bst_conc_retired_t retired[3];  // uvolňované ukazatele podle epochy
+  bst_conc_reader_t readers[BST_CONC_MAX_THREADS]; // stav čtenářů
+} bst_conc_t;
+
+void bst_conc_init(bst_conc_t *tree);
+void bst_conc_insert(bst_conc_t *tree, char key, bst_node_content_t value);
+bool bst_conc_search(bst_conc_t *tree, char key, bst_node_content_t *value);
+void bst_conc_delete(bst_conc_t *tree, char key);
+void bst_conc_dispose(bst_conc_t *tree);
+
+void bst_conc_read_begin(bst_conc_t *tree);
+void bst_conc_read_end(bst_conc_t *tree);
+void bst_conc_thread_exit();
+
+#endif
@@ -0,0 +1,230 @@
+/*
+ * Bufferovaný výpis stromu
+ *
+ * Textový výpis má stejný tvar jako bst_print_tree. Odsazení všech úrovní
+ * sdílí jedna vyrovnávací paměť, do které se při sestupu přidávají tři znaky
+ * a při návratu se opět odeberou — na uzel tak nepřipadá žádná alokace.
+ *
+ * Binární výpis začíná počtem uzlů (varint), následují uzly v pořadí
+ * preorder. Každý uzel tvoří klíč (1 B), příznaky (1 B: levý a pravý
+ * potomek, typ hodnoty) a hodnota:
+ *
+ *   INTEGER      4 B little-endian,
+ *   CHARACTER_T  povolání (1 B), úroveň (1 B), délka jména (varint), jméno.
+ */
+
+#include "dump.h"
+#include "character.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Prefixy podstromu a mezery
+#define BST_DUMP_SUBTREE_PREFIX "  |"
+#define BST_DUMP_SPACE_PREFIX "   "
+#define BST_DUMP_PREFIX_LENGTH 3
+
+// Sdílený prefix řádků
+typedef struct bst_dump_prefix {
+  char *data;
+  size_t length;
+  size_t capacity;
+} bst_dump_prefix_t;
+
+/*
+ * Pomocná funkce pro výpis obsahu uzlu.
+ */
+void bst_write_node_content(writer_t *writer, bst_node_content_t *content)
+{
+  if (content == NULL)
+  {
+    writer_string(writer, "NULL");
+    return;
+  }
+  switch (content->type)
+  {
+  case INTEGER:
+    writer_int(writer, *(int *)content->value);
+    break;
+
+  case CHARACTER_T:
+  {
+    character_t *character = content->value;
+    writer_string(writer, character->name);
+    writer_string(writer, ", ");
+    writer_string(writer,
+                  character_class_to_string(character->character_class));
+    writer_string(writer, ", ");
+    writer_unsigned(writer, character->level);
+    break;
+  }
+
+  default:
+    writer_string(writer, "Unknown");
+    break;
+  }
+}
+
+/*
+ * Pomocná funkce pro výpis uzlu stromu.
+ */
+void bst_write_node(writer_t *writer, bst_node_t *node)
+{
+  writer_char(writer, '[');
+  writer_char(writer, node->key);
+  writer_char(writer, ',');
+  bst_write_node_content(writer, &node->content);
+  writer_char(writer, ']');
+}
+
+/*
+ * Pomocná funkce pro přidání části prefixu.
+ */
+static void bst_dump_push(bst_dump_prefix_t *prefix, const char *part)
+{
+  if (prefix->length + BST_DUMP_PREFIX_LENGTH >= prefix->capacity)
+  {
+    prefix->capacity = prefix->capacity * 2 + BST_DUMP_PREFIX_LENGTH + 1;
+    prefix->data = realloc(prefix->data, prefix->capacity);
+  }
+  memcpy(prefix->data + prefix->length, part, BST_DUMP_PREFIX_LENGTH);
+  prefix->length += BST_DUMP_PREFIX_LENGTH;
+}
+
+/*
+ * Pomocná funkce pro výpis prefixu následovaného částí part a koncem řádku.
+ */
+static void bst_dump_line(writer_t *writer, bst_dump_prefix_t *prefix,
+                          const char *part)
+{
+  writer_bytes(writer, prefix->data, prefix->length);
+  writer_string(writer, part);
+  writer_char(writer, '\n');
+}
+
+/*
+ * Pomocná funkce pro rekurzivní výpis podstromu.
+ */
+static void bst_dump_subtree(writer_t *writer, bst_node_t *tree,
+                             bst_dump_prefix_t *prefix, bst_dump_side_t from)
+{
+  if (tree == NULL)
+  {
+    return;
+  }
+
+  if (from == BST_DUMP_LEFT)
+  {
+    bst_dump_line(writer, prefix, BST_DUMP_SUBTREE_PREFIX);
+  }
+
+  bst_dump_push(prefix, from == BST_DUMP_LEFT ? BST_DUMP_SUBTREE_PREFIX
+                                              : BST_DUMP_SPACE_PREFIX);
+  bst_dump_subtree(writer, tree->right, prefix, BST_DUMP_RIGHT);
+  prefix->length -= BST_DUMP_PREFIX_LENGTH;
+
+  writer_bytes(writer, prefix->data, prefix->length);
+  writer_string(writer, "  +-");
+  bst_write_node(writer, tree);
+  writer_char(writer, '\n');
+
+  bst_dump_push(prefix, from == BST_DUMP_RIGHT ? BST_DUMP_SUBTREE_PREFIX
+                                               : BST_DUMP_SPACE_PREFIX);
+  bst_dump_subtree(writer, tree->left, prefix, BST_DUMP_LEFT);
+  prefix->length -= BST_DUMP_PREFIX_LENGTH;
+
+  if (from == BST_DUMP_RIGHT)
+  {
+    bst_dump_line(writer, prefix, BST_DUMP_SUBTREE_PREFIX);
+  }
+}
+
+/*
+ * Výpis podstromu s počátečním prefixem prefix.
+ */
+void bst_write_subtree(writer_t *writer, bst_node_t *tree, const char *prefix,
+                       bst_dump_side_t from)
+{
+  size_t length = strlen(prefix);
+  bst_dump_prefix_t shared = {
+      .data = malloc(length + 1), .length = length, .capacity = length + 1};
+
+  memcpy(shared.data, prefix, length);
+  bst_dump_subtree(writer, tree, &shared, from);
+  free(shared.data);
+}
+
+/*
+ * Textový výpis celého stromu.
+ */
+void bst_write_tree(writer_t *writer, bst_node_t *tree)
+{
+  writer_string(writer, "Binary tree structure:\n\n");
+  if (tree != NULL)
+  {
+    bst_write_subtree(writer, tree, "", BST_DUMP_NONE);
+  }
+  else
+  {
+    writer_string(writer, "Tree is empty\n");
+  }
+  writer_char(writer, '\n');
+}
+
+/*
+ * Pomocná funkce pro spočítání uzlů podstromu.
+ */
+static uint64_t bst_dump_count(bst_node_t *tree)
+{
+  return tree == NULL
+             ? 0
+             : 1 + bst_dump_count(tree->left) + bst_dump_count(tree->right);
+}
+
+/*
+ * Pomocná funkce pro binární výpis podstromu v pořadí preorder.
+ */
+static void bst_dump_binary_subtree(writer_t *writer, bst_node_t *tree)
+{
+  if (tree == NULL)
+  {
+    return;
+  }
+
+  uint8_t flags = (uint8_t)(tree->content.type << BST_DUMP_TYPE_SHIFT);
+  if (tree->left != NULL)
+  {
+    flags |= BST_DUMP_HAS_LEFT;
+  }
+  if (tree->right != NULL)
+  {
+    flags |= BST_DUMP_HAS_RIGHT;
+  }
+  writer_u8(writer, (uint8_t)tree->key);
+  writer_u8(writer, flags);
+
+  if (tree->content.type == CHARACTER_T)
+  {
+    character_t *character = tree->content.value;
+    size_t length = strlen(character->name);
+    writer_u8(writer, (uint8_t)character->character_class);
+    writer_u8(writer, character->level);
+    writer_varint(writer, length);
+    writer_bytes(writer, character->name, length);
+  }
+  else
+  {
+    writer_u32(writer, (uint32_t)*(int *)tree->content.value);
+  }
+
+  bst_dump_binary_subtree(writer, tree->left);
+  bst_dump_binary_subtree(writer, tree->right);
+}
+
+/*
+ * Binární výpis celého stromu.
+ */
+void bst_dump_binary(writer_t *writer, bst_node_t *tree)
+{
+  writer_varint(writer, bst_dump_count(tree));
+  bst_dump_binary_subtree(writer, tree);
+}
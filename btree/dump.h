@@ -0,0 +1,30 @@
+/*
+ * Hlavičkový soubor pro bufferovaný textový a binární výpis stromu.
+ */
+
+#ifndef IAL_BTREE_DUMP_H
+#define IAL_BTREE_DUMP_H
+
+#include "../common/writer.h"
+#include "btree.h"
+
+// Strana, ze které se do podstromu vstoupilo
+typedef enum bst_dump_side {
+  BST_DUMP_NONE,
+  BST_DUMP_LEFT,
+  BST_DUMP_RIGHT
+} bst_dump_side_t;
+
+// Příznaky uzlu v binárním výpisu
+#define BST_DUMP_HAS_LEFT 0x01
+#define BST_DUMP_HAS_RIGHT 0x02
+#define BST_DUMP_TYPE_SHIFT 2
+
+void bst_write_node_content(writer_t *writer, bst_node_content_t *content);
+void bst_write_node(writer_t *writer, bst_node_t *node);
+void bst_write_subtree(writer_t *writer, bst_node_t *tree, const char *prefix,
+                       bst_dump_side_t from);
+void bst_write_tree(writer_t *writer, bst_node_t *tree);
+void bst_dump_binary(writer_t *writer, bst_node_t *tree);
+
+#endif
@@ -0,0 +1,109 @@
+/*
+ * Měření výkonu počítání frekvence výskytů znaků.
+ *
+ * Text délky od BENCH_MIN_OPS do max_bajtů (po násobcích deseti) se
+ * vygeneruje z abecedy BENCH_ALPHABET s náhodným, seřazeným a Zipfovým
+ * rozdělením znaků. Operací je jeden bajt vstupu. Výstup je ve formátu CSV
+ * popsaném v common/bench.c.
+ *
+ * Použití: ./bench [max_bajtů]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "../../common/bench.h"
+#include "../btree.h"
+#include "../perf.h"
+#include "exa.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Znaky, ze kterých se skládá vstup
+#define BENCH_ALPHABET \
+    "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 .,!?-_"
+
+// Nejmenší počet bajtů zpracovaných v jednom měření
+#define BENCH_MIN_BYTES (1 << 20)
+
+/*
+ * Vygeneruje text délky length ukončený znakem '\0'.
+ */
+static char *generate_text(bench_distribution_t distribution, long length)
+{
+    int alphabet = strlen(BENCH_ALPHABET);
+    int *keys = malloc(length * sizeof(int));
+    char *text = malloc(length + 1);
+
+    bench_keys(distribution, keys, length, alphabet,
+               2463534242u + distribution);
+    for (long i = 0; i < length; i++)
+    {
+        text[i] = BENCH_ALPHABET[keys[i]];
+    }
+    text[length] = '\0';
+    free(keys);
+    return text;
+}
+
+/*
+ * Počítání znaků v textu v paměti a v dočasném souboru.
+ */
+static void bench_letter_count(bench_distribution_t distribution, long length)
+{
+    const char *name = bench_distribution_name(distribution);
+    char *text = generate_text(distribution, length);
+    long rounds = BENCH_MIN_BYTES / length > 0 ? BENCH_MIN_BYTES / length : 1;
+    bst_node_t *tree;
+
+    double start = bench_now_ns();
+    for (long i = 0; i < rounds; i++)
+    {
+        letter_count(&tree, text);
+        bst_dispose(&tree);
+    }
+    bench_report("letter_count", name, 1, rounds * length, length,
+                 bench_now_ns() - start);
+
+    char path[] = "/tmp/letter_benchXXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0 || write(fd, text, length) != length)
+    {
+        fprintf(stderr, "[W] Cannot write %s\n", path);
+    }
+    else
+    {
+        start = bench_now_ns();
+        for (long i = 0; i < rounds; i++)
+        {
+            letter_count_file(&tree, path, 1);
+            bst_dispose(&tree);
+        }
+        bench_report("letter_count_file", name, 1, rounds * length, length,
+                     bench_now_ns() - start);
+    }
+    if (fd >= 0)
+    {
+        close(fd);
+        unlink(path);
+    }
+    free(text);
+}
+
+int main(int argc, char *argv[])
+{
+    long max_bytes = argc > 1 ? atol(argv[1]) : BENCH_DEFAULT_MAX_OPS;
+
+    bench_header();
+    for (int distribution = 0; distribution < BENCH_DISTRIBUTIONS;
+         distribution++)
+    {
+        for (long length = BENCH_MIN_OPS; length <= max_bytes; length *= 10)
+        {
+            bench_letter_count(distribution, length);
+        }
+    }
+    BST_PERF_REPORT(stderr);
+    return 0;
+}
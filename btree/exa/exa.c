@@ -7,9 +7,25 @@
  *
  */
 
-#include "../btree.h"
+#define _POSIX_C_SOURCE 200809L
+
+#include "exa.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 /**
  * Vypočítání frekvence výskytů znaků ve vstupním řetězci.
@@ -46,48 +62,545 @@ char to_lower(char ch)
     return ch;
 }
 
+/*
+ * Počítadla výskytů: třídy 0-25 jsou písmena 'a'-'z', LETTER_SPACE mezera
+ * a LETTER_OTHER ostatní znaky.
+ */
+#define LETTER_SPACE 26
+#define LETTER_OTHER 27
+#define LETTER_CLASSES 28
+
+/* Třída znaku */
+static int letter_class(char ch)
+{
+    if (is_alpha(ch))
+    {
+        return to_lower(ch) - 'a';
+    }
+    return ch == ' ' ? LETTER_SPACE : LETTER_OTHER;
+}
+
+/* Klíč ve stromu pro třídu znaku */
+static char letter_key(int class)
+{
+    if (class < LETTER_SPACE)
+    {
+        return 'a' + class;
+    }
+    return class == LETTER_SPACE ? ' ' : '_';
+}
+
+/* Počítání výskytů po jednotlivých znacích */
+static void letter_histogram_scalar(const char *input, size_t length,
+                                    size_t counts[])
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        counts[letter_class(input[i])]++;
+    }
+}
+
+#if defined(__SSE2__)
+
+/*
+ * Vektorové počítání výskytů po 16 bajtech (SSE2).
+ *
+ * Písmena se převedou na malá (bit 0x20) a posunou tak, aby 'a' odpovídalo
+ * nule — hodnota bajtu je pak přímo třídou písmene. Pro každou třídu se
+ * porovnáním získá maska a odečtením masky se v jednotlivých bajtech
+ * přičítá jednička. Bajtová počítadla se nejpozději po 255 blocích sečtou
+ * instrukcí psadbw do celkových počtů. Ostatní znaky se dopočítají z délky.
+ */
+static void letter_histogram_sse2(const char *input, size_t length,
+                                  size_t counts[])
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i fold = _mm_set1_epi8(0x20);
+    const __m128i first = _mm_set1_epi8('a');
+    const __m128i space = _mm_set1_epi8(' ');
+    __m128i acc[LETTER_OTHER];
+    size_t i = 0;
+
+    while (length - i >= 16)
+    {
+        size_t blocks = (length - i) / 16;
+        if (blocks > 255)
+        {
+            blocks = 255;
+        }
+        for (int class = 0; class < LETTER_OTHER; class++)
+        {
+            acc[class] = zero;
+        }
+
+        for (size_t block = 0; block < blocks; block++, i += 16)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i *)(input + i));
+            __m128i t = _mm_sub_epi8(_mm_or_si128(v, fold), first);
+            for (int class = 0; class < LETTER_SPACE; class++)
+            {
+                acc[class] = _mm_sub_epi8(
+                    acc[class], _mm_cmpeq_epi8(t, _mm_set1_epi8(class)));
+            }
+            acc[LETTER_SPACE] =
+                _mm_sub_epi8(acc[LETTER_SPACE], _mm_cmpeq_epi8(v, space));
+        }
+
+        size_t classified = 0;
+        for (int class = 0; class < LETTER_OTHER; class++)
+        {
+            uint64_t sums[2];
+            _mm_storeu_si128((__m128i *)sums, _mm_sad_epu8(acc[class], zero));
+            counts[class] += sums[0] + sums[1];
+            classified += sums[0] + sums[1];
+        }
+        counts[LETTER_OTHER] += blocks * 16 - classified;
+    }
+
+    letter_histogram_scalar(input + i, length - i, counts);
+}
+
+/*
+ * Vektorové počítání výskytů po 32 bajtech (AVX2), postup je stejný jako
+ * u letter_histogram_sse2.
+ */
+__attribute__((target("avx2")))
+static void letter_histogram_avx2(const char *input, size_t length,
+                                  size_t counts[])
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i fold = _mm256_set1_epi8(0x20);
+    const __m256i first = _mm256_set1_epi8('a');
+    const __m256i space = _mm256_set1_epi8(' ');
+    __m256i acc[LETTER_OTHER];
+    size_t i = 0;
+
+    while (length - i >= 32)
+    {
+        size_t blocks = (length - i) / 32;
+        if (blocks > 255)
+        {
+            blocks = 255;
+        }
+        for (int class = 0; class < LETTER_OTHER; class++)
+        {
+            acc[class] = zero;
+        }
+
+        for (size_t block = 0; block < blocks; block++, i += 32)
+        {
+            __m256i v = _mm256_loadu_si256((const __m256i *)(input + i));
+            __m256i t = _mm256_sub_epi8(_mm256_or_si256(v, fold), first);
+            for (int class = 0; class < LETTER_SPACE; class++)
+            {
+                acc[class] = _mm256_sub_epi8(
+                    acc[class], _mm256_cmpeq_epi8(t, _mm256_set1_epi8(class)));
+            }
+            acc[LETTER_SPACE] =
+                _mm256_sub_epi8(acc[LETTER_SPACE], _mm256_cmpeq_epi8(v, space));
+        }
+
+        size_t classified = 0;
+        for (int class = 0; class < LETTER_OTHER; class++)
+        {
+            uint64_t sums[4];
+            _mm256_storeu_si256((__m256i *)sums,
+                                _mm256_sad_epu8(acc[class], zero));
+            counts[class] += sums[0] + sums[1] + sums[2] + sums[3];
+            classified += sums[0] + sums[1] + sums[2] + sums[3];
+        }
+        counts[LETTER_OTHER] += blocks * 32 - classified;
+    }
+
+    letter_histogram_sse2(input + i, length - i, counts);
+}
+
+#endif // __SSE2__
+
+/* Počítání výskytů nejrychlejší dostupnou variantou */
+static void letter_histogram(const char *input, size_t length, size_t counts[])
+{
+#if defined(__SSE2__)
+    if (__builtin_cpu_supports("avx2"))
+    {
+        letter_histogram_avx2(input, length, counts);
+    }
+    else
+    {
+        letter_histogram_sse2(input, length, counts);
+    }
+#else
+    letter_histogram_scalar(input, length, counts);
+#endif
+}
+
+/*
+ * Počty výskytů tříd znaků a pozice jejich prvních výskytů ve vstupu
+ * (SIZE_MAX, pokud se třída zatím nevyskytla).
+ */
+typedef struct letter_stats {
+    size_t counts[LETTER_CLASSES];
+    size_t first[LETTER_CLASSES];
+} letter_stats_t;
+
+static void letter_stats_init(letter_stats_t *stats)
+{
+    for (int class = 0; class < LETTER_CLASSES; class++)
+    {
+        stats->counts[class] = 0;
+        stats->first[class] = SIZE_MAX;
+    }
+}
+
+// Velikost bloku, ve kterém se hledají první výskyty tříd
+#define LETTER_BLOCK_SIZE 4096
+
+/*
+ * Započítání úseku vstupu, který začíná na pozici offset.
+ *
+ * Úseky lze započítávat v libovolném pořadí. Vstup se počítá po blocích
+ * a blok se prochází znak po znaku jen tehdy, když obsahuje třídu, jejíž
+ * první výskyt zatím není znám nebo leží až za začátkem úseku.
+ */
+static void letter_stats_add(letter_stats_t *stats, const char *input,
+                             size_t length, size_t offset)
+{
+    for (size_t start = 0; start < length; start += LETTER_BLOCK_SIZE)
+    {
+        size_t block = length - start < LETTER_BLOCK_SIZE ? length - start
+                                                          : LETTER_BLOCK_SIZE;
+        size_t counts[LETTER_CLASSES] = {0};
+        bool wanted[LETTER_CLASSES];
+        int pending = 0;
+
+        letter_histogram(input + start, block, counts);
+        for (int class = 0; class < LETTER_CLASSES; class++)
+        {
+            stats->counts[class] += counts[class];
+            wanted[class] = counts[class] > 0 &&
+                            stats->first[class] > offset + start;
+            pending += wanted[class];
+        }
+
+        for (size_t i = start; pending > 0; i++)
+        {
+            int class = letter_class(input[i]);
+            if (wanted[class])
+            {
+                wanted[class] = false;
+                stats->first[class] = offset + i;
+                pending--;
+            }
+        }
+    }
+}
+
+/* Sloučení výsledků dvou částí vstupu */
+static void letter_stats_merge(letter_stats_t *stats,
+                               const letter_stats_t *other)
+{
+    for (int class = 0; class < LETTER_CLASSES; class++)
+    {
+        stats->counts[class] += other->counts[class];
+        if (other->first[class] < stats->first[class])
+        {
+            stats->first[class] = other->first[class];
+        }
+    }
+}
+
+/**
+ * Přičtení count výskytů znaku key do stromu.
+ *
+ * Chybějící klíč se vloží. Uzly ukládají počet jako int, součet, který by
+ * přesáhl INT_MAX, se proto nasytí na INT_MAX.
+ */
+void letter_count_add(bst_node_t **tree, char key, size_t count)
+{
+    bst_node_content_t *current_count;
+
+    if (bst_search(*tree, key, &current_count))
+    {
+        int *value = current_count->value;
+        *value = count > (size_t)(INT_MAX - *value) ? INT_MAX
+                                                    : *value + (int)count;
+    }
+    else
+    {
+        bst_node_content_t content;
+        content.value = malloc(sizeof(int));
+        *(int *)content.value = count > INT_MAX ? INT_MAX : (int)count;
+        content.type = INTEGER;
+
+        bst_insert(tree, key, content); // Vložíme nový uzel
+    }
+}
+
+/*
+ * Přičtení výsledků do stromu. Chybějící klíče se vkládají v pořadí prvních
+ * výskytů, aby měl strom stejný tvar jako při vkládání znak po znaku.
+ */
+static void letter_stats_to_tree(bst_node_t **tree, const letter_stats_t *stats)
+{
+    int order[LETTER_CLASSES];
+    int present = 0;
+
+    for (int class = 0; class < LETTER_CLASSES; class++)
+    {
+        if (stats->counts[class] == 0)
+        {
+            continue;
+        }
+        int i = present++;
+        while (i > 0 && stats->first[order[i - 1]] > stats->first[class])
+        {
+            order[i] = order[i - 1];
+            i--;
+        }
+        order[i] = class;
+    }
+
+    for (int i = 0; i < present; i++)
+    {
+        letter_count_add(tree, letter_key(order[i]), stats->counts[order[i]]);
+    }
+}
+
 void letter_count(bst_node_t **tree, char *input)
 {
     // Initialize the tree
     bst_init(tree);
 
-    // Traverse the input string
-    for (char *ch = input; *ch != '\0'; ch++)
-    {
-        char key;
+    letter_count_update(tree, input, strlen(input));
+}
+
+/**
+ * Přičtení frekvence výskytů znaků v bloku dat k existujícímu stromu.
+ *
+ * Na rozdíl od letter_count strom neinicializuje; klíče, které ve stromu už
+ * jsou, navýší o počet výskytů v bloku. Blok nemusí být ukončený znakem '\0'.
+ */
+void letter_count_update(bst_node_t **tree, const char *input, size_t length)
+{
+    letter_stats_t stats;
+
+    letter_stats_init(&stats);
+    letter_stats_add(&stats, input, length, 0);
+    letter_stats_to_tree(tree, &stats);
+}
+
+// Sdílený stav čtení ze souborového deskriptoru
+typedef struct letter_reader {
+    int fd;               // čtený deskriptor
+    pthread_mutex_t lock; // zámek čtení
+    size_t position;      // pozice dalšího úseku ve vstupu
+    bool failed;          // čtení skončilo chybou
+} letter_reader_t;
+
+// Práce jednoho vlákna
+typedef struct letter_worker {
+    letter_stats_t stats;    // výsledky vlákna
+    const char *input;       // úsek vstupu v paměti
+    size_t length;           // délka úseku
+    size_t offset;           // pozice úseku ve vstupu
+    letter_reader_t *reader; // čtení z deskriptoru, nebo NULL
+} letter_worker_t;
 
-        // Determine the character category
-        if (is_alpha(*ch))
+/*
+ * Načtení jednoho úseku z deskriptoru. Vrací počet načtených bajtů (0 na
+ * konci vstupu) a do offset uloží pozici úseku ve vstupu.
+ */
+static size_t letter_read_chunk(letter_reader_t *reader, char *buffer,
+                                size_t *offset)
+{
+    size_t length = 0;
+
+    pthread_mutex_lock(&reader->lock);
+    while (!reader->failed && length < LETTER_CHUNK_SIZE)
+    {
+        ssize_t result = read(reader->fd, buffer + length,
+                              LETTER_CHUNK_SIZE - length);
+        if (result > 0)
         {
-            key = to_lower(*ch); // Convert alphabetic characters to lowercase
+            length += result;
         }
-        else if (*ch == ' ')
+        else if (result == 0)
         {
-            key = ' '; // Space character
+            break;
         }
-        else
+        else if (errno != EINTR)
         {
-            key = '_'; // All other characters
+            reader->failed = true;
         }
+    }
+    *offset = reader->position;
+    reader->position += length;
+    pthread_mutex_unlock(&reader->lock);
 
-        // Check if the key exists in the tree, and retrieve its current count
-        bst_node_content_t *current_count;
-        if (bst_search(*tree, key, &current_count))
+    return length;
+}
+
+static void *letter_worker_run(void *arg)
+{
+    letter_worker_t *worker = arg;
+
+    if (worker->reader == NULL)
+    {
+        letter_stats_add(&worker->stats, worker->input, worker->length,
+                         worker->offset);
+        return NULL;
+    }
+
+    char *buffer = malloc(LETTER_CHUNK_SIZE);
+    if (buffer == NULL)
+    {
+        pthread_mutex_lock(&worker->reader->lock);
+        worker->reader->failed = true;
+        pthread_mutex_unlock(&worker->reader->lock);
+        return NULL;
+    }
+
+    size_t offset;
+    size_t length;
+    while ((length = letter_read_chunk(worker->reader, buffer, &offset)) > 0)
+    {
+        letter_stats_add(&worker->stats, buffer, length, offset);
+    }
+    free(buffer);
+    return NULL;
+}
+
+/*
+ * Spuštění zpracování ve threads vláknech (včetně volajícího) a sloučení
+ * jejich výsledků do stats.
+ */
+static void letter_workers_run(letter_worker_t workers[], int threads,
+                               letter_stats_t *stats)
+{
+    pthread_t handles[threads];
+    bool started[threads];
+
+    for (int i = 1; i < threads; i++)
+    {
+        started[i] = pthread_create(&handles[i], NULL, letter_worker_run,
+                                    &workers[i]) == 0;
+        if (!started[i])
         {
-            // Pokud klíč existuje, zvýšíme stávající hodnotu
-            int *value_ptr = (int *)current_count->value;
-            (*value_ptr)++; // Zvýšíme hodnotu
+            letter_worker_run(&workers[i]);
         }
-        else
-        {
-            // Pokud klíč neexistuje, vytvoříme nový uzel s hodnotou 1
-            bst_node_content_t content;
-            int *initial_count = malloc(sizeof(int));
-            *initial_count = 1; // Nastavení počáteční hodnoty na 1
-            content.value = initial_count;
-            content.type = INTEGER;
+    }
+    letter_worker_run(&workers[0]);
 
-            bst_insert(tree, key, content); // Vložíme nový uzel
+    letter_stats_init(stats);
+    for (int i = 0; i < threads; i++)
+    {
+        if (i > 0 && started[i])
+        {
+            pthread_join(handles[i], NULL);
         }
+        letter_stats_merge(stats, &workers[i].stats);
+    }
+}
+
+/**
+ * Přičtení frekvence výskytů znaků ze souborového deskriptoru k existujícímu
+ * stromu.
+ *
+ * Vstup se čte po úsecích velikosti LETTER_CHUNK_SIZE až do konce, takže může
+ * jít i o rouru. Úseky zpracovává threads vláken, každé do vlastních
+ * počítadel, která se na konci sečtou. Vrací 0, nebo -1 při chybě čtení
+ * (strom pak zůstane beze změny).
+ */
+int letter_count_fd(bst_node_t **tree, int fd, int threads)
+{
+    if (threads < 1)
+    {
+        threads = 1;
     }
-}
\ No newline at end of file
+
+    letter_reader_t reader = {.fd = fd, .position = 0, .failed = false};
+    letter_worker_t workers[threads];
+    pthread_mutex_init(&reader.lock, NULL);
+    for (int i = 0; i < threads; i++)
+    {
+        letter_stats_init(&workers[i].stats);
+        workers[i].reader = &reader;
+    }
+
+    letter_stats_t stats;
+    letter_workers_run(workers, threads, &stats);
+    pthread_mutex_destroy(&reader.lock);
+
+    if (reader.failed)
+    {
+        return -1;
+    }
+    letter_stats_to_tree(tree, &stats);
+    return 0;
+}
+
+/**
+ * Přičtení frekvence výskytů znaků v souboru k existujícímu stromu.
+ *
+ * Běžný soubor se namapuje do paměti a rozdělí na threads stejně velkých
+ * částí, které se zpracují souběžně. Ostatní soubory (roury, zařízení) se
+ * čtou funkcí letter_count_fd. Vrací 0, nebo -1 při chybě (strom pak zůstane
+ * beze změny).
+ */
+int letter_count_file(bst_node_t **tree, const char *path, int threads)
+{
+    struct stat info;
+
+    if (threads < 1)
+    {
+        threads = 1;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    if (fstat(fd, &info) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    if (!S_ISREG(info.st_mode))
+    {
+        int result = letter_count_fd(tree, fd, threads);
+        close(fd);
+        return result;
+    }
+    if (info.st_size == 0)
+    {
+        close(fd);
+        return 0;
+    }
+
+    size_t length = info.st_size;
+    char *input = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (input == MAP_FAILED)
+    {
+        return -1;
+    }
+    posix_madvise(input, length, POSIX_MADV_SEQUENTIAL);
+
+    letter_worker_t workers[threads];
+    size_t part = length / threads;
+    for (int i = 0; i < threads; i++)
+    {
+        letter_stats_init(&workers[i].stats);
+        workers[i].offset = i * part;
+        workers[i].input = input + workers[i].offset;
+        workers[i].length = i == threads - 1 ? length - workers[i].offset : part;
+        workers[i].reader = NULL;
+    }
+    letter_stats_t stats;
+    letter_workers_run(workers, threads, &stats);
+    letter_stats_to_tree(tree, &stats);
+
+    munmap(input, length);
+    return 0;
+}
@@ -0,0 +1,24 @@
+/*
+ * Hlavičkový soubor pro počítání frekvence výskytů znaků.
+ */
+
+#ifndef IAL_BTREE_EXA_H
+#define IAL_BTREE_EXA_H
+
+#include "../btree.h"
+#include <stddef.h>
+
+// Velikost úseku, po kterém se čte vstup ze souborového deskriptoru
+#define LETTER_CHUNK_SIZE (1 << 20)
+
+/*
+ * Počty výskytů se ve stromu ukládají jako int. Počet, který by přesáhl
+ * INT_MAX (u vícegigabajtových souborů nebo opakovaným přičítáním), se
+ * nasytí na INT_MAX; přetečení se nehlásí jako chyba.
+ */
+void letter_count_add(bst_node_t **tree, char key, size_t count);
+void letter_count_update(bst_node_t **tree, const char *input, size_t length);
+int letter_count_fd(bst_node_t **tree, int fd, int threads);
+int letter_count_file(bst_node_t **tree, const char *path, int threads);
+
+#endif
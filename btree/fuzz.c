@@ -0,0 +1,629 @@
+/*
+ * Diferenciální testování implementací binárního vyhledávacího stromu.
+ *
+ * Stejnou náhodnou posloupnost operací provede nad připojenou implementací
+ * btree.h (iter nebo rec), nad souběžným, perzistentním, splay stromem
+ * a stromem s náhrobky a nad referenčním modelem. Po každé operaci porovná
+ * výsledek vyhledání, v náhodných okamžicích pak celý tvar stromu, pořadí
+ * všech tří průchodů, hromadně sestavený strom, uložení a načtení obrazu
+ * a snímek perzistentního stromu. Počty uzlů všech stromů se porovnávají
+ * s modelem.
+ *
+ * Program je určený pro překlad s -fsanitize=address,undefined (make fuzz).
+ * Při první neshodě vypíše číslo operace a skončí s návratovým kódem 1.
+ * S AddressSanitizerem se při ukončení za únik považuje i paměť dosažitelná
+ * z globálních proměnných nebo zásobníku, po zrušení všech stromů tedy
+ * nesmí zůstat alokované nic.
+ *
+ * Použití: ./fuzz [počet_operací] [semínko]
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "btree.h"
+#include "bulk.h"
+#include "concurrent.h"
+#include "image.h"
+#include "lazy.h"
+#include "persistent.h"
+#include "splay.h"
+#include <limits.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// Největší výška stromu, pro kterou se porovnávají průchody (viz bench.c)
+#ifndef BST_TRAVERSAL_MAX_HEIGHT
+#define BST_TRAVERSAL_MAX_HEIGHT INT_MAX
+#endif
+
+// Počet možných klíčů
+#define FUZZ_KEYS (UCHAR_MAX + 1)
+
+// Po kolika operacích se průměrně provede úplná kontrola
+#define FUZZ_CHECK_PERIOD 64
+
+// Po kolika operacích se kontroluje uložení a načtení obrazu
+#define FUZZ_IMAGE_PERIOD 4096
+
+// Uzel referenčního modelu
+typedef struct model_node {
+  char key;
+  int value;
+  struct model_node *left;
+  struct model_node *right;
+} model_node_t;
+
+// Stav testování
+typedef struct fuzz {
+  uint64_t random;              // stav generátoru
+  long operation;               // číslo aktuální operace
+  int key_space;                // počet klíčů, ze kterých se vybírá
+  model_node_t *model;          // referenční model
+  bst_node_t *tree;             // testovaná implementace btree.h
+  bst_conc_t conc_tree;         // souběžný strom
+  bst_pers_node_t *pers_tree;   // aktuální verze perzistentního stromu
+  bst_pers_node_t *snapshot;    // dřívější verze perzistentního stromu
+  bst_node_t *splay_tree;       // splay strom
+  bst_lazy_t lazy_tree;         // strom s náhrobky
+  bool snapshot_present[FUZZ_KEYS]; // obsah snímku podle modelu
+  int snapshot_values[FUZZ_KEYS];
+} fuzz_t;
+
+// Posloupnost uzlů průchodu
+typedef struct fuzz_trace {
+  char keys[FUZZ_KEYS];
+  int values[FUZZ_KEYS];
+  int size;
+} fuzz_trace_t;
+
+static uint64_t fuzz_random(fuzz_t *fuzz)
+{
+  fuzz->random ^= fuzz->random << 13;
+  fuzz->random ^= fuzz->random >> 7;
+  fuzz->random ^= fuzz->random << 17;
+  return fuzz->random;
+}
+
+/*
+ * Výpis neshody a ukončení programu.
+ */
+static void fuzz_fail(fuzz_t *fuzz, const char *format, ...)
+{
+  va_list args;
+
+  fprintf(stderr, "[E] operation %ld: ", fuzz->operation);
+  va_start(args, format);
+  vfprintf(stderr, format, args);
+  va_end(args);
+  fprintf(stderr, "\n");
+  exit(1);
+}
+
+static bst_node_content_t fuzz_content(int value)
+{
+  bst_node_content_t content = {.type = INTEGER, .value = malloc(sizeof(int))};
+  *(int *)content.value = value;
+  return content;
+}
+
+/*
+ * Operace referenčního modelu. Chovají se podle zadání btree.h, uzel se
+ * dvěma podstromy nahrazuje nejpravější uzel levého podstromu.
+ */
+static void model_insert(model_node_t **tree, char key, int value)
+{
+  while (*tree != NULL && (*tree)->key != key)
+  {
+    tree = key < (*tree)->key ? &(*tree)->left : &(*tree)->right;
+  }
+  if (*tree == NULL)
+  {
+    *tree = calloc(1, sizeof(model_node_t));
+    (*tree)->key = key;
+  }
+  (*tree)->value = value;
+}
+
+static void model_delete(model_node_t **tree, char key)
+{
+  while (*tree != NULL && (*tree)->key != key)
+  {
+    tree = key < (*tree)->key ? &(*tree)->left : &(*tree)->right;
+  }
+  if (*tree == NULL)
+  {
+    return;
+  }
+
+  model_node_t *node = *tree;
+  if (node->left == NULL || node->right == NULL)
+  {
+    *tree = node->left != NULL ? node->left : node->right;
+    free(node);
+    return;
+  }
+
+  model_node_t **rightmost = &node->left;
+  while ((*rightmost)->right != NULL)
+  {
+    rightmost = &(*rightmost)->right;
+  }
+  model_node_t *replacement = *rightmost;
+  node->key = replacement->key;
+  node->value = replacement->value;
+  *rightmost = replacement->left;
+  free(replacement);
+}
+
+static model_node_t *model_search(model_node_t *tree, char key)
+{
+  while (tree != NULL && tree->key != key)
+  {
+    tree = key < tree->key ? tree->left : tree->right;
+  }
+  return tree;
+}
+
+static void model_dispose(model_node_t **tree)
+{
+  if (*tree != NULL)
+  {
+    model_dispose(&(*tree)->left);
+    model_dispose(&(*tree)->right);
+    free(*tree);
+    *tree = NULL;
+  }
+}
+
+static int model_height(model_node_t *tree)
+{
+  if (tree == NULL)
+  {
+    return 0;
+  }
+  int left = model_height(tree->left);
+  int right = model_height(tree->right);
+  return 1 + (left > right ? left : right);
+}
+
+/*
+ * Průchod modelem v pořadí order (0 preorder, 1 inorder, 2 postorder).
+ */
+static void model_trace(model_node_t *tree, int order, fuzz_trace_t *trace)
+{
+  if (tree == NULL)
+  {
+    return;
+  }
+  if (order == 0)
+  {
+    trace->keys[trace->size] = tree->key;
+    trace->values[trace->size++] = tree->value;
+  }
+  model_trace(tree->left, order, trace);
+  if (order == 1)
+  {
+    trace->keys[trace->size] = tree->key;
+    trace->values[trace->size++] = tree->value;
+  }
+  model_trace(tree->right, order, trace);
+  if (order == 2)
+  {
+    trace->keys[trace->size] = tree->key;
+    trace->values[trace->size++] = tree->value;
+  }
+}
+
+/*
+ * Porovnání tvaru, klíčů a hodnot stromu s modelem.
+ */
+static void fuzz_compare_shape(fuzz_t *fuzz, bst_node_t *tree,
+                               model_node_t *model)
+{
+  if (tree == NULL || model == NULL)
+  {
+    if ((tree == NULL) != (model == NULL))
+    {
+      fuzz_fail(fuzz, "shape differs near key %d",
+                tree != NULL ? tree->key : model->key);
+    }
+    return;
+  }
+  if (tree->key != model->key || tree->content.type != INTEGER ||
+      *(int *)tree->content.value != model->value)
+  {
+    fuzz_fail(fuzz, "node (%d,%d) differs from model (%d,%d)", tree->key,
+              *(int *)tree->content.value, model->key, model->value);
+  }
+  fuzz_compare_shape(fuzz, tree->left, model->left);
+  fuzz_compare_shape(fuzz, tree->right, model->right);
+}
+
+static int fuzz_count(bst_node_t *tree)
+{
+  return tree == NULL ? 0
+                      : 1 + fuzz_count(tree->left) + fuzz_count(tree->right);
+}
+
+/*
+ * Vnitřní průchod stromem bez omezení výšky (splay strom může být hlubší
+ * než BST_TRAVERSAL_MAX_HEIGHT).
+ */
+static void fuzz_trace_inorder(bst_node_t *tree, fuzz_trace_t *trace)
+{
+  if (tree == NULL)
+  {
+    return;
+  }
+  fuzz_trace_inorder(tree->left, trace);
+  trace->keys[trace->size] = tree->key;
+  trace->values[trace->size] = *(int *)tree->content.value;
+  trace->size++;
+  fuzz_trace_inorder(tree->right, trace);
+}
+
+/*
+ * Porovnání průchodu implementace s průchodem modelu.
+ */
+static void fuzz_compare_items(fuzz_t *fuzz, const char *name,
+                               bst_items_t *items, fuzz_trace_t *trace)
+{
+  if (items->size != trace->size)
+  {
+    fuzz_fail(fuzz, "%s visited %d nodes, model has %d", name, items->size,
+              trace->size);
+  }
+  for (int i = 0; i < trace->size; i++)
+  {
+    if (items->nodes[i]->key != trace->keys[i] ||
+        *(int *)items->nodes[i]->content.value != trace->values[i])
+    {
+      fuzz_fail(fuzz, "%s differs at position %d", name, i);
+    }
+  }
+}
+
+/*
+ * Porovnání výsledku vyhledání klíče key ve všech implementacích s modelem.
+ */
+static void fuzz_check_key(fuzz_t *fuzz, char key)
+{
+  model_node_t *expected = model_search(fuzz->model, key);
+  bst_node_content_t *found;
+  bst_node_content_t copy;
+
+  bool present = bst_search(fuzz->tree, key, &found);
+  if (present != (expected != NULL) ||
+      (present && *(int *)found->value != expected->value))
+  {
+    fuzz_fail(fuzz, "bst_search(%d) differs from model", key);
+  }
+
+  bst_conc_read_begin(&fuzz->conc_tree);
+  present = bst_conc_search(&fuzz->conc_tree, key, &copy);
+  if (present != (expected != NULL) ||
+      (present && *(int *)copy.value != expected->value))
+  {
+    fuzz_fail(fuzz, "bst_conc_search(%d) differs from model", key);
+  }
+  bst_conc_read_end(&fuzz->conc_tree);
+
+  present = bst_pers_search(fuzz->pers_tree, key, &found);
+  if (present != (expected != NULL) ||
+      (present && *(int *)found->value != expected->value))
+  {
+    fuzz_fail(fuzz, "bst_pers_search(%d) differs from model", key);
+  }
+
+  present = bst_splay_search(&fuzz->splay_tree, key, &found);
+  if (present != (expected != NULL) ||
+      (present && *(int *)found->value != expected->value))
+  {
+    fuzz_fail(fuzz, "bst_splay_search(%d) differs from model", key);
+  }
+  if (present && fuzz->splay_tree->key != key)
+  {
+    fuzz_fail(fuzz, "bst_splay_search(%d) did not move the key to the root",
+              key);
+  }
+
+  present = bst_lazy_search(&fuzz->lazy_tree, key, &found);
+  if (present != (expected != NULL) ||
+      (present && *(int *)found->value != expected->value))
+  {
+    fuzz_fail(fuzz, "bst_lazy_search(%d) differs from model", key);
+  }
+
+  int slot = (unsigned char)key;
+  present = bst_pers_search(fuzz->snapshot, key, &found);
+  if (present != fuzz->snapshot_present[slot] ||
+      (present && *(int *)found->value != fuzz->snapshot_values[slot]))
+  {
+    fuzz_fail(fuzz, "persistent snapshot changed at key %d", key);
+  }
+}
+
+/*
+ * Pořízení nového snímku perzistentního stromu.
+ */
+static void fuzz_snapshot(fuzz_t *fuzz)
+{
+  bst_pers_release(&fuzz->snapshot);
+  fuzz->snapshot = bst_pers_retain(fuzz->pers_tree);
+  for (int key = CHAR_MIN; key <= CHAR_MAX; key++)
+  {
+    model_node_t *node = model_search(fuzz->model, (char)key);
+    fuzz->snapshot_present[(unsigned char)key] = node != NULL;
+    fuzz->snapshot_values[(unsigned char)key] = node != NULL ? node->value : 0;
+  }
+}
+
+/*
+ * Úplná kontrola všech implementací proti modelu.
+ */
+static void fuzz_check_all(fuzz_t *fuzz)
+{
+  fuzz_trace_t trace;
+  bst_items_t items = {NULL, 0, 0};
+  void (*traversals[])(bst_node_t *, bst_items_t *) = {
+      bst_preorder, bst_inorder, bst_postorder};
+  const char *names[] = {"bst_preorder", "bst_inorder", "bst_postorder"};
+
+  fuzz_compare_shape(fuzz, fuzz->tree, fuzz->model);
+
+  if (model_height(fuzz->model) <= BST_TRAVERSAL_MAX_HEIGHT)
+  {
+    for (int order = 0; order < 3; order++)
+    {
+      trace.size = 0;
+      items.size = 0;
+      model_trace(fuzz->model, order, &trace);
+      traversals[order](fuzz->tree, &items);
+      fuzz_compare_items(fuzz, names[order], &items, &trace);
+    }
+  }
+
+  for (int key = CHAR_MIN; key <= CHAR_MAX; key++)
+  {
+    fuzz_check_key(fuzz, (char)key);
+  }
+
+  // Splay strom má jiný tvar, ale stejné pořadí klíčů jako model
+  fuzz_trace_t splay_trace = {.size = 0};
+  trace.size = 0;
+  model_trace(fuzz->model, 1, &trace);
+  fuzz_trace_inorder(fuzz->splay_tree, &splay_trace);
+  if (splay_trace.size != trace.size)
+  {
+    fuzz_fail(fuzz, "splay tree has %d nodes, model has %d", splay_trace.size,
+              trace.size);
+  }
+  for (int i = 0; i < trace.size; i++)
+  {
+    if (splay_trace.keys[i] != trace.keys[i] ||
+        splay_trace.values[i] != trace.values[i])
+    {
+      fuzz_fail(fuzz, "splay tree inorder differs at position %d", i);
+    }
+  }
+
+  // Strom s náhrobky prochází jen platné uzly
+  items.size = 0;
+  bst_lazy_inorder(&fuzz->lazy_tree, &items);
+  fuzz_compare_items(fuzz, "bst_lazy_inorder", &items, &trace);
+  if (fuzz->lazy_tree.size != trace.size)
+  {
+    fuzz_fail(fuzz, "lazy tree counts %d nodes, model has %d",
+              fuzz->lazy_tree.size, trace.size);
+  }
+
+  // Hromadně sestavený strom musí mít stejný obsah jako model
+  bst_node_content_t values[FUZZ_KEYS];
+  for (int i = 0; i < trace.size; i++)
+  {
+    values[i] = fuzz_content(trace.values[i]);
+  }
+  bst_node_t *built;
+  bool contiguous = fuzz_random(fuzz) & 1;
+  bst_build_from_sorted(&built, trace.keys, values, trace.size, contiguous);
+  for (int i = 0; i < trace.size; i++)
+  {
+    bst_node_content_t *found;
+    if (!bst_search(built, trace.keys[i], &found) ||
+        *(int *)found->value != trace.values[i])
+    {
+      fuzz_fail(fuzz, "bulk built tree lost key %d", trace.keys[i]);
+    }
+  }
+  if (fuzz_count(built) != trace.size)
+  {
+    fuzz_fail(fuzz, "bulk built tree has %d nodes, model has %d",
+              fuzz_count(built), trace.size);
+  }
+  if (contiguous)
+  {
+    bst_dispose_contiguous(&built);
+  }
+  else
+  {
+    bst_dispose(&built);
+  }
+
+  free(items.nodes);
+}
+
+/*
+ * Uložení stromu, načtení a vyhledání v namapovaném obrazu.
+ */
+static void fuzz_check_image(fuzz_t *fuzz)
+{
+  char path[] = "/tmp/bst_fuzzXXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0)
+  {
+    return;
+  }
+  close(fd);
+
+  bst_node_t *loaded;
+  bst_image_t image;
+  if (!bst_save(fuzz->tree, path) || !bst_load(&loaded, path) ||
+      !bst_image_open(&image, path))
+  {
+    fuzz_fail(fuzz, "cannot save and load the tree image");
+  }
+
+  for (int key = CHAR_MIN; key <= CHAR_MAX; key++)
+  {
+    model_node_t *expected = model_search(fuzz->model, (char)key);
+    bst_node_content_t *found;
+    bst_image_value_t value;
+
+    bool present = bst_search(loaded, (char)key, &found);
+    if (present != (expected != NULL) ||
+        (present && *(int *)found->value != expected->value))
+    {
+      fuzz_fail(fuzz, "loaded tree differs at key %d", key);
+    }
+    present = bst_image_search(&image, (char)key, &value);
+    if (present != (expected != NULL) ||
+        (present && value.integer != expected->value))
+    {
+      fuzz_fail(fuzz, "mapped image differs at key %d", key);
+    }
+  }
+
+  bst_image_close(&image);
+  bst_dispose(&loaded);
+  unlink(path);
+}
+
+/*
+ * Zrušení všech stromů.
+ */
+static void fuzz_dispose(fuzz_t *fuzz)
+{
+  model_dispose(&fuzz->model);
+  bst_dispose(&fuzz->tree);
+  if (fuzz->tree != NULL)
+  {
+    fuzz_fail(fuzz, "bst_dispose left a non-empty tree");
+  }
+  bst_conc_dispose(&fuzz->conc_tree);
+  bst_splay_dispose(&fuzz->splay_tree);
+  bst_lazy_dispose(&fuzz->lazy_tree);
+  bst_pers_release(&fuzz->pers_tree);
+  bst_pers_release(&fuzz->snapshot);
+}
+
+/*
+ * Provedení jedné náhodné operace.
+ */
+static void fuzz_step(fuzz_t *fuzz)
+{
+  uint64_t r = fuzz_random(fuzz);
+  char key = (char)(CHAR_MIN + (r >> 8) % fuzz->key_space);
+  int value = (int)(r >> 32);
+  int choice = r % 1000;
+
+  if (choice < 450)
+  {
+    model_insert(&fuzz->model, key, value);
+    bst_insert(&fuzz->tree, key, fuzz_content(value));
+    bst_conc_insert(&fuzz->conc_tree, key, fuzz_content(value));
+    bst_splay_insert(&fuzz->splay_tree, key, fuzz_content(value));
+    bst_lazy_insert(&fuzz->lazy_tree, key, fuzz_content(value));
+    bst_pers_node_t *version =
+        bst_pers_insert(fuzz->pers_tree, key, fuzz_content(value));
+    bst_pers_release(&fuzz->pers_tree);
+    fuzz->pers_tree = version;
+  }
+  else if (choice < 750)
+  {
+    model_delete(&fuzz->model, key);
+    bst_delete(&fuzz->tree, key);
+    bst_conc_delete(&fuzz->conc_tree, key);
+    bst_splay_delete(&fuzz->splay_tree, key);
+    bst_lazy_delete(&fuzz->lazy_tree, key);
+    bst_pers_node_t *version = bst_pers_delete(fuzz->pers_tree, key);
+    bst_pers_release(&fuzz->pers_tree);
+    fuzz->pers_tree = version;
+  }
+  else if (choice < 990)
+  {
+    // Samotné vyhledání, kontroluje se níže
+  }
+  else if (choice < 998)
+  {
+    fuzz_snapshot(fuzz);
+  }
+  else
+  {
+    // Začátek nové série s jiným rozsahem klíčů, bst_conc_dispose vrátí
+    // souběžný strom do stavu po inicializaci
+    fuzz_dispose(fuzz);
+    bst_init(&fuzz->tree);
+    bst_init(&fuzz->splay_tree);
+    bst_lazy_init(&fuzz->lazy_tree);
+    fuzz->key_space = 1 + fuzz_random(fuzz) % FUZZ_KEYS;
+    fuzz_snapshot(fuzz);
+  }
+
+  fuzz_check_key(fuzz, key);
+  if (fuzz_random(fuzz) % FUZZ_CHECK_PERIOD == 0)
+  {
+    fuzz_check_all(fuzz);
+  }
+  if (fuzz->operation % FUZZ_IMAGE_PERIOD == 0)
+  {
+    fuzz_check_image(fuzz);
+  }
+}
+
+#ifdef __SANITIZE_ADDRESS__
+const char *__lsan_default_options(void)
+{
+  return "use_globals=0:use_stacks=0:use_registers=0:use_tls=0:"
+         "print_suppressions=0";
+}
+
+// Rezervu pro výjimky si při načtení alokuje libstdc++ (runtime UBSan)
+const char *__lsan_default_suppressions(void)
+{
+  return "leak:libstdc++\n";
+}
+#endif
+
+int main(int argc, char *argv[])
+{
+  long operations = argc > 1 ? atol(argv[1]) : 200000;
+  uint64_t seed = argc > 2 ? strtoull(argv[2], NULL, 0) : 88172645463325252ull;
+  fuzz_t *fuzz = calloc(1, sizeof(fuzz_t));
+
+  // Vyrovnávací paměť výstupu by se při kontrole úniků počítala jako únik
+  setvbuf(stdout, NULL, _IONBF, 0);
+  printf("fuzz: %ld operations, seed %llu\n", operations,
+         (unsigned long long)seed);
+
+  fuzz->random = seed != 0 ? seed : 1;
+  fuzz->key_space = FUZZ_KEYS;
+  bst_init(&fuzz->tree);
+  bst_init(&fuzz->splay_tree);
+  bst_lazy_init(&fuzz->lazy_tree);
+  bst_conc_init(&fuzz->conc_tree);
+  fuzz_snapshot(fuzz);
+
+  for (fuzz->operation = 1; fuzz->operation <= operations; fuzz->operation++)
+  {
+    fuzz_step(fuzz);
+  }
+  fuzz_check_all(fuzz);
+  fuzz_dispose(fuzz);
+  bst_conc_thread_exit();
+  free(fuzz);
+  printf("fuzz: OK\n");
+  return 0;
+}
@@ -0,0 +1,382 @@
+/*
+ * Uložení stromu do souboru
+ *
+ * Soubor neobsahuje žádné ukazatele, lze ho proto namapovat do paměti
+ * a vyhledávat v něm přímo. Všechna čísla jsou little-endian:
+ *
+ *   hlavička   "BSTI", verze (4 B), počet záznamů (4 B), velikost jmen (4 B)
+ *   záznamy    po 8 B seřazené podle klíče:
+ *                klíč (1 B), typ (1 B), povolání (1 B), úroveň (1 B),
+ *                hodnota INTEGER nebo posun jména v oblasti jmen (4 B)
+ *   jména      řetězce ukončené nulou
+ *
+ * bst_load z obrazu sestaví vyvážený strom v čase O(n) (viz bulk.c),
+ * tvar původního stromu se neukládá. bst_image_open soubor jen namapuje
+ * a zkontroluje, vyhledávání je půlení intervalu přímo nad záznamy.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "image.h"
+#include "../common/writer.h"
+#include "bulk.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * Pomocná funkce pro čtení 32bitového čísla v pořadí little-endian.
+ */
+static uint32_t bst_image_u32(const unsigned char *bytes)
+{
+  return (uint32_t)bytes[0] | (uint32_t)bytes[1] << 8 |
+         (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+}
+
+/*
+ * Pomocná funkce pro spočítání uzlů a velikosti jmen podstromu.
+ */
+static void bst_image_measure(bst_node_t *tree, uint32_t *count,
+                              uint32_t *names_size)
+{
+  if (tree == NULL)
+  {
+    return;
+  }
+  bst_image_measure(tree->left, count, names_size);
+  (*count)++;
+  if (tree->content.type == CHARACTER_T)
+  {
+    *names_size += strlen(((character_t *)tree->content.value)->name) + 1;
+  }
+  bst_image_measure(tree->right, count, names_size);
+}
+
+/*
+ * Pomocná funkce pro zápis záznamů podstromu v pořadí inorder.
+ */
+static void bst_image_write_records(writer_t *writer, bst_node_t *tree,
+                                    uint32_t *name_offset)
+{
+  if (tree == NULL)
+  {
+    return;
+  }
+  bst_image_write_records(writer, tree->left, name_offset);
+
+  writer_u8(writer, (uint8_t)tree->key);
+  writer_u8(writer, (uint8_t)tree->content.type);
+  if (tree->content.type == CHARACTER_T)
+  {
+    character_t *character = tree->content.value;
+    writer_u8(writer, (uint8_t)character->character_class);
+    writer_u8(writer, character->level);
+    writer_u32(writer, *name_offset);
+    *name_offset += strlen(character->name) + 1;
+  }
+  else
+  {
+    writer_u8(writer, 0);
+    writer_u8(writer, 0);
+    writer_u32(writer, (uint32_t)*(int *)tree->content.value);
+  }
+
+  bst_image_write_records(writer, tree->right, name_offset);
+}
+
+/*
+ * Pomocná funkce pro zápis jmen podstromu v pořadí inorder.
+ */
+static void bst_image_write_names(writer_t *writer, bst_node_t *tree)
+{
+  if (tree == NULL)
+  {
+    return;
+  }
+  bst_image_write_names(writer, tree->left);
+  if (tree->content.type == CHARACTER_T)
+  {
+    const char *name = ((character_t *)tree->content.value)->name;
+    writer_bytes(writer, name, strlen(name) + 1);
+  }
+  bst_image_write_names(writer, tree->right);
+}
+
+/*
+ * Uložení stromu do souboru path.
+ *
+ * Při chybě vrací false, soubor pak může být neúplný.
+ */
+bool bst_save(bst_node_t *tree, const char *path)
+{
+  FILE *stream = fopen(path, "wb");
+  if (stream == NULL)
+  {
+    return false;
+  }
+  writer_t *writer = malloc(sizeof(writer_t));
+  if (writer == NULL)
+  {
+    fclose(stream);
+    return false;
+  }
+  writer_init(writer, stream);
+
+  uint32_t count = 0;
+  uint32_t names_size = 0;
+  uint32_t name_offset = 0;
+  bst_image_measure(tree, &count, &names_size);
+
+  writer_bytes(writer, BST_IMAGE_MAGIC, 4);
+  writer_u32(writer, BST_IMAGE_VERSION);
+  writer_u32(writer, count);
+  writer_u32(writer, names_size);
+  bst_image_write_records(writer, tree, &name_offset);
+  bst_image_write_names(writer, tree);
+
+  bool result = writer_flush(writer);
+  free(writer);
+  return fclose(stream) == 0 && result;
+}
+
+/*
+ * Pomocná funkce pro kontrolu obsahu namapovaného souboru.
+ *
+ * Ověří hlavičku, velikost, vzestupné pořadí klíčů a platnost jmen,
+ * aby vyhledávání i načtení mohlo obsahu důvěřovat.
+ */
+static bool bst_image_validate(bst_image_t *image)
+{
+  if (image->size < BST_IMAGE_HEADER_SIZE ||
+      memcmp(image->data, BST_IMAGE_MAGIC, 4) != 0 ||
+      bst_image_u32(image->data + 4) != BST_IMAGE_VERSION)
+  {
+    return false;
+  }
+
+  uint32_t count = bst_image_u32(image->data + 8);
+  uint32_t names_size = bst_image_u32(image->data + 12);
+  if ((uint64_t)count * BST_IMAGE_RECORD_SIZE + names_size !=
+      image->size - BST_IMAGE_HEADER_SIZE)
+  {
+    return false;
+  }
+
+  image->count = count;
+  image->records = image->data + BST_IMAGE_HEADER_SIZE;
+  image->names = (const char *)image->records + count * BST_IMAGE_RECORD_SIZE;
+  if (names_size > 0 && image->names[names_size - 1] != '\0')
+  {
+    return false;
+  }
+
+  for (uint32_t i = 0; i < count; i++)
+  {
+    const unsigned char *record = image->records + i * BST_IMAGE_RECORD_SIZE;
+    if (i > 0 && (char)record[0] <= (char)record[-BST_IMAGE_RECORD_SIZE])
+    {
+      return false;
+    }
+    if (record[1] == CHARACTER_T)
+    {
+      if (bst_image_u32(record + 4) >= names_size)
+      {
+        return false;
+      }
+    }
+    else if (record[1] != INTEGER)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * Otevření obrazu stromu ze souboru path pouze pro čtení.
+ *
+ * Soubor se namapuje do paměti a nic se z něj nekopíruje. Při chybě nebo
+ * neplatném obsahu vrací false.
+ */
+bool bst_image_open(bst_image_t *image, const char *path)
+{
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+  {
+    return false;
+  }
+
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size < BST_IMAGE_HEADER_SIZE)
+  {
+    close(fd);
+    return false;
+  }
+
+  void *data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+  {
+    return false;
+  }
+
+  image->data = data;
+  image->size = info.st_size;
+  if (!bst_image_validate(image))
+  {
+    bst_image_close(image);
+    return false;
+  }
+  return true;
+}
+
+/*
+ * Pomocná funkce pro převod záznamu na hodnotu.
+ */
+static void bst_image_decode(const bst_image_t *image,
+                             const unsigned char *record,
+                             bst_image_value_t *value)
+{
+  value->type = record[1];
+  if (value->type == CHARACTER_T)
+  {
+    value->character.name = (char *)image->names + bst_image_u32(record + 4);
+    value->character.character_class = record[2];
+    value->character.level = record[3];
+  }
+  else
+  {
+    value->integer = (int)bst_image_u32(record + 4);
+  }
+}
+
+/*
+ * Vyhledání klíče v obrazu stromu.
+ *
+ * Pokud klíč existuje, vyplní value a vrátí true. Jméno postavy ukazuje
+ * přímo do mapování a je platné do zavolání bst_image_close.
+ */
+bool bst_image_search(const bst_image_t *image, char key,
+                      bst_image_value_t *value)
+{
+  uint32_t low = 0;
+  uint32_t high = image->count;
+
+  while (low < high)
+  {
+    uint32_t mid = low + (high - low) / 2;
+    const unsigned char *record = image->records + mid * BST_IMAGE_RECORD_SIZE;
+    char current = (char)record[0];
+
+    if (current == key)
+    {
+      bst_image_decode(image, record, value);
+      return true;
+    }
+    if (current < key)
+    {
+      low = mid + 1;
+    }
+    else
+    {
+      high = mid;
+    }
+  }
+  return false;
+}
+
+/*
+ * Uzavření obrazu stromu a zrušení mapování.
+ */
+void bst_image_close(bst_image_t *image)
+{
+  if (image->data != NULL)
+  {
+    munmap((void *)image->data, image->size);
+  }
+  image->data = NULL;
+  image->size = 0;
+  image->records = NULL;
+  image->names = NULL;
+  image->count = 0;
+}
+
+/*
+ * Načtení stromu ze souboru path.
+ *
+ * Strom se inicializuje a sestaví jako výškově vyvážený v čase O(n). Každá
+ * postava se alokuje v jednom bloku spolu se jménem, takže ji uvolní běžné
+ * bst_delete a bst_dispose. Při chybě vrací false a strom zůstane prázdný.
+ */
+bool bst_load(bst_node_t **tree, const char *path)
+{
+  bst_image_t image;
+  bst_init(tree);
+  if (!bst_image_open(&image, path))
+  {
+    return false;
+  }
+
+  uint32_t count = image.count;
+  char *keys = malloc(count > 0 ? count : 1);
+  bst_node_content_t *values =
+      malloc((count > 0 ? count : 1) * sizeof(bst_node_content_t));
+  bool result = keys != NULL && values != NULL;
+  uint32_t loaded = 0;
+
+  for (; result && loaded < count; loaded++)
+  {
+    const unsigned char *record =
+        image.records + loaded * BST_IMAGE_RECORD_SIZE;
+    bst_image_value_t value;
+    bst_image_decode(&image, record, &value);
+    keys[loaded] = (char)record[0];
+    values[loaded].type = value.type;
+
+    if (value.type == CHARACTER_T)
+    {
+      size_t length = strlen(value.character.name) + 1;
+      character_t *character = malloc(sizeof(character_t) + length);
+      if (character == NULL)
+      {
+        result = false;
+        break;
+      }
+      *character = value.character;
+      character->name = (char *)(character + 1);
+      memcpy(character->name, value.character.name, length);
+      values[loaded].value = character;
+    }
+    else
+    {
+      int *integer = malloc(sizeof(int));
+      if (integer == NULL)
+      {
+        result = false;
+        break;
+      }
+      *integer = value.integer;
+      values[loaded].value = integer;
+    }
+  }
+
+  if (result)
+  {
+    bst_build_from_sorted(tree, keys, values, count, false);
+  }
+  else
+  {
+    for (uint32_t i = 0; i < loaded; i++)
+    {
+      free(values[i].value);
+    }
+  }
+
+  free(values);
+  free(keys);
+  bst_image_close(&image);
+  return result;
+}
@@ -0,0 +1,48 @@
+/*
+ * Hlavičkový soubor pro uložení stromu do souboru a vyhledávání v obrazu
+ * stromu namapovaném do paměti.
+ */
+
+#ifndef IAL_BTREE_IMAGE_H
+#define IAL_BTREE_IMAGE_H
+
+#include "btree.h"
+#include "character.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Identifikace a verze formátu
+#define BST_IMAGE_MAGIC "BSTI"
+#define BST_IMAGE_VERSION 1
+
+// Velikost hlavičky a jednoho záznamu v bajtech
+#define BST_IMAGE_HEADER_SIZE 16
+#define BST_IMAGE_RECORD_SIZE 8
+
+// Obraz stromu namapovaný do paměti (pouze pro čtení)
+typedef struct bst_image {
+  const unsigned char *data;    // začátek mapování
+  size_t size;                  // velikost mapování
+  const unsigned char *records; // záznamy seřazené podle klíče
+  const char *names;            // oblast jmen
+  uint32_t count;               // počet záznamů
+} bst_image_t;
+
+// Hodnota nalezená v obrazu stromu
+typedef struct bst_image_value {
+  bst_node_content_type_t type; // datový typ hodnoty
+  int integer;                  // hodnota typu INTEGER
+  character_t character;        // hodnota typu CHARACTER_T, jméno ukazuje
+                                // do mapování
+} bst_image_value_t;
+
+bool bst_save(bst_node_t *tree, const char *path);
+bool bst_load(bst_node_t **tree, const char *path);
+
+bool bst_image_open(bst_image_t *image, const char *path);
+bool bst_image_search(const bst_image_t *image, char key,
+                      bst_image_value_t *value);
+void bst_image_close(bst_image_t *image);
+
+#endif
@@ -0,0 +1,262 @@
+/*
+ * Binární vyhledávací strom s odloženým odstraněním uzlů
+ *
+ * bst_lazy_delete uzel ze stromu nevyjme, jen ho označí jako odstraněný
+ * (náhrobek): nic se nepřesouvá ani neuvolňuje a odstranění stojí jen
+ * vyhledání uzlu. Vyhledání a průchod odstraněné uzly přeskakují, vložení
+ * odstraněného klíče uzel znovu oživí.
+ *
+ * Náhrobky se neukládají do uzlů (btree.h se nemění), ale do bitové mapy
+ * podle klíče; klíč typu char má jen UCHAR_MAX + 1 možných hodnot. Uzly tak
+ * zůstávají obyčejnými bst_node_t.
+ *
+ * Jakmile odstraněné uzly tvoří víc než BST_LAZY_DEAD_PERCENT % stromu,
+ * bst_lazy_compact je najednou uvolní a ze zbylých uzlů sestaví vyvážený
+ * strom (bez nové alokace). Zhuštění stojí O(n), ale předchází mu alespoň
+ * n * BST_LAZY_DEAD_PERCENT / 100 odstranění, amortizovaná cena odstranění
+ * je tedy O(log n).
+ */
+
+#include "lazy.h"
+#include <stdlib.h>
+
+/* Index a maska náhrobku klíče */
+static int bst_lazy_word(int key)
+{
+  return (unsigned char)key / 64;
+}
+
+static uint64_t bst_lazy_bit(int key)
+{
+  return (uint64_t)1 << ((unsigned char)key % 64);
+}
+
+/* Test, zda je uzel odstraněný */
+static bool bst_lazy_is_dead(bst_lazy_t *tree, bst_node_t *node)
+{
+  return (tree->tombstones[bst_lazy_word(node->key)] &
+          bst_lazy_bit(node->key)) != 0;
+}
+
+/*
+ * Pomocná funkce pro nalezení uzlu s klíčem key (i odstraněného), nebo NULL.
+ */
+static bst_node_t *bst_lazy_find(bst_lazy_t *tree, char key)
+{
+  bst_node_t *node = tree->root;
+
+  while (node != NULL && node->key != key)
+  {
+    node = key < node->key ? node->left : node->right;
+  }
+  return node;
+}
+
+/*
+ * Inicializace prázdného stromu.
+ */
+void bst_lazy_init(bst_lazy_t *tree)
+{
+  tree->root = NULL;
+  tree->size = 0;
+  tree->dead = 0;
+  for (int i = 0; i < (UCHAR_MAX + 1) / 64; i++)
+  {
+    tree->tombstones[i] = 0;
+  }
+}
+
+/*
+ * Vložení uzlu do stromu.
+ *
+ * Pokud uzel se zadaným klíčem už ve stromu existuje (i odstraněný), nahradí
+ * se jeho hodnota a uzel je opět platný. Jinak se vloží nový listový uzel.
+ */
+void bst_lazy_insert(bst_lazy_t *tree, char key, bst_node_content_t value)
+{
+  bst_node_t **link = &tree->root;
+
+  while (*link != NULL && (*link)->key != key)
+  {
+    link = key < (*link)->key ? &(*link)->left : &(*link)->right;
+  }
+
+  if (*link != NULL)
+  {
+    if (bst_lazy_is_dead(tree, *link))
+    {
+      tree->tombstones[bst_lazy_word(key)] &= ~bst_lazy_bit(key);
+      tree->dead--;
+      tree->size++;
+    }
+    if ((*link)->content.value != NULL)
+    {
+      free((*link)->content.value);
+    }
+    (*link)->content = value;
+    return;
+  }
+
+  *link = malloc(sizeof(bst_node_t));
+  if (*link != NULL)
+  {
+    (*link)->key = key;
+    (*link)->content = value;
+    (*link)->left = NULL;
+    (*link)->right = NULL;
+    tree->size++;
+  }
+}
+
+/*
+ * Vyhledání platného uzlu ve stromu.
+ *
+ * V případě úspěchu vrátí funkce hodnotu true a do proměnné value zapíše
+ * ukazatel na obsah uzlu. Odstraněné uzly se nenajdou.
+ */
+bool bst_lazy_search(bst_lazy_t *tree, char key, bst_node_content_t **value)
+{
+  bst_node_t *node = bst_lazy_find(tree, key);
+
+  if (node == NULL || bst_lazy_is_dead(tree, node))
+  {
+    return false;
+  }
+  *value = &node->content;
+  return true;
+}
+
+/*
+ * Odstranění uzlu označením náhrobkem.
+ *
+ * Pokud platný uzel se zadaným klíčem neexistuje, funkce nic nedělá. Hodnota
+ * uzlu se uvolní až při zhuštění stromu, které se spustí po překročení
+ * BST_LAZY_DEAD_PERCENT.
+ */
+void bst_lazy_delete(bst_lazy_t *tree, char key)
+{
+  bst_node_t *node = bst_lazy_find(tree, key);
+
+  if (node == NULL || bst_lazy_is_dead(tree, node))
+  {
+    return;
+  }
+
+  tree->tombstones[bst_lazy_word(key)] |= bst_lazy_bit(key);
+  tree->size--;
+  tree->dead++;
+  if (tree->dead * 100 > (tree->size + tree->dead) * BST_LAZY_DEAD_PERCENT)
+  {
+    bst_lazy_compact(tree);
+  }
+}
+
+/*
+ * Pomocná funkce pro inorder průchod, který přidá jen platné uzly (nebo
+ * všechny, pokud all je true). Rekurze nemá omezenou hloubku, strom před
+ * zhuštěním může být nevyvážený.
+ */
+static void bst_lazy_collect(bst_lazy_t *tree, bst_node_t *node,
+                             bst_items_t *items, bool all)
+{
+  if (node == NULL)
+  {
+    return;
+  }
+  bst_lazy_collect(tree, node->left, items, all);
+  if (all || !bst_lazy_is_dead(tree, node))
+  {
+    bst_add_node_to_items(node, items);
+  }
+  bst_lazy_collect(tree, node->right, items, all);
+}
+
+/*
+ * Inorder průchod platnými uzly stromu.
+ */
+void bst_lazy_inorder(bst_lazy_t *tree, bst_items_t *items)
+{
+  bst_lazy_collect(tree, tree->root, items, false);
+}
+
+/*
+ * Pomocná funkce pro sestavení vyváženého stromu z uzlů seřazených podle
+ * klíče. Vrací kořen.
+ */
+static bst_node_t *bst_lazy_link(bst_node_t **nodes, int count)
+{
+  if (count == 0)
+  {
+    return NULL;
+  }
+  int middle = count / 2;
+  nodes[middle]->left = bst_lazy_link(nodes, middle);
+  nodes[middle]->right = bst_lazy_link(nodes + middle + 1, count - middle - 1);
+  return nodes[middle];
+}
+
+/*
+ * Zhuštění stromu — uvolní odstraněné uzly i s hodnotami a ze zbylých uzlů
+ * sestaví vyvážený strom.
+ *
+ * Pokud se nepodaří alokovat pole uzlů nebo se nenajdou všechny uzly, strom
+ * zůstane beze změny (včetně náhrobků), jen se nezhustí.
+ */
+void bst_lazy_compact(bst_lazy_t *tree)
+{
+  int total = tree->size + tree->dead;
+  bst_items_t items = {NULL, total, 0};
+  int live = 0;
+
+  if (total == 0)
+  {
+    return;
+  }
+  // Pole má přesnou velikost, při sběru uzlů se už nerealokuje
+  items.nodes = malloc(total * sizeof(bst_node_t *));
+  if (items.nodes == NULL)
+  {
+    return;
+  }
+
+  bst_lazy_collect(tree, tree->root, &items, true);
+  if (items.size != total)
+  {
+    free(items.nodes);
+    return;
+  }
+
+  for (int i = 0; i < items.size; i++)
+  {
+    bst_node_t *node = items.nodes[i];
+    if (bst_lazy_is_dead(tree, node))
+    {
+      if (node->content.value != NULL)
+      {
+        free(node->content.value);
+      }
+      free(node);
+    }
+    else
+    {
+      items.nodes[live++] = node;
+    }
+  }
+
+  tree->root = bst_lazy_link(items.nodes, live);
+  tree->dead = 0;
+  for (int i = 0; i < (UCHAR_MAX + 1) / 64; i++)
+  {
+    tree->tombstones[i] = 0;
+  }
+  free(items.nodes);
+}
+
+/*
+ * Zrušení celého stromu včetně odstraněných uzlů.
+ */
+void bst_lazy_dispose(bst_lazy_t *tree)
+{
+  bst_dispose(&tree->root);
+  bst_lazy_init(tree);
+}
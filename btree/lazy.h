@@ -0,0 +1,36 @@
+/*
+ * Hlavičkový soubor pro binární vyhledávací strom s odloženým odstraněním
+ * uzlů (náhrobky).
+ */
+
+#ifndef IAL_BTREE_LAZY_H
+#define IAL_BTREE_LAZY_H
+
+#include "btree.h"
+#include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Podíl odstraněných uzlů ze všech uzlů stromu (v %), po jehož překročení
+ * se strom zhustí.
+ */
+#define BST_LAZY_DEAD_PERCENT 50
+
+// Strom s náhrobky
+typedef struct bst_lazy {
+  bst_node_t *root; // kořen stromu včetně odstraněných uzlů
+  int size;         // počet platných uzlů
+  int dead;         // počet odstraněných uzlů
+  uint64_t tombstones[(UCHAR_MAX + 1) / 64]; // odstraněné klíče
+} bst_lazy_t;
+
+void bst_lazy_init(bst_lazy_t *tree);
+void bst_lazy_insert(bst_lazy_t *tree, char key, bst_node_content_t value);
+bool bst_lazy_search(bst_lazy_t *tree, char key, bst_node_content_t **value);
+void bst_lazy_delete(bst_lazy_t *tree, char key);
+void bst_lazy_inorder(bst_lazy_t *tree, bst_items_t *items);
+void bst_lazy_compact(bst_lazy_t *tree);
+void bst_lazy_dispose(bst_lazy_t *tree);
+
+#endif
@@ -0,0 +1,253 @@
+/*
+ * Paralelní průchod a rušení binárního vyhledávacího stromu
+ *
+ * Horní patra stromu se rozdělí na samostatné uzly a podstromy ležící v dané
+ * hloubce. Podstromy tvoří úlohy, které si vlákna průběžně odebírají ze
+ * společného seznamu (vlákno, které svou úlohu dokončí dříve, si vezme další),
+ * a zpracují je sekvenční funkcí bst_inorder, resp. bst_dispose. Uzly nad
+ * hranicí rozdělení zpracuje volající vlákno.
+ *
+ * Uzly neuchovávají velikost podstromu, proto se strom nedělí podle počtu
+ * uzlů, ale podle hloubky tak, aby na každé vlákno připadlo
+ * BST_PARALLEL_TASKS_PER_THREAD podstromů. Zjištění velikostí by vyžadovalo
+ * sekvenční průchod celým stromem, tedy stejnou práci, jakou chceme rozdělit.
+ * U vyváženého stromu jsou podstromy v jedné hloubce přibližně stejně velké;
+ * nevyvážený strom (např. vzniklý vkládáním seřazených klíčů) se takto
+ * rovnoměrně nerozdělí a většinu práce dostane jediná úloha. Stromy s méně než
+ * bst_parallel_cutoff() uzly se zpracují sekvenčně.
+ */
+
+#include "parallel.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+// Aktuální hranice pro paralelní zpracování, viz bst_set_parallel_cutoff
+static int bst_cutoff = BST_PARALLEL_CUTOFF;
+
+/*
+ * Vrátí nejmenší počet uzlů, od kterého se strom zpracuje paralelně.
+ */
+int bst_parallel_cutoff()
+{
+  return bst_cutoff;
+}
+
+/*
+ * Nastaví nejmenší počet uzlů, od kterého se strom zpracuje paralelně, a vrátí
+ * předchozí hodnotu. Hodnota 0 vynutí paralelní zpracování i malých stromů.
+ */
+int bst_set_parallel_cutoff(int cutoff)
+{
+  int previous = bst_cutoff;
+  bst_cutoff = cutoff;
+  return previous;
+}
+
+// Část stromu zpracovávaná jako celek
+typedef struct bst_task {
+  bst_node_t *node;  // samostatný uzel nebo kořen podstromu
+  bool subtree;      // true pro celý podstrom, false pro samostatný uzel
+  bst_items_t chunk; // výsledek inorder průchodu podstromu
+} bst_task_t;
+
+// Seznam úloh v pořadí inorder
+typedef struct bst_task_list {
+  bst_task_t *tasks;       // pole úloh
+  int capacity;            // kapacita alokované paměti v počtu položek
+  int size;                // aktuální velikost pole v počtu položek
+  atomic_int next;         // index další nezpracované úlohy
+  void (*run)(bst_task_t *task); // zpracování podstromu
+} bst_task_list_t;
+
+/*
+ * Pomocná funkce pro přidání úlohy na konec seznamu.
+ */
+static void bst_task_add(bst_task_list_t *list, bst_node_t *node, bool subtree)
+{
+  if (list->capacity < list->size + 1)
+  {
+    list->capacity = list->capacity * 2 + 8;
+    list->tasks = realloc(list->tasks, list->capacity * sizeof(bst_task_t));
+  }
+  bst_task_t *task = &list->tasks[list->size++];
+  task->node = node;
+  task->subtree = subtree;
+  task->chunk.nodes = NULL;
+  task->chunk.capacity = 0;
+  task->chunk.size = 0;
+}
+
+/*
+ * Pomocná funkce která rozdělí strom na úlohy.
+ *
+ * Uzly v hloubce menší než depth se uloží jako samostatné uzly, podstromy
+ * v hloubce depth jako celé podstromy. Úlohy jsou v seznamu v pořadí inorder.
+ */
+static void bst_task_split(bst_node_t *tree, int depth, bst_task_list_t *list)
+{
+  if (tree == NULL)
+  {
+    return;
+  }
+  if (depth == 0)
+  {
+    bst_task_add(list, tree, true);
+    return;
+  }
+  bst_task_split(tree->left, depth - 1, list);
+  bst_task_add(list, tree, false);
+  bst_task_split(tree->right, depth - 1, list);
+}
+
+/*
+ * Pomocná funkce která spočítá uzly stromu, nejvýše však limit uzlů.
+ */
+static int bst_count_until(bst_node_t *tree, int limit)
+{
+  if (tree == NULL || limit <= 0)
+  {
+    return 0;
+  }
+  int count = 1 + bst_count_until(tree->left, limit - 1);
+  return count + bst_count_until(tree->right, limit - count);
+}
+
+/*
+ * Pracovní smyčka vlákna — odebírá podstromy ze seznamu, dokud nějaké zbývají.
+ */
+static void *bst_task_worker(void *arg)
+{
+  bst_task_list_t *list = arg;
+  int index;
+
+  while ((index = atomic_fetch_add(&list->next, 1)) < list->size)
+  {
+    if (list->tasks[index].subtree)
+    {
+      list->run(&list->tasks[index]);
+    }
+  }
+  return NULL;
+}
+
+/*
+ * Pomocná funkce která rozdělí strom a zpracuje jeho podstromy pomocí
+ * threads vláken (včetně volajícího).
+ */
+static void bst_task_run(bst_node_t *tree, int threads, bst_task_list_t *list)
+{
+  int depth = 0;
+  while ((1 << depth) < threads * BST_PARALLEL_TASKS_PER_THREAD)
+  {
+    depth++;
+  }
+  bst_task_split(tree, depth, list);
+  atomic_init(&list->next, 0);
+
+  pthread_t *workers = malloc((threads - 1) * sizeof(pthread_t));
+  int started = 0;
+  if (workers != NULL)
+  {
+    while (started < threads - 1 &&
+           pthread_create(&workers[started], NULL, bst_task_worker, list) == 0)
+    {
+      started++;
+    }
+  }
+
+  bst_task_worker(list);
+
+  for (int i = 0; i < started; i++)
+  {
+    pthread_join(workers[i], NULL);
+  }
+  free(workers);
+}
+
+static void bst_task_dispose(bst_task_t *task)
+{
+  bst_dispose(&task->node);
+}
+
+static void bst_task_inorder(bst_task_t *task)
+{
+  bst_inorder(task->node, &task->chunk);
+}
+
+/*
+ * Paralelní zrušení celého stromu.
+ *
+ * Výsledek je shodný s bst_dispose. Pro threads <= 1 nebo malý strom se
+ * použije přímo bst_dispose.
+ */
+void bst_dispose_parallel(bst_node_t **tree, int threads)
+{
+  if (threads <= 1 ||
+      bst_count_until(*tree, bst_cutoff) < bst_cutoff)
+  {
+    bst_dispose(tree);
+    return;
+  }
+
+  bst_task_list_t list = {.tasks = NULL, .capacity = 0, .size = 0,
+                          .run = bst_task_dispose};
+  bst_task_run(*tree, threads, &list);
+
+  // Horní patra stromu zůstala nedotčená, uvolníme je až nyní
+  for (int i = 0; i < list.size; i++)
+  {
+    bst_node_t *node = list.tasks[i].node;
+    if (!list.tasks[i].subtree)
+    {
+      if (node->content.value != NULL)
+      {
+        free(node->content.value);
+      }
+      free(node);
+    }
+  }
+  free(list.tasks);
+
+  *tree = NULL;
+}
+
+/*
+ * Paralelní inorder průchod stromem.
+ *
+ * Každý podstrom se prochází do vlastního pole, pole se nakonec spojí ve
+ * správném pořadí. Výsledek je shodný s bst_inorder. Pro threads <= 1 nebo
+ * malý strom se použije přímo bst_inorder.
+ */
+void bst_inorder_parallel(bst_node_t *tree, bst_items_t *items, int threads)
+{
+  if (threads <= 1 ||
+      bst_count_until(tree, bst_cutoff) < bst_cutoff)
+  {
+    bst_inorder(tree, items);
+    return;
+  }
+
+  bst_task_list_t list = {.tasks = NULL, .capacity = 0, .size = 0,
+                          .run = bst_task_inorder};
+  bst_task_run(tree, threads, &list);
+
+  for (int i = 0; i < list.size; i++)
+  {
+    bst_task_t *task = &list.tasks[i];
+    if (task->subtree)
+    {
+      for (int j = 0; j < task->chunk.size; j++)
+      {
+        bst_add_node_to_items(task->chunk.nodes[j], items);
+      }
+      free(task->chunk.nodes);
+    }
+    else
+    {
+      bst_add_node_to_items(task->node, items);
+    }
+  }
+  free(list.tasks);
+}
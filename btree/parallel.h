@@ -0,0 +1,26 @@
+/*
+ * Hlavičkový soubor pro paralelní průchod a rušení binárního vyhledávacího
+ * stromu.
+ */
+
+#ifndef IAL_BTREE_PARALLEL_H
+#define IAL_BTREE_PARALLEL_H
+
+#include "btree.h"
+
+// Počet podstromů, na které se strom rozdělí, připadající na jedno vlákno
+#define BST_PARALLEL_TASKS_PER_THREAD 4
+
+/*
+ * Výchozí nejmenší počet uzlů stromu, od kterého se práce rozdělí mezi
+ * vlákna. Menší stromy se zpracují sekvenčně, režie vytvoření vláken by
+ * převážila. Hodnotu lze změnit funkcí bst_set_parallel_cutoff.
+ */
+#define BST_PARALLEL_CUTOFF 4096
+
+int bst_parallel_cutoff();
+int bst_set_parallel_cutoff(int cutoff);
+void bst_dispose_parallel(bst_node_t **tree, int threads);
+void bst_inorder_parallel(bst_node_t *tree, bst_items_t *items, int threads);
+
+#endif
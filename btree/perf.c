@@ -0,0 +1,123 @@
+/*
+ * Měřené obaly operací binárního vyhledávacího stromu
+ *
+ * Každý obal zavolá původní operaci mezi perf_begin a perf_end a výsledek
+ * přičte do souhrnu své operace. Rekurzivní volání uvnitř implementace
+ * obaly neprocházejí, operace se tedy počítá jen jednou.
+ */
+
+#define BST_PERF_NO_REDIRECT
+
+#include "perf.h"
+#include "../common/perf.h"
+
+// Souhrny operací
+static perf_op_t bst_perf_ops[BST_PERF_OPS] = {
+    [BST_PERF_INIT] = PERF_OP("bst_init"),
+    [BST_PERF_INSERT] = PERF_OP("bst_insert"),
+    [BST_PERF_SEARCH] = PERF_OP("bst_search"),
+    [BST_PERF_DELETE] = PERF_OP("bst_delete"),
+    [BST_PERF_DISPOSE] = PERF_OP("bst_dispose"),
+    [BST_PERF_PREORDER] = PERF_OP("bst_preorder"),
+    [BST_PERF_INORDER] = PERF_OP("bst_inorder"),
+    [BST_PERF_POSTORDER] = PERF_OP("bst_postorder"),
+    [BST_PERF_LETTER_COUNT] = PERF_OP("letter_count")};
+
+void bst_perf_init(bst_node_t **tree)
+{
+  perf_sample_t sample;
+  perf_begin(&sample);
+  bst_init(tree);
+  perf_end(&bst_perf_ops[BST_PERF_INIT], &sample);
+}
+
+void bst_perf_insert(bst_node_t **tree, char key, bst_node_content_t value)
+{
+  perf_sample_t sample;
+  perf_begin(&sample);
+  bst_insert(tree, key, value);
+  perf_end(&bst_perf_ops[BST_PERF_INSERT], &sample);
+}
+
+bool bst_perf_search(bst_node_t *tree, char key, bst_node_content_t **value)
+{
+  perf_sample_t sample;
+  perf_begin(&sample);
+  bool result = bst_search(tree, key, value);
+  perf_end(&bst_perf_ops[BST_PERF_SEARCH], &sample);
+  return result;
+}
+
+void bst_perf_delete(bst_node_t **tree, char key)
+{
+  perf_sample_t sample;
+  perf_begin(&sample);
+  bst_delete(tree, key);
+  perf_end(&bst_perf_ops[BST_PERF_DELETE], &sample);
+}
+
+void bst_perf_dispose(bst_node_t **tree)
+{
+  perf_sample_t sample;
+  perf_begin(&sample);
+  bst_dispose(tree);
+  perf_end(&bst_perf_ops[BST_PERF_DISPOSE], &sample);
+}
+
+void bst_perf_preorder(bst_node_t *tree, bst_items_t *items)
+{
+  perf_sample_t sample;
+  perf_begin(&sample);
+  bst_preorder(tree, items);
+  perf_end(&bst_perf_ops[BST_PERF_PREORDER], &sample);
+}
+
+void bst_perf_inorder(bst_node_t *tree, bst_items_t *items)
+{
+  perf_sample_t sample;
+  perf_begin(&sample);
+  bst_inorder(tree, items);
+  perf_end(&bst_perf_ops[BST_PERF_INORDER], &sample);
+}
+
+void bst_perf_postorder(bst_node_t *tree, bst_items_t *items)
+{
+  perf_sample_t sample;
+  perf_begin(&sample);
+  bst_postorder(tree, items);
+  perf_end(&bst_perf_ops[BST_PERF_POSTORDER], &sample);
+}
+
+#ifdef EXA
+void bst_perf_letter_count(bst_node_t **tree, char *input)
+{
+  perf_sample_t sample;
+  perf_begin(&sample);
+  letter_count(tree, input);
+  perf_end(&bst_perf_ops[BST_PERF_LETTER_COUNT], &sample);
+}
+#endif // EXA
+
+/*
+ * Počet volání operace op od začátku nebo od posledního bst_perf_reset.
+ */
+uint64_t bst_perf_calls(bst_perf_op_t op)
+{
+  return atomic_load(&bst_perf_ops[op].calls);
+}
+
+/*
+ * Výpis souhrnů operací stromu ve formátu CSV.
+ */
+void bst_perf_report(FILE *stream)
+{
+  perf_report(stream, bst_perf_ops, BST_PERF_OPS);
+}
+
+/*
+ * Vynulování souhrnů operací stromu.
+ */
+void bst_perf_reset(void)
+{
+  perf_reset(bst_perf_ops, BST_PERF_OPS);
+}
@@ -0,0 +1,66 @@
+/*
+ * Hlavičkový soubor pro měření operací binárního vyhledávacího stromu.
+ *
+ * Při překladu s -DIAL_PERF přesměruje veřejné operace z btree.h na
+ * měřené obaly. Soubor se vkládá až za btree.h. Bez IAL_PERF zůstávají
+ * volání přímá a BST_PERF_REPORT se přeloží na prázdný příkaz.
+ */
+
+#ifndef IAL_BTREE_PERF_H
+#define IAL_BTREE_PERF_H
+
+#include "btree.h"
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef IAL_PERF
+
+// Měřené operace
+typedef enum bst_perf_op {
+  BST_PERF_INIT,
+  BST_PERF_INSERT,
+  BST_PERF_SEARCH,
+  BST_PERF_DELETE,
+  BST_PERF_DISPOSE,
+  BST_PERF_PREORDER,
+  BST_PERF_INORDER,
+  BST_PERF_POSTORDER,
+  BST_PERF_LETTER_COUNT,
+  BST_PERF_OPS
+} bst_perf_op_t;
+
+void bst_perf_init(bst_node_t **tree);
+void bst_perf_insert(bst_node_t **tree, char key, bst_node_content_t value);
+bool bst_perf_search(bst_node_t *tree, char key, bst_node_content_t **value);
+void bst_perf_delete(bst_node_t **tree, char key);
+void bst_perf_dispose(bst_node_t **tree);
+void bst_perf_preorder(bst_node_t *tree, bst_items_t *items);
+void bst_perf_inorder(bst_node_t *tree, bst_items_t *items);
+void bst_perf_postorder(bst_node_t *tree, bst_items_t *items);
+void bst_perf_letter_count(bst_node_t **tree, char *input);
+
+uint64_t bst_perf_calls(bst_perf_op_t op);
+void bst_perf_report(FILE *stream);
+void bst_perf_reset(void);
+
+#ifndef BST_PERF_NO_REDIRECT
+#define bst_init(tree) bst_perf_init(tree)
+#define bst_insert(tree, key, value) bst_perf_insert(tree, key, value)
+#define bst_search(tree, key, value) bst_perf_search(tree, key, value)
+#define bst_delete(tree, key) bst_perf_delete(tree, key)
+#define bst_dispose(tree) bst_perf_dispose(tree)
+#define bst_preorder(tree, items) bst_perf_preorder(tree, items)
+#define bst_inorder(tree, items) bst_perf_inorder(tree, items)
+#define bst_postorder(tree, items) bst_perf_postorder(tree, items)
+#define letter_count(tree, input) bst_perf_letter_count(tree, input)
+#endif
+
+#define BST_PERF_REPORT(stream) bst_perf_report(stream)
+
+#else
+
+#define BST_PERF_REPORT(stream) ((void)0)
+
+#endif // IAL_PERF
+
+#endif
@@ -0,0 +1,238 @@
+/*
+ * Perzistentní binární vyhledávací strom
+ *
+ * Vložení a odstranění nemění existující uzly. Zkopírují se jen uzly na cestě
+ * od kořene ke změněnému uzlu, nová verze stromu sdílí všechny ostatní
+ * podstromy s verzí původní. Každá verze tak stojí jen tolik paměti, kolik
+ * uzlů leží na cestě ke změně, a vlákno, které drží nějakou verzi, ji může
+ * číst bez zámků, zatímco jiná vlákna vytvářejí verze nové.
+ *
+ * Uzly i hodnoty mají počítadlo odkazů. Verze se uvolní funkcí
+ * bst_pers_release, uzly a hodnoty, které žádná jiná verze nepoužívá, se
+ * přitom uvolní také. Prázdný strom představuje hodnota NULL.
+ */
+
+#include "persistent.h"
+#include <stdlib.h>
+
+/*
+ * Pomocná funkce pro vytvoření uzlu.
+ *
+ * Uzel převezme odkazy na hodnotu i oba podstromy.
+ */
+static bst_pers_node_t *bst_pers_node_new(int key, bst_pers_value_t *value,
+                                          bst_pers_node_t *left,
+                                          bst_pers_node_t *right)
+{
+  bst_pers_node_t *node = malloc(sizeof(bst_pers_node_t));
+  if (node != NULL)
+  {
+    node->key = key;
+    node->value = value;
+    node->left = left;
+    node->right = right;
+    atomic_init(&node->refs, 1);
+  }
+  return node;
+}
+
+/*
+ * Pomocná funkce pro přidání odkazu na hodnotu.
+ */
+static bst_pers_value_t *bst_pers_value_retain(bst_pers_value_t *value)
+{
+  atomic_fetch_add(&value->refs, 1);
+  return value;
+}
+
+/*
+ * Pomocná funkce pro odebrání odkazu na hodnotu.
+ */
+static void bst_pers_value_release(bst_pers_value_t *value)
+{
+  if (atomic_fetch_sub(&value->refs, 1) == 1)
+  {
+    if (value->content.value != NULL)
+    {
+      free(value->content.value);
+    }
+    free(value);
+  }
+}
+
+/*
+ * Přidání odkazu na verzi stromu.
+ *
+ * Vrátí stejnou verzi, kterou je nutné později uvolnit funkcí
+ * bst_pers_release. Takto se pořizuje snímek stromu pro jiné vlákno.
+ */
+bst_pers_node_t *bst_pers_retain(bst_pers_node_t *tree)
+{
+  if (tree != NULL)
+  {
+    atomic_fetch_add(&tree->refs, 1);
+  }
+  return tree;
+}
+
+/*
+ * Uvolnění verze stromu.
+ *
+ * Odebere odkaz na verzi a uvolní všechny uzly a hodnoty, které už žádná
+ * verze nepoužívá. Proměnná tree se nastaví na NULL.
+ */
+void bst_pers_release(bst_pers_node_t **tree)
+{
+  bst_pers_node_t *node = *tree;
+
+  *tree = NULL;
+  if (node != NULL && atomic_fetch_sub(&node->refs, 1) == 1)
+  {
+    bst_pers_value_release(node->value);
+    bst_pers_release(&node->left);
+    bst_pers_release(&node->right);
+    free(node);
+  }
+}
+
+/*
+ * Vyhledání uzlu ve verzi stromu.
+ *
+ * V případě úspěchu vrátí funkce hodnotu true a do proměnné value zapíše
+ * ukazatel na obsah daného uzlu. V opačném případě funkce vrátí hodnotu false
+ * a proměnná value zůstává nezměněná.
+ *
+ * Obsah může být sdílený více verzemi, proto se nesmí měnit.
+ */
+bool bst_pers_search(bst_pers_node_t *tree, char key,
+                     bst_node_content_t **value)
+{
+  while (tree != NULL)
+  {
+    if (tree->key == key)
+    {
+      *value = &tree->value->content;
+      return true;
+    }
+    tree = key < tree->key ? tree->left : tree->right;
+  }
+  return false;
+}
+
+/*
+ * Pomocná funkce pro vložení, value je nová hodnota s jedním odkazem.
+ */
+static bst_pers_node_t *bst_pers_insert_value(bst_pers_node_t *tree, char key,
+                                              bst_pers_value_t *value)
+{
+  if (tree == NULL)
+  {
+    return bst_pers_node_new(key, value, NULL, NULL);
+  }
+  if (key < tree->key)
+  {
+    return bst_pers_node_new(tree->key, bst_pers_value_retain(tree->value),
+                             bst_pers_insert_value(tree->left, key, value),
+                             bst_pers_retain(tree->right));
+  }
+  if (key > tree->key)
+  {
+    return bst_pers_node_new(tree->key, bst_pers_value_retain(tree->value),
+                             bst_pers_retain(tree->left),
+                             bst_pers_insert_value(tree->right, key, value));
+  }
+  return bst_pers_node_new(key, value, bst_pers_retain(tree->left),
+                           bst_pers_retain(tree->right));
+}
+
+/*
+ * Vložení uzlu do stromu.
+ *
+ * Vrátí novou verzi stromu, ve které je pod klíčem key hodnota value.
+ * Původní verze zůstává beze změny a platná, dokud ji volající neuvolní.
+ * Strom přebírá vlastnictví hodnoty.
+ */
+bst_pers_node_t *bst_pers_insert(bst_pers_node_t *tree, char key,
+                                 bst_node_content_t value)
+{
+  bst_pers_value_t *shared = malloc(sizeof(bst_pers_value_t));
+  if (shared == NULL)
+  {
+    return bst_pers_retain(tree);
+  }
+  shared->content = value;
+  atomic_init(&shared->refs, 1);
+
+  return bst_pers_insert_value(tree, key, shared);
+}
+
+/*
+ * Pomocná funkce která vrátí kopii podstromu bez nejpravějšího uzlu.
+ *
+ * Do rightmost uloží odstraněný nejpravější uzel původního podstromu.
+ */
+static bst_pers_node_t *bst_pers_without_rightmost(bst_pers_node_t *tree,
+                                                   bst_pers_node_t **rightmost)
+{
+  if (tree->right == NULL)
+  {
+    *rightmost = tree;
+    return bst_pers_retain(tree->left);
+  }
+  bst_pers_node_t *right = bst_pers_without_rightmost(tree->right, rightmost);
+  return bst_pers_node_new(tree->key, bst_pers_value_retain(tree->value),
+                           bst_pers_retain(tree->left), right);
+}
+
+/*
+ * Pomocná funkce pro odstranění existujícího klíče.
+ */
+static bst_pers_node_t *bst_pers_delete_existing(bst_pers_node_t *tree,
+                                                 char key)
+{
+  if (key < tree->key)
+  {
+    return bst_pers_node_new(tree->key, bst_pers_value_retain(tree->value),
+                             bst_pers_delete_existing(tree->left, key),
+                             bst_pers_retain(tree->right));
+  }
+  if (key > tree->key)
+  {
+    return bst_pers_node_new(tree->key, bst_pers_value_retain(tree->value),
+                             bst_pers_retain(tree->left),
+                             bst_pers_delete_existing(tree->right, key));
+  }
+  if (tree->left == NULL)
+  {
+    return bst_pers_retain(tree->right);
+  }
+  if (tree->right == NULL)
+  {
+    return bst_pers_retain(tree->left);
+  }
+
+  bst_pers_node_t *rightmost;
+  bst_pers_node_t *left = bst_pers_without_rightmost(tree->left, &rightmost);
+  return bst_pers_node_new(rightmost->key,
+                           bst_pers_value_retain(rightmost->value), left,
+                           bst_pers_retain(tree->right));
+}
+
+/*
+ * Odstranění uzlu ze stromu.
+ *
+ * Vrátí novou verzi stromu bez klíče key. Pokud klíč ve stromu není, vrátí
+ * nový odkaz na stejnou verzi. Uzel se dvěma podstromy je v nové verzi
+ * nahrazený nejpravějším uzlem levého podstromu. Původní verze zůstává beze
+ * změny a platná, dokud ji volající neuvolní.
+ */
+bst_pers_node_t *bst_pers_delete(bst_pers_node_t *tree, char key)
+{
+  bst_node_content_t *value;
+
+  if (!bst_pers_search(tree, key, &value))
+  {
+    return bst_pers_retain(tree);
+  }
+  return bst_pers_delete_existing(tree, key);
+}
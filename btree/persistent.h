@@ -0,0 +1,35 @@
+/*
+ * Hlavičkový soubor pro perzistentní binární vyhledávací strom.
+ */
+
+#ifndef IAL_BTREE_PERSISTENT_H
+#define IAL_BTREE_PERSISTENT_H
+
+#include "btree.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+
+// Hodnota sdílená uzly více verzí stromu
+typedef struct bst_pers_value {
+  bst_node_content_t content; // hodnota
+  atomic_int refs;            // počet uzlů, které hodnotu používají
+} bst_pers_value_t;
+
+// Uzel stromu, kořen zároveň představuje jednu verzi stromu
+typedef struct bst_pers_node {
+  int key;                     // klíč
+  bst_pers_value_t *value;     // hodnota
+  struct bst_pers_node *left;  // levý potomek
+  struct bst_pers_node *right; // pravý potomek
+  atomic_int refs;             // počet rodičů a držitelů verze
+} bst_pers_node_t;
+
+bst_pers_node_t *bst_pers_insert(bst_pers_node_t *tree, char key,
+                                 bst_node_content_t value);
+bst_pers_node_t *bst_pers_delete(bst_pers_node_t *tree, char key);
+bool bst_pers_search(bst_pers_node_t *tree, char key,
+                     bst_node_content_t **value);
+bst_pers_node_t *bst_pers_retain(bst_pers_node_t *tree);
+void bst_pers_release(bst_pers_node_t **tree);
+
+#endif
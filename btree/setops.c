@@ -0,0 +1,355 @@
+/*
+ * Množinové operace nad binárními vyhledávacími stromy
+ *
+ * Stromy jsou treapy nad uzly z btree.h: uzel s vyšší prioritou je vždy nad
+ * uzly s nižší prioritou. Priorita se nikde neukládá, je to promíchaný klíč
+ * (bst_priority), takže různé klíče mají různé priority a tvar stromu závisí
+ * jen na množině klíčů. Takový strom má očekávanou výšku O(log n).
+ *
+ * Základem jsou dvě operace: bst_split rozdělí strom podle klíče na menší
+ * a větší klíče a bst_join spojí dva stromy, jejichž klíče na sebe navazují.
+ * Sjednocení, průnik a rozdíl stromů s m <= n uzly pomocí nich rozdělí jeden
+ * strom podle kořene druhého a rekurzivně zpracují levé a pravé poloviny,
+ * celkem v očekávaném čase O(m log(n/m + 1)). Obě poloviny jsou nezávislé,
+ * horní patra rekurze se proto rozdělí mezi vlákna (fork-join).
+ *
+ * Operace přebírají uzly obou stromů: uzly výsledku se znovu použijí, ostatní
+ * se uvolní. Stromy proto nesmí být sestavené souvisle
+ * (bst_build_from_sorted s contiguous). Pro stromy, které nejsou treapy
+ * (např. z bst_insert), dávají operace správný výsledek, jen bez záruky
+ * složitosti.
+ */
+
+#include "setops.h"
+#include "parallel.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+// Množinová operace
+typedef enum bst_set_op {
+  BST_SET_UNION,
+  BST_SET_INTERSECT,
+  BST_SET_DIFFERENCE
+} bst_set_op_t;
+
+// Operace nad dvojicí podstromů, případně prováděná jiným vláknem
+typedef struct bst_set_task {
+  bst_set_op_t op;    // operace
+  bst_merge_t merge;  // sloučení hodnot, nebo NULL
+  bst_node_t *tree;   // podstrom prvního stromu
+  bst_node_t *other;  // podstrom druhého stromu
+  int threads;        // počet vláken pro tuto část
+  bst_node_t *result; // výsledný podstrom
+} bst_set_task_t;
+
+/*
+ * Priorita uzlu s klíčem key (promíchání bitů z MurmurHash3). Funkce je
+ * prostá, různé klíče mají různé priority.
+ */
+static unsigned bst_priority(int key)
+{
+  unsigned x = (unsigned)key;
+  x ^= x >> 16;
+  x *= 0x85ebca6bu;
+  x ^= x >> 13;
+  x *= 0xc2b2ae35u;
+  x ^= x >> 16;
+  return x;
+}
+
+/*
+ * Pomocná funkce pro uvolnění jednoho uzlu i s hodnotou.
+ */
+static void bst_free_node(bst_node_t *node)
+{
+  if (node->content.value != NULL)
+  {
+    free(node->content.value);
+  }
+  free(node);
+}
+
+/*
+ * Sečtení hodnot typu INTEGER, např. počtů výskytů z letter_count. Hodnoty
+ * jiného typu se nemění.
+ */
+void bst_merge_sum(bst_node_content_t *into, bst_node_content_t *from)
+{
+  if (into->type == INTEGER && from->type == INTEGER && into->value != NULL &&
+      from->value != NULL)
+  {
+    *(int *)into->value += *(int *)from->value;
+  }
+}
+
+/*
+ * Rozdělení stromu podle klíče.
+ *
+ * Do left uloží strom s menšími a do right strom s většími klíči. Uzel se
+ * zadaným klíčem vrátí (bez potomků), pokud ve stromu není, vrátí NULL.
+ * Strom tree přestane existovat, jeho uzly převezmou výsledné stromy.
+ */
+bst_node_t *bst_split(bst_node_t *tree, char key, bst_node_t **left,
+                      bst_node_t **right)
+{
+  while (tree != NULL)
+  {
+    if (tree->key < key)
+    {
+      *left = tree;
+      left = &tree->right;
+      tree = tree->right;
+    }
+    else if (tree->key > key)
+    {
+      *right = tree;
+      right = &tree->left;
+      tree = tree->left;
+    }
+    else
+    {
+      *left = tree->left;
+      *right = tree->right;
+      tree->left = NULL;
+      tree->right = NULL;
+      return tree;
+    }
+  }
+  *left = NULL;
+  *right = NULL;
+  return NULL;
+}
+
+/*
+ * Spojení dvou stromů, všechny klíče stromu left musí být menší než klíče
+ * stromu right. Vrací kořen výsledného stromu.
+ */
+bst_node_t *bst_join(bst_node_t *left, bst_node_t *right)
+{
+  bst_node_t *root;
+  bst_node_t **link = &root;
+
+  while (left != NULL && right != NULL)
+  {
+    if (bst_priority(left->key) > bst_priority(right->key))
+    {
+      *link = left;
+      link = &left->right;
+      left = left->right;
+    }
+    else
+    {
+      *link = right;
+      link = &right->left;
+      right = right->left;
+    }
+  }
+  *link = left != NULL ? left : right;
+  return root;
+}
+
+/*
+ * Vložení uzlu do treapu. Pokud uzel se zadaným klíčem už ve stromu
+ * existuje, nahradí se jeho hodnota.
+ */
+void bst_treap_insert(bst_node_t **tree, char key, bst_node_content_t value)
+{
+  bst_node_t *left;
+  bst_node_t *right;
+  bst_node_t *node = bst_split(*tree, key, &left, &right);
+
+  if (node != NULL)
+  {
+    if (node->content.value != NULL)
+    {
+      free(node->content.value);
+    }
+  }
+  else
+  {
+    node = malloc(sizeof(bst_node_t));
+    if (node == NULL)
+    {
+      *tree = bst_join(left, right);
+      return;
+    }
+    node->key = key;
+    node->left = NULL;
+    node->right = NULL;
+  }
+  node->content = value;
+  *tree = bst_join(bst_join(left, node), right);
+}
+
+static bst_node_t *bst_set(bst_set_task_t *task);
+
+static void *bst_set_thread(void *arg)
+{
+  bst_set_task_t *task = arg;
+  task->result = bst_set(task);
+  return NULL;
+}
+
+/*
+ * Pomocná funkce pro zpracování levých a pravých polovin. Má-li operace
+ * k dispozici více vláken, levou polovinu zpracuje nové vlákno a vlákna se
+ * rozdělí mezi obě poloviny.
+ */
+static void bst_set_halves(bst_set_task_t *left, bst_set_task_t *right,
+                           int threads)
+{
+  pthread_t thread;
+
+  left->threads = threads / 2;
+  right->threads = threads - left->threads;
+  if (left->threads > 0 &&
+      pthread_create(&thread, NULL, bst_set_thread, left) == 0)
+  {
+    bst_set_thread(right);
+    pthread_join(thread, NULL);
+    return;
+  }
+  left->threads = 1;
+  right->threads = 1;
+  bst_set_thread(left);
+  bst_set_thread(right);
+}
+
+/*
+ * Rekurzivní provedení operace nad podstromy task->tree a task->other.
+ */
+static bst_node_t *bst_set(bst_set_task_t *task)
+{
+  bst_node_t *tree = task->tree;
+  bst_node_t *other = task->other;
+
+  if (tree == NULL || other == NULL)
+  {
+    if (task->op == BST_SET_UNION)
+    {
+      return tree != NULL ? tree : other;
+    }
+    bst_dispose(&other);
+    if (task->op == BST_SET_INTERSECT)
+    {
+      bst_dispose(&tree);
+    }
+    return tree;
+  }
+
+  // Sjednocení dělí podle kořene s vyšší prioritou, aby výsledek byl treap
+  bool swapped = task->op == BST_SET_UNION &&
+                 bst_priority(other->key) > bst_priority(tree->key);
+  bst_node_t *root = swapped ? other : tree;
+  bst_node_t *split_left;
+  bst_node_t *split_right;
+  bst_node_t *match =
+      bst_split(swapped ? tree : other, root->key, &split_left, &split_right);
+
+  // Podúlohy zachovávají pořadí stromů kvůli slučování hodnot
+  bst_set_task_t left = *task;
+  bst_set_task_t right = *task;
+  left.tree = swapped ? split_left : root->left;
+  left.other = swapped ? root->left : split_left;
+  right.tree = swapped ? split_right : root->right;
+  right.other = swapped ? root->right : split_right;
+  bst_set_halves(&left, &right, task->threads);
+
+  if (match != NULL && task->op != BST_SET_DIFFERENCE)
+  {
+    // Klíč je v obou stromech, ve výsledku zůstane kořen
+    bst_node_content_t *first = swapped ? &match->content : &root->content;
+    bst_node_content_t *second = swapped ? &root->content : &match->content;
+    if (task->merge != NULL)
+    {
+      task->merge(first, second);
+    }
+    if (swapped)
+    {
+      bst_node_content_t content = root->content;
+      root->content = match->content;
+      match->content = content;
+    }
+    bst_free_node(match);
+  }
+  else if (match != NULL || task->op == BST_SET_INTERSECT)
+  {
+    // Klíč ve výsledku není
+    if (match != NULL)
+    {
+      bst_free_node(match);
+    }
+    bst_free_node(root);
+    return bst_join(left.result, right.result);
+  }
+
+  root->left = left.result;
+  root->right = right.result;
+  return root;
+}
+
+/*
+ * Pomocná funkce která spočítá uzly stromu, nejvýše však limit uzlů.
+ */
+static int bst_set_count(bst_node_t *tree, int limit)
+{
+  if (tree == NULL || limit <= 0)
+  {
+    return 0;
+  }
+  int count = 1 + bst_set_count(tree->left, limit - 1);
+  return count + bst_set_count(tree->right, limit - count);
+}
+
+/*
+ * Pomocná funkce pro spuštění operace nad celými stromy. Stromy s méně než
+ * bst_parallel_cutoff() uzly dohromady se zpracují jedním vláknem.
+ */
+static void bst_set_run(bst_set_op_t op, bst_node_t **tree,
+                        bst_node_t **other, bst_merge_t merge, int threads)
+{
+  bst_set_task_t task = {op, merge, *tree, *other, threads, NULL};
+
+  int cutoff = bst_parallel_cutoff();
+  if (threads <= 1 || bst_set_count(*tree, cutoff) +
+                              bst_set_count(*other, cutoff) <
+                          cutoff)
+  {
+    task.threads = 1;
+  }
+  *tree = bst_set(&task);
+  *other = NULL;
+}
+
+/*
+ * Sjednocení stromů, výsledek se uloží do tree a other bude prázdný.
+ *
+ * Pro klíč v obou stromech se hodnoty sloučí funkcí merge; pokud je merge
+ * NULL, zůstane hodnota z tree. Operaci provádí nejvýše threads vláken.
+ */
+void bst_union(bst_node_t **tree, bst_node_t **other, bst_merge_t merge,
+               int threads)
+{
+  bst_set_run(BST_SET_UNION, tree, other, merge, threads);
+}
+
+/*
+ * Průnik stromů, výsledek se uloží do tree a other bude prázdný.
+ *
+ * Hodnoty se slučují stejně jako v bst_union.
+ */
+void bst_intersect(bst_node_t **tree, bst_node_t **other, bst_merge_t merge,
+                   int threads)
+{
+  bst_set_run(BST_SET_INTERSECT, tree, other, merge, threads);
+}
+
+/*
+ * Rozdíl stromů — z tree se odstraní klíče, které jsou v other. Strom other
+ * bude prázdný.
+ */
+void bst_difference(bst_node_t **tree, bst_node_t **other, int threads)
+{
+  bst_set_run(BST_SET_DIFFERENCE, tree, other, NULL, threads);
+}
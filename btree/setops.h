@@ -0,0 +1,32 @@
+/*
+ * Hlavičkový soubor pro množinové operace nad binárními vyhledávacími
+ * stromy založené na rozdělení a spojení stromů.
+ */
+
+#ifndef IAL_BTREE_SETOPS_H
+#define IAL_BTREE_SETOPS_H
+
+#include "btree.h"
+
+/*
+ * Sloučení hodnot klíče, který je v obou stromech. into je hodnota z prvního
+ * stromu a zůstane ve výsledku, from je hodnota z druhého stromu a po návratu
+ * se uvolní.
+ */
+typedef void (*bst_merge_t)(bst_node_content_t *into,
+                            bst_node_content_t *from);
+
+void bst_merge_sum(bst_node_content_t *into, bst_node_content_t *from);
+
+bst_node_t *bst_split(bst_node_t *tree, char key, bst_node_t **left,
+                      bst_node_t **right);
+bst_node_t *bst_join(bst_node_t *left, bst_node_t *right);
+void bst_treap_insert(bst_node_t **tree, char key, bst_node_content_t value);
+
+void bst_union(bst_node_t **tree, bst_node_t **other, bst_merge_t merge,
+               int threads);
+void bst_intersect(bst_node_t **tree, bst_node_t **other, bst_merge_t merge,
+                   int threads);
+void bst_difference(bst_node_t **tree, bst_node_t **other, int threads);
+
+#endif
@@ -0,0 +1,238 @@
+/*
+ * Samoupravující se (splay) binární vyhledávací strom
+ *
+ * Strom používá uzly z btree.h a inicializuje se funkcí bst_init. Vyhledání,
+ * vložení a odstranění každý nalezený nebo nově vložený uzel přesunou do
+ * kořene. Často hledané klíče tak zůstávají u kořene a při nerovnoměrném
+ * (např. Zipfově) rozdělení přístupů se vyhledání zkrátí na několik kroků.
+ * Amortizovaná složitost operace je O(log n).
+ *
+ * Přesun do kořene je shora dolů (top-down splay) a iterativní: při sestupu
+ * od kořene se uzly menší než klíč připojují do levého a větší do pravého
+ * pomocného stromu, ty se nakonec stanou podstromy nového kořene. Strom se
+ * tedy prochází jen jednou a bez zásobníku.
+ *
+ * Protože vyhledání strom mění, nesmí se strom současně číst z více vláken.
+ *
+ * Hloubka stromu není omezená, proto se strom ruší funkcí bst_splay_dispose.
+ * Funkce bst_dispose a průchody z btree.h v iterativní variantě používají
+ * zásobník pevné velikosti a hluboký splay strom nezpracují.
+ */
+
+#include "splay.h"
+#include <stdlib.h>
+
+/*
+ * Pomocná funkce pro přesun uzlu s klíčem key do kořene stromu tree.
+ *
+ * Pokud uzel s klíčem neexistuje, přesune se do kořene poslední uzel na
+ * cestě k němu (nejbližší menší nebo větší klíč). Vrací nový kořen.
+ */
+static bst_node_t *bst_splay(bst_node_t *tree, char key)
+{
+  bst_node_t header;
+  bst_node_t *left = &header;  // největší uzel levého pomocného stromu
+  bst_node_t *right = &header; // nejmenší uzel pravého pomocného stromu
+
+  if (tree == NULL)
+  {
+    return NULL;
+  }
+
+  header.left = NULL;
+  header.right = NULL;
+  while (key != tree->key)
+  {
+    if (key < tree->key)
+    {
+      if (tree->left == NULL)
+      {
+        break;
+      }
+      if (key < tree->left->key)
+      {
+        // Rotace doprava
+        bst_node_t *child = tree->left;
+        tree->left = child->right;
+        child->right = tree;
+        tree = child;
+        if (tree->left == NULL)
+        {
+          break;
+        }
+      }
+      // Připojení do pravého pomocného stromu
+      right->left = tree;
+      right = tree;
+      tree = tree->left;
+    }
+    else
+    {
+      if (tree->right == NULL)
+      {
+        break;
+      }
+      if (key > tree->right->key)
+      {
+        // Rotace doleva
+        bst_node_t *child = tree->right;
+        tree->right = child->left;
+        child->left = tree;
+        tree = child;
+        if (tree->right == NULL)
+        {
+          break;
+        }
+      }
+      // Připojení do levého pomocného stromu
+      left->right = tree;
+      left = tree;
+      tree = tree->right;
+    }
+  }
+
+  left->right = tree->left;
+  right->left = tree->right;
+  tree->left = header.right;
+  tree->right = header.left;
+  return tree;
+}
+
+/*
+ * Vyhledání uzlu ve stromu.
+ *
+ * V případě úspěchu vrátí funkce hodnotu true a do proměnné value zapíše
+ * ukazatel na obsah uzlu, který je po návratu kořenem. Jinak vrátí false
+ * a do kořene se přesune poslední uzel na cestě ke klíči.
+ */
+bool bst_splay_search(bst_node_t **tree, char key,
+                      bst_node_content_t **value)
+{
+  *tree = bst_splay(*tree, key);
+  if (*tree == NULL || (*tree)->key != key)
+  {
+    return false;
+  }
+  *value = &(*tree)->content;
+  return true;
+}
+
+/*
+ * Vložení uzlu do stromu, nový nebo nalezený uzel bude kořenem.
+ *
+ * Pokud uzel se zadaným klíčem už ve stromu existuje, nahradí se jeho
+ * hodnota.
+ */
+void bst_splay_insert(bst_node_t **tree, char key, bst_node_content_t value)
+{
+  bst_node_t *root = bst_splay(*tree, key);
+
+  if (root != NULL && root->key == key)
+  {
+    if (root->content.value != NULL)
+    {
+      free(root->content.value);
+    }
+    root->content = value;
+    *tree = root;
+    return;
+  }
+
+  bst_node_t *node = malloc(sizeof(bst_node_t));
+  if (node == NULL)
+  {
+    *tree = root;
+    return;
+  }
+  node->key = key;
+  node->content = value;
+  if (root == NULL)
+  {
+    node->left = NULL;
+    node->right = NULL;
+  }
+  else if (key < root->key)
+  {
+    node->left = root->left;
+    node->right = root;
+    root->left = NULL;
+  }
+  else
+  {
+    node->right = root->right;
+    node->left = root;
+    root->right = NULL;
+  }
+  *tree = node;
+}
+
+/*
+ * Odstranění uzlu ze stromu.
+ *
+ * Pokud uzel se zadaným klíčem neexistuje, strom se jen přeskupí. Jinak se
+ * odstraněný uzel nahradí největším uzlem levého podstromu, který se do
+ * kořene podstromu přesune stejně jako při vyhledání. Funkce korektně
+ * uvolní všechny alokované zdroje odstraněného uzlu.
+ */
+void bst_splay_delete(bst_node_t **tree, char key)
+{
+  bst_node_t *root = bst_splay(*tree, key);
+
+  if (root == NULL || root->key != key)
+  {
+    *tree = root;
+    return;
+  }
+
+  if (root->left == NULL)
+  {
+    *tree = root->right;
+  }
+  else
+  {
+    // Všechny klíče levého podstromu jsou menší, kořenem bude největší
+    *tree = bst_splay(root->left, key);
+    (*tree)->right = root->right;
+  }
+  if (root->content.value != NULL)
+  {
+    free(root->content.value);
+  }
+  free(root);
+}
+
+/*
+ * Zrušení celého stromu.
+ *
+ * Splay strom může být mnohem hlubší než log n (např. po vložení seřazených
+ * klíčů je to seznam), iterativní bst_dispose s pevně velkým zásobníkem by
+ * ho neuvolnil celý. Funkce proto zásobník nepoužívá: rotacemi doprava
+ * postupně vyprázdní levý podstrom kořene a kořen bez levého podstromu
+ * uvolní. Po zrušení je strom ve stavu po inicializaci.
+ */
+void bst_splay_dispose(bst_node_t **tree)
+{
+  bst_node_t *node = *tree;
+
+  while (node != NULL)
+  {
+    if (node->left != NULL)
+    {
+      bst_node_t *left = node->left;
+      node->left = left->right;
+      left->right = node;
+      node = left;
+    }
+    else
+    {
+      bst_node_t *right = node->right;
+      if (node->content.value != NULL)
+      {
+        free(node->content.value);
+      }
+      free(node);
+      node = right;
+    }
+  }
+  *tree = NULL;
+}
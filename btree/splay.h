@@ -0,0 +1,17 @@
+/*
+ * Hlavičkový soubor pro samoupravující se (splay) binární vyhledávací strom.
+ */
+
+#ifndef IAL_BTREE_SPLAY_H
+#define IAL_BTREE_SPLAY_H
+
+#include "btree.h"
+#include <stdbool.h>
+
+bool bst_splay_search(bst_node_t **tree, char key,
+                      bst_node_content_t **value);
+void bst_splay_insert(bst_node_t **tree, char key, bst_node_content_t value);
+void bst_splay_delete(bst_node_t **tree, char key);
+void bst_splay_dispose(bst_node_t **tree);
+
+#endif
@@ -1,7 +1,29 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "btree.h"
+#include "bulk.h"
+#include "character_index.h"
+#include "character_store.h"
+#include "concurrent.h"
+#include "dump.h"
+#include "image.h"
+#include "lazy.h"
+#include "parallel.h"
+#include "perf.h"
+#include "persistent.h"
+#include "setops.h"
+#include "splay.h"
 #include "test_util.h"
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <unistd.h>
+
+#ifdef EXA
+#include "exa/exa.h"
+#include <limits.h>
+#include <string.h>
+#endif // EXA
 
 const int base_data_count = 15;
 const char base_keys[] = {'H', 'D', 'L', 'B', 'F', 'J', 'N', 'A',
@@ -16,6 +38,10 @@ const int traversal_data_count = 5;
 const char traversal_keys[] = {'D', 'B', 'A', 'C', 'E'};
 const int traversal_values[] = {1, 2, 3, 4, 5};
 
+const int sorted_data_count = 7;
+const char sorted_keys[] = {'A', 'B', 'C', 'D', 'E', 'F', 'G'};
+const int sorted_values[] = {1, 2, 3, 4, 5, 6, 7};
+
 void init_test() {
   printf("Binary Search Tree - testing script\n");
   printf("-----------------------------------\n");
@@ -174,6 +200,476 @@ bst_print_tree(test_tree);
 bst_print_items(test_items);
 ENDTEST
 
+TEST(test_tree_build_sorted, "Build a balanced tree from sorted keys")
+bst_node_content_t contents[sorted_data_count];
+for (int i = 0; i < sorted_data_count; i++) {
+  contents[i] = create_integer_content(sorted_values[i]);
+}
+bst_build_from_sorted(&test_tree, sorted_keys, contents, sorted_data_count,
+                      false);
+bst_print_tree(test_tree);
+ENDTEST
+
+TEST(test_tree_build_unsorted,
+     "Build a contiguous balanced tree from unsorted keys")
+bst_node_content_t contents[base_data_count];
+for (int i = 0; i < base_data_count; i++) {
+  contents[i] = create_integer_content(base_values[i]);
+}
+bst_build_from_unsorted(&test_tree, base_keys, contents, base_data_count,
+                        true);
+bst_print_tree(test_tree);
+bst_dispose_contiguous(&test_tree);
+ENDTEST
+
+TEST(test_tree_inorder_parallel, "Traverse the tree using parallel inorder")
+bst_init(&test_tree);
+bst_insert_many(&test_tree, base_keys, base_values, base_data_count);
+int cutoff = bst_set_parallel_cutoff(0);
+bst_inorder_parallel(test_tree, test_items, 2);
+bst_set_parallel_cutoff(cutoff);
+bst_print_items(test_items);
+ENDTEST
+
+TEST(test_tree_dispose_parallel, "Dispose the whole tree in parallel")
+bst_init(&test_tree);
+bst_insert_many(&test_tree, base_keys, base_values, base_data_count);
+bst_insert_many(&test_tree, additional_keys, additional_values,
+                additional_data_count);
+int cutoff = bst_set_parallel_cutoff(0);
+bst_dispose_parallel(&test_tree, 2);
+bst_set_parallel_cutoff(cutoff);
+bst_print_tree(test_tree);
+ENDTEST
+
+TEST(test_conc_tree, "Insert, update, delete and search in a concurrent tree")
+bst_init(&test_tree);
+bst_conc_t conc_tree;
+bst_conc_init(&conc_tree);
+for (int i = 0; i < base_data_count; i++) {
+  bst_conc_insert(&conc_tree, base_keys[i],
+                  create_integer_content(base_values[i]));
+}
+bst_conc_insert(&conc_tree, 'C', create_integer_content(33));
+bst_conc_delete(&conc_tree, 'H');
+bst_conc_delete(&conc_tree, 'D');
+bst_conc_delete(&conc_tree, 'A');
+const char conc_keys[] = {'A', 'C', 'D', 'G', 'H', 'O'};
+for (int i = 0; i < 6; i++) {
+  bst_node_content_t content;
+  printf("%c: ", conc_keys[i]);
+  if (bst_conc_search(&conc_tree, conc_keys[i], &content)) {
+    bst_print_node_content(&content);
+  } else {
+    bst_print_node_content(NULL);
+  }
+  printf("\n");
+}
+bst_conc_dispose(&conc_tree);
+ENDTEST
+
+void *conc_tree_worker(void *arg) {
+  bst_conc_t *conc_tree = arg;
+  static atomic_int next_worker;
+  int first = 'A' + 10 * atomic_fetch_add(&next_worker, 1);
+  for (int key = first; key < first + 10; key++) {
+    bst_conc_insert(conc_tree, key, create_integer_content(key));
+  }
+  for (int key = first; key < first + 10; key += 2) {
+    bst_conc_delete(conc_tree, key);
+  }
+  bst_conc_thread_exit();
+  return NULL;
+}
+
+TEST(test_conc_tree_threads, "Insert and delete from several threads")
+bst_init(&test_tree);
+bst_conc_t conc_tree;
+bst_conc_init(&conc_tree);
+pthread_t workers[4];
+for (int i = 0; i < 4; i++) {
+  pthread_create(&workers[i], NULL, conc_tree_worker, &conc_tree);
+}
+for (int i = 0; i < 4; i++) {
+  pthread_join(workers[i], NULL);
+}
+int found = 0;
+for (int key = 'A'; key < 'A' + 40; key++) {
+  bst_node_content_t content;
+  found += bst_conc_search(&conc_tree, key, &content);
+}
+printf("Found items: %d\n", found);
+bst_conc_dispose(&conc_tree);
+ENDTEST
+
+typedef struct conc_race {
+  bst_conc_t tree;
+  pthread_barrier_t barrier;
+  int rounds;
+} conc_race_t;
+
+int conc_count_key(bst_conc_node_t *node, char key) {
+  if (node == NULL) {
+    return 0;
+  }
+  return (node->key == key) + conc_count_key(atomic_load(&node->left), key) +
+         conc_count_key(atomic_load(&node->right), key);
+}
+
+void *conc_race_deleter(void *arg) {
+  conc_race_t *race = arg;
+  for (int i = 0; i < race->rounds; i++) {
+    pthread_barrier_wait(&race->barrier);
+    bst_conc_delete(&race->tree, 'D');
+    pthread_barrier_wait(&race->barrier);
+  }
+  bst_conc_thread_exit();
+  return NULL;
+}
+
+void *conc_race_inserter(void *arg) {
+  conc_race_t *race = arg;
+  for (int i = 0; i < race->rounds; i++) {
+    pthread_barrier_wait(&race->barrier);
+    bst_conc_insert(&race->tree, 'C', create_integer_content(i));
+    pthread_barrier_wait(&race->barrier);
+  }
+  bst_conc_thread_exit();
+  return NULL;
+}
+
+TEST(test_conc_tree_move_race, "Update a key while its node moves up")
+bst_init(&test_tree);
+conc_race_t race;
+race.rounds = 1000;
+bst_conc_init(&race.tree);
+pthread_barrier_init(&race.barrier, NULL, 3);
+pthread_t workers[2];
+pthread_create(&workers[0], NULL, conc_race_deleter, &race);
+pthread_create(&workers[1], NULL, conc_race_inserter, &race);
+int duplicates = 0;
+for (int i = 0; i < race.rounds; i++) {
+  // Odstranění D přesune C (nejpravější uzel levého podstromu) na jeho místo
+  const char keys[] = {'D', 'B', 'F', 'C'};
+  for (int j = 0; j < 4; j++) {
+    bst_conc_insert(&race.tree, keys[j], create_integer_content(keys[j]));
+  }
+  pthread_barrier_wait(&race.barrier);
+  pthread_barrier_wait(&race.barrier);
+  duplicates += conc_count_key(atomic_load(&race.tree.root.left), 'C') != 1;
+  bst_conc_dispose(&race.tree);
+}
+for (int i = 0; i < 2; i++) {
+  pthread_join(workers[i], NULL);
+}
+printf("Rounds with duplicate keys: %d\n", duplicates);
+pthread_barrier_destroy(&race.barrier);
+ENDTEST
+
+void print_persistent_search(bst_pers_node_t *version, char key) {
+  bst_node_content_t *content = NULL;
+  printf("%c: ", key);
+  bst_pers_search(version, key, &content);
+  bst_print_node_content(content);
+  printf("\n");
+}
+
+TEST(test_pers_tree, "Keep a snapshot while the persistent tree changes")
+bst_init(&test_tree);
+bst_pers_node_t *version = NULL;
+for (int i = 0; i < base_data_count; i++) {
+  bst_pers_node_t *next = bst_pers_insert(
+      version, base_keys[i], create_integer_content(base_values[i]));
+  bst_pers_release(&version);
+  version = next;
+}
+bst_pers_node_t *snapshot = bst_pers_retain(version);
+bst_pers_node_t *next = bst_pers_insert(version, 'C', create_integer_content(33));
+bst_pers_release(&version);
+version = bst_pers_delete(next, 'H');
+bst_pers_release(&next);
+printf("Snapshot:\n");
+print_persistent_search(snapshot, 'C');
+print_persistent_search(snapshot, 'H');
+printf("Current version:\n");
+print_persistent_search(version, 'C');
+print_persistent_search(version, 'H');
+bst_pers_release(&snapshot);
+bst_pers_release(&version);
+ENDTEST
+
+TEST(test_splay_tree, "Move searched keys to the root of a splay tree")
+bst_init(&test_tree);
+for (int i = 0; i < base_data_count; i++) {
+  bst_splay_insert(&test_tree, base_keys[i],
+                   create_integer_content(base_values[i]));
+}
+bst_node_content_t *result = NULL;
+bst_splay_search(&test_tree, 'A', &result);
+bst_print_search_result(result);
+bst_splay_search(&test_tree, 'F', &result);
+bst_print_search_result(result);
+bst_print_tree(test_tree);
+bool present = bst_splay_search(&test_tree, 'P', &result);
+printf("Missing P found: %s, root: %c\n", present ? "yes" : "no",
+       test_tree->key);
+bst_splay_insert(&test_tree, 'F', create_integer_content(66));
+bst_splay_delete(&test_tree, 'H');
+bst_splay_delete(&test_tree, 'Z');
+bst_print_tree(test_tree);
+bst_splay_dispose(&test_tree);
+ENDTEST
+
+void insert_treap_many(bst_node_t **tree, const char keys[],
+                       const int values[], int count) {
+  for (int i = 0; i < count; i++) {
+    bst_treap_insert(tree, keys[i], create_integer_content(values[i]));
+  }
+}
+
+TEST(test_tree_set_operations, "Union, intersect and subtract treaps")
+bst_init(&test_tree);
+bst_node_t *other = NULL;
+insert_treap_many(&test_tree, traversal_keys, traversal_values,
+                  traversal_data_count);
+insert_treap_many(&other, sorted_keys, sorted_values, sorted_data_count);
+int cutoff = bst_set_parallel_cutoff(0);
+bst_union(&test_tree, &other, bst_merge_sum, 2);
+bst_set_parallel_cutoff(cutoff);
+printf("Union with summed values:\n");
+bst_print_tree(test_tree);
+insert_treap_many(&other, base_keys, base_values, 4);
+bst_intersect(&test_tree, &other, NULL, 1);
+printf("Intersection with H, D, L, B:\n");
+bst_print_tree(test_tree);
+insert_treap_many(&other, sorted_keys, sorted_values, 3);
+bst_difference(&test_tree, &other, 1);
+printf("Difference with A, B, C:\n");
+bst_print_tree(test_tree);
+bst_node_t *left, *right;
+insert_treap_many(&test_tree, sorted_keys, sorted_values, sorted_data_count);
+bst_node_t *middle = bst_split(test_tree, 'D', &left, &right);
+printf("Split at D: ");
+bst_print_node(middle);
+printf("\n");
+bst_print_tree(left);
+bst_print_tree(right);
+test_tree = bst_join(bst_join(left, middle), right);
+ENDTEST
+
+TEST(test_lazy_tree, "Delete with tombstones and compact the tree")
+bst_init(&test_tree);
+bst_lazy_t lazy;
+bst_lazy_init(&lazy);
+for (int i = 0; i < base_data_count; i++) {
+  bst_lazy_insert(&lazy, base_keys[i], create_integer_content(base_values[i]));
+}
+bst_lazy_delete(&lazy, 'H');
+bst_lazy_delete(&lazy, 'B');
+bst_lazy_delete(&lazy, 'Z');
+bst_node_content_t *result = NULL;
+printf("H found: %s\n", bst_lazy_search(&lazy, 'H', &result) ? "yes" : "no");
+printf("Size: %d, dead: %d, root: %c\n", lazy.size, lazy.dead,
+       lazy.root->key);
+bst_lazy_insert(&lazy, 'B', create_integer_content(22));
+bst_lazy_inorder(&lazy, test_items);
+bst_print_items(test_items);
+for (int i = 7; i < base_data_count; i++) {
+  bst_lazy_delete(&lazy, base_keys[i]);
+}
+printf("Size: %d, dead: %d\n", lazy.size, lazy.dead);
+bst_print_tree(lazy.root);
+bst_lazy_dispose(&lazy);
+ENDTEST
+
+TEST(test_character_store, "Filter Wizards from level 10 in a character store")
+bst_init(&test_tree);
+character_store_t store;
+character_store_init(&store);
+const char *names[] = {"Elminster", "Mordenkainen", "Elminster", "Tasha",
+                       "Drizzt", "Raistlin"};
+const character_class_t classes[] = {Wizard, Wizard, Cleric,
+                                     Wizard, Fighter, Wizard};
+const unsigned char levels[] = {20, 15, 3, 9, 12, 10};
+for (int i = 0; i < 6; i++) {
+  int id = character_store_add(&store, names[i], classes[i], levels[i]);
+  bst_insert(&test_tree, 'A' + i, character_store_ref(id));
+}
+int interned = 0;
+for (int i = 0; i < store.size; i++) {
+  bool first = true;
+  for (int j = 0; j < i; j++) {
+    first &= store.names[j] != store.names[i];
+  }
+  interned += first;
+}
+printf("Interned names: %d\n", interned);
+int found[6];
+int count = character_store_filter(&store, Wizard, 10, found);
+printf("Found %d (count %d):\n", count,
+       character_store_count(&store, Wizard, 10));
+for (int i = 0; i < count; i++) {
+  character_t character;
+  character_store_get(&store, found[i], &character);
+  print_character(&character);
+  printf("\n");
+}
+bst_print_tree(test_tree);
+character_store_dispose(&store);
+ENDTEST
+
+TEST(test_character_store_filter_exact,
+     "Filter into a result array sized by character_store_count")
+bst_init(&test_tree);
+character_store_t store;
+character_store_init(&store);
+character_store_add(&store, "Elminster", Wizard, 20);
+character_store_add(&store, "Jozan", Cleric, 5);
+int expected = character_store_count(&store, Wizard, 10);
+int *found = malloc(expected * sizeof(int));
+int count = character_store_filter(&store, Wizard, 10, found);
+printf("Found %d (count %d), first id %d\n", count, expected, found[0]);
+free(found);
+character_store_dispose(&store);
+ENDTEST
+
+TEST(test_character_index, "Maintain secondary indexes of a character tree")
+bst_init(&test_tree);
+character_index_t index;
+character_index_init(&index);
+const char *names[] = {"Elminster", "Mordenkainen", "Elminster", "Tasha",
+                       "Drizzt", "Raistlin"};
+const character_class_t classes[] = {Wizard, Wizard, Cleric,
+                                     Wizard, Fighter, Wizard};
+const unsigned char levels[] = {20, 15, 3, 9, 12, 10};
+for (int i = 0; i < 6; i++) {
+  character_t *character = malloc(sizeof(character_t));
+  character->name = (char *)names[i];
+  character->character_class = classes[i];
+  character->level = levels[i];
+  character_index_insert(&index, 'A' + i, character);
+}
+char keys[CHARACTER_INDEX_KEYS];
+int count = character_index_find_name(&index, "Elminster", keys);
+printf("Elminster (%d):", count);
+for (int i = 0; i < count; i++) {
+  printf(" %c", keys[i]);
+}
+count = character_index_find_class(&index, Wizard, keys);
+printf("\nWizards (%d):", count);
+for (int i = 0; i < count; i++) {
+  printf(" %c", keys[i]);
+}
+count = character_index_find_level(&index, 9, 15, keys);
+printf("\nLevel 9-15 (%d):", count);
+for (int i = 0; i < count; i++) {
+  printf(" %c", keys[i]);
+}
+character_t *update = malloc(sizeof(character_t));
+update->name = "Tasha";
+update->character_class = Bard;
+update->level = 1;
+character_index_insert(&index, 'B', update);
+character_index_delete(&index, 'D');
+character_index_delete(&index, 'Z');
+count = character_index_find_name(&index, "Tasha", keys);
+printf("\nAfter update and delete\nTasha (%d):", count);
+for (int i = 0; i < count; i++) {
+  printf(" %c", keys[i]);
+}
+count = character_index_find_class(&index, Wizard, keys);
+printf("\nWizards (%d):", count);
+for (int i = 0; i < count; i++) {
+  printf(" %c", keys[i]);
+}
+count = character_index_find_level(&index, 0, 255, keys);
+printf("\nBy level (%d):", count);
+for (int i = 0; i < count; i++) {
+  printf(" %c", keys[i]);
+}
+printf("\n");
+bst_print_tree(index.tree);
+character_index_dispose(&index);
+ENDTEST
+
+TEST(test_tree_dump_binary, "Dump the tree in the binary format")
+bst_init(&test_tree);
+bst_insert_many(&test_tree, traversal_keys, traversal_values,
+                traversal_data_count);
+FILE *stream = tmpfile();
+writer_t *writer = malloc(sizeof(writer_t));
+writer_init(writer, stream);
+bst_dump_binary(writer, test_tree);
+writer_flush(writer);
+free(writer);
+long length = ftell(stream);
+rewind(stream);
+printf("Dump (%ld bytes):", length);
+for (int c = fgetc(stream); c != EOF; c = fgetc(stream)) {
+  printf(" %02x", c);
+}
+printf("\n");
+fclose(stream);
+ENDTEST
+
+TEST(test_tree_save_load, "Save the tree, load it and search the mapped file")
+bst_init(&test_tree);
+bst_insert_many(&test_tree, base_keys, base_values, base_data_count);
+character_t *character = malloc(sizeof(character_t));
+character->name = "Elminster";
+character->character_class = Wizard;
+character->level = 20;
+bst_node_content_t content = {.value = character, .type = CHARACTER_T};
+bst_insert(&test_tree, 'W', content);
+char path[] = "/tmp/bst_imageXXXXXX";
+close(mkstemp(path));
+printf("Saved: %s\n", bst_save(test_tree, path) ? "yes" : "no");
+bst_dispose(&test_tree);
+printf("Loaded: %s\n", bst_load(&test_tree, path) ? "yes" : "no");
+bst_print_tree(test_tree);
+bst_image_t image;
+printf("Mapped: %s\n", bst_image_open(&image, path) ? "yes" : "no");
+const char keys[] = {'A', 'H', 'O', 'W', 'X'};
+for (int i = 0; i < 5; i++) {
+  bst_image_value_t value;
+  printf("%c: ", keys[i]);
+  if (!bst_image_search(&image, keys[i], &value)) {
+    printf("missing\n");
+  } else if (value.type == INTEGER) {
+    printf("%d\n", value.integer);
+  } else {
+    print_character(&value.character);
+    printf("\n");
+  }
+}
+bst_image_close(&image);
+unlink(path);
+ENDTEST
+
+#ifdef IAL_PERF
+
+TEST(test_perf_counters, "Count measured tree operations")
+bst_perf_reset();
+bst_init(&test_tree);
+for (int i = 0; i < base_data_count; i++) {
+  bst_insert(&test_tree, base_keys[i], create_integer_content(base_values[i]));
+}
+bst_node_content_t *found;
+bst_search(test_tree, 'A', &found);
+bst_search(test_tree, 'X', &found);
+bst_delete(&test_tree, 'H');
+bst_inorder(test_tree, test_items);
+printf("Calls: init %llu, insert %llu, search %llu, delete %llu, "
+       "inorder %llu\n",
+       (unsigned long long)bst_perf_calls(BST_PERF_INIT),
+       (unsigned long long)bst_perf_calls(BST_PERF_INSERT),
+       (unsigned long long)bst_perf_calls(BST_PERF_SEARCH),
+       (unsigned long long)bst_perf_calls(BST_PERF_DELETE),
+       (unsigned long long)bst_perf_calls(BST_PERF_INORDER));
+ENDTEST
+
+#endif // IAL_PERF
+
 #ifdef EXA
 
 TEST(test_letter_count, "Count letters");
@@ -182,6 +678,54 @@ letter_count(&test_tree, "abBcCc_ 123 *");
 bst_print_tree(test_tree);
 ENDTEST
 
+TEST(test_letter_count_long, "Count letters in a longer text")
+bst_init(&test_tree);
+letter_count(&test_tree,
+             "The quick brown fox jumps over the lazy dog. "
+             "PACK MY BOX WITH FIVE DOZEN LIQUOR JUGS! 0123456789 "
+             "Sphinx of black quartz, judge my vow.");
+bst_print_tree(test_tree);
+ENDTEST
+
+TEST(test_letter_count_update, "Add letter counts to an existing tree")
+bst_init(&test_tree);
+letter_count(&test_tree, "abBcCc_ 123 *");
+letter_count_update(&test_tree, "Zebra zone", 10);
+bst_print_tree(test_tree);
+ENDTEST
+
+TEST(test_letter_count_saturate, "Saturate letter counts above INT_MAX")
+letter_count(&test_tree, "abBcCc_ 123 *");
+letter_count_add(&test_tree, 'a', (size_t)INT_MAX);
+letter_count_add(&test_tree, 'z', (size_t)INT_MAX + 5);
+letter_count_add(&test_tree, 'c', 7);
+bst_print_tree(test_tree);
+ENDTEST
+
+TEST(test_letter_count_file, "Count letters in a file using two threads")
+bst_init(&test_tree);
+char path[] = "/tmp/ial_letter_count_XXXXXX";
+int fd = mkstemp(path);
+const char *text = "abBcCc_ 123 * The quick brown fox";
+write(fd, text, strlen(text));
+close(fd);
+letter_count_file(&test_tree, path, 2);
+unlink(path);
+bst_print_tree(test_tree);
+ENDTEST
+
+TEST(test_letter_count_pipe, "Count letters read from a pipe")
+bst_init(&test_tree);
+int fds[2];
+const char *text = "abBcCc_ 123 *";
+pipe(fds);
+write(fds[1], text, strlen(text));
+close(fds[1]);
+letter_count_fd(&test_tree, fds[0], 2);
+close(fds[0]);
+bst_print_tree(test_tree);
+ENDTEST
+
 #endif // EXA
 
 int main(int argc, char *argv[]) {
@@ -206,8 +750,35 @@ int main(int argc, char *argv[]) {
   test_tree_preorder();
   test_tree_inorder();
   test_tree_postorder();
+  test_tree_build_sorted();
+  test_tree_build_unsorted();
+  test_tree_inorder_parallel();
+  test_tree_dispose_parallel();
+  test_conc_tree();
+  test_conc_tree_threads();
+  test_conc_tree_move_race();
+  test_pers_tree();
+  test_splay_tree();
+  test_tree_set_operations();
+  test_lazy_tree();
+  test_character_store();
+  test_character_store_filter_exact();
+  test_character_index();
+  test_tree_dump_binary();
+  test_tree_save_load();
+
+#ifdef IAL_PERF
+  test_perf_counters();
+#endif // IAL_PERF
 
 #ifdef EXA
   test_letter_count();
+  test_letter_count_long();
+  test_letter_count_update();
+  test_letter_count_saturate();
+  test_letter_count_file();
+  test_letter_count_pipe();
 #endif // EXA
+
+  BST_PERF_REPORT(stderr);
 }
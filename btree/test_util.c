@@ -1,57 +1,23 @@
 #include "test_util.h"
+#include "dump.h"
 #include <stdio.h>
 #include <stdlib.h>
-#include <string.h>
-
-const char *subtree_prefix = "  |";
-const char *space_prefix = "   ";
-
-char *make_prefix(char *prefix, const char *suffix) {
-  char *result = (char *)malloc(strlen(prefix) + strlen(suffix) + 1);
-  strcpy(result, prefix);
-  result = strcat(result, suffix);
-  return result;
-}
 
 void bst_print_subtree(bst_node_t *tree, char *prefix, direction_t from) {
-  if (tree != NULL) {
-    char *current_subtree_prefix = make_prefix(prefix, subtree_prefix);
-    char *current_space_prefix = make_prefix(prefix, space_prefix);
-
-    if (from == left) {
-      printf("%s\n", current_subtree_prefix);
-    }
-
-    bst_print_subtree(
-        tree->right,
-        from == left ? current_subtree_prefix : current_space_prefix, right);
-
-    printf("%s  +-", prefix);
-    bst_print_node(tree);
-    printf("\n");
-
-    bst_print_subtree(
-        tree->left,
-        from == right ? current_subtree_prefix : current_space_prefix, left);
-
-    if (from == right) {
-      printf("%s\n", current_subtree_prefix);
-    }
-
-    free(current_space_prefix);
-    free(current_subtree_prefix);
-  }
+  writer_t writer;
+  writer_init(&writer, stdout);
+  bst_write_subtree(&writer, tree, prefix,
+                    from == left    ? BST_DUMP_LEFT
+                    : from == right ? BST_DUMP_RIGHT
+                                    : BST_DUMP_NONE);
+  writer_flush(&writer);
 }
 
 void bst_print_tree(bst_node_t *tree) {
-  printf("Binary tree structure:\n");
-  printf("\n");
-  if (tree != NULL) {
-    bst_print_subtree(tree, "", none);
-  } else {
-    printf("Tree is empty\n");
-  }
-  printf("\n");
+  writer_t writer;
+  writer_init(&writer, stdout);
+  bst_write_tree(&writer, tree);
+  writer_flush(&writer);
 }
 
 bst_items_t* bst_init_items() {
@@ -63,12 +29,15 @@ bst_items_t* bst_init_items() {
 }
 
 void bst_print_items(bst_items_t *items) {
-  printf("Traversed items:\n");
+  writer_t writer;
+  writer_init(&writer, stdout);
+  writer_string(&writer, "Traversed items:\n");
     for (int i = 0; i < items->size; i++)
     {
-        bst_print_node(items->nodes[i]);
+        bst_write_node(&writer, items->nodes[i]);
     }
-  printf("\n");
+  writer_char(&writer, '\n');
+  writer_flush(&writer);
 }
 
 void bst_print_search_result(bst_node_content_t* content)
@@ -0,0 +1,215 @@
+/*
+ * Společné části měření výkonu
+ *
+ * Všechna měření používají generátor s pevným semínkem, takže při
+ * opakovaném spuštění pracují se stejnými daty. Výsledky se vypisují ve
+ * formátu CSV se sloupci:
+ *
+ *   operation     měřená operace
+ *   distribution  rozdělení klíčů (random, sorted, zipf), nebo "-"
+ *   threads       počet vláken
+ *   ops           počet provedených operací
+ *   keys          velikost prostoru klíčů, počet uzlů nebo délka vstupu
+ *   ns_per_op     průměrná doba operace v ns
+ *   ops_per_s     propustnost v operacích za sekundu
+ *   max_rss_kb    dosavadní maximální velikost rezidentní paměti procesu
+ *
+ * Měření latence jednotlivých operací mají vlastní tabulku se sloupci:
+ *
+ *   operation     měřená operace
+ *   engine        měřená implementace
+ *   keys          počet položek
+ *   load_factor   zaplnění tabulky
+ *   samples       počet měřených operací
+ *   p50_ns        medián doby operace v ns
+ *   p99_ns        99. percentil doby operace v ns
+ *   p999_ns       99,9. percentil doby operace v ns
+ *   max_ns        nejdelší operace v ns
+ *
+ * Doby obsahují i režii čtení hodin, kterou lze odhadnout řádkem s prázdnou
+ * operací.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <time.h>
+
+/*
+ * Aktuální čas monotónních hodin v ns.
+ */
+double bench_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/*
+ * Další pseudonáhodné číslo (xorshift64), state nesmí být nula.
+ */
+uint64_t bench_random(uint64_t *state)
+{
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+  return *state;
+}
+
+/*
+ * Název rozdělení klíčů pro výstup.
+ */
+const char *bench_distribution_name(bench_distribution_t distribution)
+{
+  switch (distribution)
+  {
+  case BENCH_RANDOM:
+    return "random";
+  case BENCH_SORTED:
+    return "sorted";
+  case BENCH_ZIPF:
+    return "zipf";
+  default:
+    return "-";
+  }
+}
+
+/*
+ * Vygenerování count klíčů z intervalu <0, key_space-1>.
+ *
+ * U Zipfova rozdělení má klíč s pořadím r pravděpodobnost úměrnou 1/r.
+ * Pořadí se klíčům přidělí náhodnou permutací, aby nejčastější klíče
+ * nebyly zároveň nejmenší.
+ */
+void bench_keys(bench_distribution_t distribution, int keys[], long count,
+                int key_space, uint64_t seed)
+{
+  uint64_t state = seed != 0 ? seed : 88172645463325252ull;
+
+  if (distribution == BENCH_SORTED)
+  {
+    for (long i = 0; i < count; i++)
+    {
+      keys[i] = (int)(i * key_space / count);
+    }
+    return;
+  }
+  if (distribution != BENCH_ZIPF)
+  {
+    for (long i = 0; i < count; i++)
+    {
+      keys[i] = (int)(bench_random(&state) % key_space);
+    }
+    return;
+  }
+
+  double *cumulative = malloc(key_space * sizeof(double));
+  int *rank_to_key = malloc(key_space * sizeof(int));
+  double sum = 0;
+
+  for (int i = 0; i < key_space; i++)
+  {
+    sum += 1.0 / (i + 1);
+    cumulative[i] = sum;
+    rank_to_key[i] = i;
+  }
+  for (int i = key_space - 1; i > 0; i--)
+  {
+    int j = (int)(bench_random(&state) % (i + 1));
+    int swap = rank_to_key[i];
+    rank_to_key[i] = rank_to_key[j];
+    rank_to_key[j] = swap;
+  }
+
+  for (long i = 0; i < count; i++)
+  {
+    double target = (bench_random(&state) >> 11) * 0x1.0p-53 * sum;
+    int low = 0;
+    int high = key_space - 1;
+    while (low < high)
+    {
+      int mid = (low + high) / 2;
+      if (cumulative[mid] < target)
+      {
+        low = mid + 1;
+      }
+      else
+      {
+        high = mid;
+      }
+    }
+    keys[i] = rank_to_key[low];
+  }
+
+  free(rank_to_key);
+  free(cumulative);
+}
+
+/*
+ * Maximální velikost rezidentní paměti procesu v KiB.
+ */
+long bench_max_rss_kb(void)
+{
+  struct rusage usage;
+  return getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_maxrss : -1;
+}
+
+/*
+ * Výpis hlavičky CSV.
+ */
+void bench_header(void)
+{
+  printf("operation,distribution,threads,ops,keys,ns_per_op,ops_per_s,"
+         "max_rss_kb\n");
+}
+
+/*
+ * Výpis jednoho řádku CSV pro ops operací trvajících celkem elapsed_ns.
+ */
+void bench_report(const char *operation, const char *distribution,
+                  int threads, long ops, long keys, double elapsed_ns)
+{
+  double ns_per_op = ops > 0 ? elapsed_ns / ops : 0;
+  printf("%s,%s,%d,%ld,%ld,%.2f,%.0f,%ld\n", operation, distribution, threads,
+         ops, keys, ns_per_op, ns_per_op > 0 ? 1e9 / ns_per_op : 0,
+         bench_max_rss_kb());
+  fflush(stdout);
+}
+
+/* Porovnání dvou vzorků pro qsort */
+static int bench_compare_samples(const void *a, const void *b)
+{
+  double x = *(const double *)a;
+  double y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+/*
+ * Výpis hlavičky tabulky latencí.
+ */
+void bench_latency_header(void)
+{
+  printf("operation,engine,keys,load_factor,samples,p50_ns,p99_ns,p999_ns,"
+         "max_ns\n");
+}
+
+/*
+ * Výpis percentilů count naměřených dob samples (pole se seřadí).
+ */
+void bench_latency_report(const char *operation, const char *engine,
+                          long keys, double load_factor, double samples[],
+                          long count)
+{
+  if (count == 0)
+  {
+    return;
+  }
+  qsort(samples, count, sizeof(double), bench_compare_samples);
+  printf("%s,%s,%ld,%.3f,%ld,%.1f,%.1f,%.1f,%.1f\n", operation, engine, keys,
+         load_factor, count, samples[count / 2], samples[count * 99 / 100],
+         samples[count * 999 / 1000], samples[count - 1]);
+  fflush(stdout);
+}
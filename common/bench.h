@@ -0,0 +1,36 @@
+/*
+ * Hlavičkový soubor pro společné části měření výkonu.
+ */
+
+#ifndef IAL_BENCH_H
+#define IAL_BENCH_H
+
+#include <stdint.h>
+
+// Nejmenší a výchozí největší počet operací jednoho měření
+#define BENCH_MIN_OPS 1000L
+#define BENCH_DEFAULT_MAX_OPS 1000000L
+
+// Rozdělení klíčů
+typedef enum bench_distribution {
+  BENCH_RANDOM,       // rovnoměrně náhodné
+  BENCH_SORTED,       // neklesající posloupnost přes celý prostor klíčů
+  BENCH_ZIPF,         // podle Zipfova zákona s exponentem 1
+  BENCH_DISTRIBUTIONS // počet rozdělení
+} bench_distribution_t;
+
+double bench_now_ns(void);
+uint64_t bench_random(uint64_t *state);
+const char *bench_distribution_name(bench_distribution_t distribution);
+void bench_keys(bench_distribution_t distribution, int keys[], long count,
+                int key_space, uint64_t seed);
+long bench_max_rss_kb(void);
+void bench_header(void);
+void bench_report(const char *operation, const char *distribution,
+                  int threads, long ops, long keys, double elapsed_ns);
+void bench_latency_header(void);
+void bench_latency_report(const char *operation, const char *engine,
+                          long keys, double load_factor, double samples[],
+                          long count);
+
+#endif
@@ -0,0 +1,239 @@
+/*
+ * Společné úložiště řetězců
+ *
+ * Každý různý řetězec je uložený jen jednou v blocích paměti, které se
+ * nepřesouvají, takže vrácený ukazatel na text platí až do uvolnění
+ * úložiště. Před textem leží předem spočítaný hash a délka (intern_hash,
+ * intern_length). Dva řetězce ze stejného úložiště jsou shodné právě
+ * tehdy, když jsou shodné jejich ukazatele.
+ *
+ * Texty se vyhledávají v rozptylové tabulce s otevřeným adresováním
+ * a lineárním průzkumem, která se zvětší na dvojnásobek při zaplnění nad
+ * polovinu. Počítadla uvádějí, kolik bajtů by zabraly samostatné kopie
+ * všech zadaných textů a kolik je skutečně uloženo.
+ *
+ * intern_global vrací úložiště sdílené tabulkami i stromy; uvolňuje se až
+ * s koncem programu. Úložiště není chráněné proti souběžnému přístupu.
+ */
+
+#include "intern.h"
+#include <stdalign.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Počáteční velikost rozptylové tabulky
+#define INTERN_MIN_CAPACITY 64
+
+// Globální úložiště; statická inicializace nulami odpovídá intern_init
+static intern_pool_t intern_global_pool;
+
+/* Rozptylovací funkce FNV-1a, délka textu se vrací v *length */
+static uint32_t intern_hash_text(const char *text, size_t *length)
+{
+  uint32_t result = 2166136261u;
+  const char *start = text;
+  for (; *text != '\0'; text++)
+  {
+    result ^= (unsigned char)*text;
+    result *= 16777619u;
+  }
+  *length = text - start;
+  return result;
+}
+
+/* Záznam řetězce podle ukazatele na text */
+static const intern_string_t *intern_header(const char *handle)
+{
+  return (const intern_string_t *)(handle - offsetof(intern_string_t, text));
+}
+
+/*
+ * Pomocná funkce pro vyhledání místa textu v tabulce; vrací místo
+ * s textem, nebo první volné místo.
+ */
+static size_t intern_slot(intern_pool_t *pool, const char *text,
+                          uint32_t hash, size_t length)
+{
+  size_t mask = pool->capacity - 1;
+  size_t slot = hash & mask;
+
+  while (pool->slots[slot] != NULL)
+  {
+    intern_string_t *string = pool->slots[slot];
+    if (string->hash == hash && string->length == length &&
+        memcmp(string->text, text, length) == 0)
+    {
+      break;
+    }
+    slot = (slot + 1) & mask;
+  }
+  return slot;
+}
+
+/* Zvětšení tabulky na dvojnásobek, vrací false při nedostatku paměti */
+static bool intern_grow(intern_pool_t *pool)
+{
+  size_t capacity =
+      pool->capacity > 0 ? pool->capacity * 2 : INTERN_MIN_CAPACITY;
+  intern_string_t **slots = calloc(capacity, sizeof(intern_string_t *));
+  if (slots == NULL)
+  {
+    return false;
+  }
+
+  for (size_t i = 0; i < pool->capacity; i++)
+  {
+    intern_string_t *string = pool->slots[i];
+    if (string != NULL)
+    {
+      size_t slot = string->hash & (capacity - 1);
+      while (slots[slot] != NULL)
+      {
+        slot = (slot + 1) & (capacity - 1);
+      }
+      slots[slot] = string;
+    }
+  }
+
+  free(pool->slots);
+  pool->slots = slots;
+  pool->capacity = capacity;
+  return true;
+}
+
+/* Místo pro size bajtů v blocích, při nedostatku paměti NULL */
+static void *intern_allocate(intern_pool_t *pool, size_t size)
+{
+  size_t align = alignof(intern_string_t);
+  size = (size + align - 1) & ~(align - 1);
+
+  intern_chunk_t *chunk = pool->chunks;
+  if (chunk == NULL || chunk->capacity - chunk->used < size)
+  {
+    size_t capacity = size > INTERN_CHUNK_SIZE ? size : INTERN_CHUNK_SIZE;
+    chunk = malloc(sizeof(intern_chunk_t) + capacity);
+    if (chunk == NULL)
+    {
+      return NULL;
+    }
+    chunk->next = pool->chunks;
+    chunk->used = 0;
+    chunk->capacity = capacity;
+    pool->chunks = chunk;
+  }
+
+  void *result = chunk->data + chunk->used;
+  chunk->used += size;
+  return result;
+}
+
+/*
+ * Inicializace prázdného úložiště.
+ */
+void intern_init(intern_pool_t *pool)
+{
+  pool->slots = NULL;
+  pool->capacity = 0;
+  pool->chunks = NULL;
+  pool->stats = (intern_stats_t){0, 0, 0, 0};
+}
+
+/*
+ * Uložení textu, pokud v úložišti ještě není. Vrací ukazatel na uložený
+ * text, nebo NULL při nedostatku paměti.
+ */
+const char *intern(intern_pool_t *pool, const char *text)
+{
+  size_t length;
+  uint32_t hash = intern_hash_text(text, &length);
+
+  if (2 * (pool->stats.strings + 1) > pool->capacity && !intern_grow(pool))
+  {
+    return NULL;
+  }
+
+  size_t slot = intern_slot(pool, text, hash, length);
+  if (pool->slots[slot] == NULL)
+  {
+    intern_string_t *string =
+        intern_allocate(pool, sizeof(intern_string_t) + length + 1);
+    if (string == NULL)
+    {
+      return NULL;
+    }
+    string->hash = hash;
+    string->length = length;
+    memcpy(string->text, text, length + 1);
+    pool->slots[slot] = string;
+    pool->stats.strings++;
+    pool->stats.bytes += length + 1;
+  }
+
+  pool->stats.requests++;
+  pool->stats.requested_bytes += length + 1;
+  return pool->slots[slot]->text;
+}
+
+/*
+ * Vyhledání uloženého textu bez jeho přidání, vrací NULL pokud v úložišti
+ * není.
+ */
+const char *intern_find(intern_pool_t *pool, const char *text)
+{
+  if (pool->capacity == 0)
+  {
+    return NULL;
+  }
+
+  size_t length;
+  uint32_t hash = intern_hash_text(text, &length);
+  intern_string_t *string = pool->slots[intern_slot(pool, text, hash, length)];
+  return string != NULL ? string->text : NULL;
+}
+
+/*
+ * Předem spočítaný hash uloženého textu.
+ */
+uint32_t intern_hash(const char *handle)
+{
+  return intern_header(handle)->hash;
+}
+
+/*
+ * Délka uloženého textu.
+ */
+size_t intern_length(const char *handle)
+{
+  return intern_header(handle)->length;
+}
+
+/*
+ * Počet bajtů ušetřených oproti samostatným kopiím zadaných textů.
+ */
+size_t intern_deduplicated_bytes(intern_pool_t *pool)
+{
+  return pool->stats.requested_bytes - pool->stats.bytes;
+}
+
+/*
+ * Uvolnění úložiště; všechny vrácené ukazatele přestanou platit.
+ */
+void intern_dispose(intern_pool_t *pool)
+{
+  while (pool->chunks != NULL)
+  {
+    intern_chunk_t *next = pool->chunks->next;
+    free(pool->chunks);
+    pool->chunks = next;
+  }
+  free(pool->slots);
+  intern_init(pool);
+}
+
+/*
+ * Úložiště sdílené celým programem.
+ */
+intern_pool_t *intern_global(void)
+{
+  return &intern_global_pool;
+}
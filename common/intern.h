@@ -0,0 +1,55 @@
+/*
+ * Hlavičkový soubor pro společné úložiště řetězců (interning).
+ */
+
+#ifndef IAL_INTERN_H
+#define IAL_INTERN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Velikost bloku paměti pro řetězce
+#define INTERN_CHUNK_SIZE 65536
+
+// Uložený řetězec; ukazatel na text je jeho identifikátor
+typedef struct intern_string {
+  uint32_t hash;   // hash textu (FNV-1a)
+  uint32_t length; // délka textu bez '\0'
+  char text[];     // text ukončený '\0'
+} intern_string_t;
+
+// Blok paměti s řetězci
+typedef struct intern_chunk {
+  struct intern_chunk *next; // předchozí blok
+  size_t used;               // obsazené bajty
+  size_t capacity;           // velikost pole data
+  _Alignas(intern_string_t) char data[];
+} intern_chunk_t;
+
+// Počítadla úložiště
+typedef struct intern_stats {
+  size_t strings;         // počet různých řetězců
+  size_t bytes;           // bajty uložených textů včetně '\0'
+  size_t requests;        // počet volání intern
+  size_t requested_bytes; // bajty všech zadaných textů včetně '\0'
+} intern_stats_t;
+
+// Úložiště řetězců
+typedef struct intern_pool {
+  intern_string_t **slots; // rozptylová tabulka s otevřeným adresováním
+  size_t capacity;         // velikost tabulky, mocnina dvou nebo 0
+  intern_chunk_t *chunks;  // poslední blok
+  intern_stats_t stats;    // počítadla
+} intern_pool_t;
+
+void intern_init(intern_pool_t *pool);
+const char *intern(intern_pool_t *pool, const char *text);
+const char *intern_find(intern_pool_t *pool, const char *text);
+uint32_t intern_hash(const char *handle);
+size_t intern_length(const char *handle);
+size_t intern_deduplicated_bytes(intern_pool_t *pool);
+void intern_dispose(intern_pool_t *pool);
+intern_pool_t *intern_global(void);
+
+#endif
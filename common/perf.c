@@ -0,0 +1,224 @@
+/*
+ * Měření hardwarových čítačů kolem operací
+ *
+ * Každé vlákno si při první operaci otevře skupinu čítačů funkcí
+ * perf_event_open (takty, instrukce, výpadky LLC, chybné předpovědi skoků)
+ * a na začátku i na konci operace přečte celou skupinu jedním voláním read.
+ * Pokud jádro čítače neposkytuje (kontejner, perf_event_paranoid, jiná
+ * platforma než Linux), měří se jen doba pomocí clock_gettime.
+ *
+ * Souhrny se sčítají atomicky, operace tedy mohou běžet ve více vláknech.
+ * Měření samo stojí stovky ns na operaci (dvě systémová volání), hodnoty
+ * čítačů proto obsahují i režii čtení a slouží k porovnání, ne jako
+ * absolutní údaj.
+ */
+
+#define _GNU_SOURCE
+
+#include "perf.h"
+#include <string.h>
+#include <time.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Stav otevření čítačů vlákna
+typedef enum perf_state {
+  PERF_UNOPENED,
+  PERF_OPEN,
+  PERF_UNAVAILABLE
+} perf_state_t;
+
+static _Thread_local perf_state_t perf_state = PERF_UNOPENED;
+static _Thread_local int perf_group = -1;
+
+/*
+ * Pomocná funkce pro aktuální čas v ns.
+ */
+static uint64_t perf_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+#ifdef __linux__
+/*
+ * Pomocná funkce pro otevření jednoho čítače ve skupině group.
+ */
+static int perf_open_counter(uint32_t type, uint64_t config, int group)
+{
+  struct perf_event_attr attr;
+
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.disabled = group < 0;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP;
+  return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+/*
+ * Pomocná funkce pro otevření skupiny čítačů vlákna.
+ */
+static void perf_open(void)
+{
+  static const uint64_t configs[PERF_COUNTERS] = {
+      [PERF_CYCLES] = PERF_COUNT_HW_CPU_CYCLES,
+      [PERF_INSTRUCTIONS] = PERF_COUNT_HW_INSTRUCTIONS,
+      [PERF_LLC_MISSES] = PERF_COUNT_HW_CACHE_MISSES,
+      [PERF_BRANCH_MISSES] = PERF_COUNT_HW_BRANCH_MISSES};
+  int fds[PERF_COUNTERS];
+
+  perf_state = PERF_UNAVAILABLE;
+  for (int i = 0; i < PERF_COUNTERS; i++)
+  {
+    fds[i] = perf_open_counter(PERF_TYPE_HARDWARE, configs[i],
+                               i == 0 ? -1 : fds[0]);
+    if (fds[i] < 0)
+    {
+      while (i-- > 0)
+      {
+        close(fds[i]);
+      }
+      return;
+    }
+  }
+  perf_group = fds[0];
+  ioctl(perf_group, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  perf_state = PERF_OPEN;
+}
+
+/*
+ * Pomocná funkce pro přečtení skupiny čítačů.
+ */
+static bool perf_read(uint64_t counters[])
+{
+  uint64_t values[1 + PERF_COUNTERS];
+
+  if (read(perf_group, values, sizeof(values)) != sizeof(values) ||
+      values[0] != PERF_COUNTERS)
+  {
+    return false;
+  }
+  memcpy(counters, values + 1, PERF_COUNTERS * sizeof(uint64_t));
+  return true;
+}
+#else
+static void perf_open(void)
+{
+  perf_state = PERF_UNAVAILABLE;
+}
+
+static bool perf_read(uint64_t counters[])
+{
+  (void)counters;
+  return false;
+}
+#endif
+
+/*
+ * Zjištění, zda jsou v aktuálním vlákně k dispozici hardwarové čítače.
+ */
+bool perf_available(void)
+{
+  if (perf_state == PERF_UNOPENED)
+  {
+    perf_open();
+  }
+  return perf_state == PERF_OPEN;
+}
+
+/*
+ * Začátek měření operace.
+ */
+void perf_begin(perf_sample_t *sample)
+{
+  sample->counting = perf_available() && perf_read(sample->counters);
+  sample->start_ns = perf_now_ns();
+}
+
+/*
+ * Konec měření operace a přičtení výsledku do souhrnu op.
+ */
+void perf_end(perf_op_t *op, const perf_sample_t *sample)
+{
+  uint64_t end_ns = perf_now_ns();
+  uint64_t counters[PERF_COUNTERS];
+
+  atomic_fetch_add_explicit(&op->calls, 1, memory_order_relaxed);
+  atomic_fetch_add_explicit(&op->ns, end_ns - sample->start_ns,
+                            memory_order_relaxed);
+  if (sample->counting && perf_read(counters))
+  {
+    atomic_fetch_add_explicit(&op->counted, 1, memory_order_relaxed);
+    for (int i = 0; i < PERF_COUNTERS; i++)
+    {
+      atomic_fetch_add_explicit(&op->counters[i],
+                                counters[i] - sample->counters[i],
+                                memory_order_relaxed);
+    }
+  }
+}
+
+/*
+ * Výpis souhrnů operací ve formátu CSV.
+ *
+ * Hodnoty jsou průměry na jedno volání. Pokud čítače nebyly k dispozici,
+ * jsou odpovídající sloupce prázdné.
+ */
+void perf_report(FILE *stream, perf_op_t ops[], int count)
+{
+  fprintf(stream, "operation,calls,ns_per_op,cycles_per_op,"
+                  "instructions_per_op,llc_misses_per_op,"
+                  "branch_misses_per_op\n");
+  for (int i = 0; i < count; i++)
+  {
+    uint64_t calls = atomic_load(&ops[i].calls);
+    uint64_t counted = atomic_load(&ops[i].counted);
+    if (calls == 0)
+    {
+      continue;
+    }
+
+    fprintf(stream, "%s,%llu,%.1f", ops[i].name, (unsigned long long)calls,
+            (double)atomic_load(&ops[i].ns) / calls);
+    for (int j = 0; j < PERF_COUNTERS; j++)
+    {
+      if (counted > 0)
+      {
+        fprintf(stream, ",%.1f",
+                (double)atomic_load(&ops[i].counters[j]) / counted);
+      }
+      else
+      {
+        fprintf(stream, ",");
+      }
+    }
+    fprintf(stream, "\n");
+  }
+}
+
+/*
+ * Vynulování souhrnů operací.
+ */
+void perf_reset(perf_op_t ops[], int count)
+{
+  for (int i = 0; i < count; i++)
+  {
+    atomic_store(&ops[i].calls, 0);
+    atomic_store(&ops[i].ns, 0);
+    atomic_store(&ops[i].counted, 0);
+    for (int j = 0; j < PERF_COUNTERS; j++)
+    {
+      atomic_store(&ops[i].counters[j], 0);
+    }
+  }
+}
@@ -0,0 +1,51 @@
+/*
+ * Hlavičkový soubor pro měření hardwarových čítačů kolem operací.
+ *
+ * Měření se zapíná překladem s -DIAL_PERF (v Makefile: make PERF=1). Bez
+ * něj se tento soubor ani perf.c nepoužívají a volání operací zůstávají
+ * přímá.
+ */
+
+#ifndef IAL_PERF_H
+#define IAL_PERF_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Sledované čítače
+typedef enum perf_counter {
+  PERF_CYCLES,        // takty procesoru
+  PERF_INSTRUCTIONS,  // vykonané instrukce
+  PERF_LLC_MISSES,    // výpadky poslední úrovně cache
+  PERF_BRANCH_MISSES, // chybně předpovězené skoky
+  PERF_COUNTERS       // počet čítačů
+} perf_counter_t;
+
+// Souhrn jednoho typu operace
+typedef struct perf_op {
+  const char *name;                           // název operace
+  atomic_uint_least64_t calls;                // počet volání
+  atomic_uint_least64_t ns;                   // celková doba v ns
+  atomic_uint_least64_t counted;              // volání změřená čítači
+  atomic_uint_least64_t counters[PERF_COUNTERS]; // součty čítačů
+} perf_op_t;
+
+// Stav čítačů na začátku jedné operace
+typedef struct perf_sample {
+  uint64_t start_ns;                 // čas začátku
+  uint64_t counters[PERF_COUNTERS];  // hodnoty čítačů
+  bool counting;                     // čítače jsou k dispozici
+} perf_sample_t;
+
+// Inicializátor položky pole souhrnů
+#define PERF_OP(NAME) {.name = NAME}
+
+bool perf_available(void);
+void perf_begin(perf_sample_t *sample);
+void perf_end(perf_op_t *op, const perf_sample_t *sample);
+void perf_report(FILE *stream, perf_op_t ops[], int count);
+void perf_reset(perf_op_t ops[], int count);
+
+#endif
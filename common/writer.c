@@ -0,0 +1,218 @@
+/*
+ * Bufferovaný zapisovač
+ *
+ * Výpisy velkých stromů a tabulek přes printf jsou drahé — každé pole
+ * znamená rozbor formátovacího řetězce a zamčení proudu. Zapisovač skládá
+ * výstup do vlastní vyrovnávací paměti a do proudu ji předává po celých
+ * blocích. Celá a desetinná čísla formátuje sám.
+ *
+ * Binární hodnoty se zapisují v pořadí little-endian, varint používá
+ * 7 bitů na bajt (LEB128).
+ */
+
+#include "writer.h"
+#include <math.h>
+#include <string.h>
+
+/*
+ * Inicializace zapisovače do proudu stream.
+ */
+void writer_init(writer_t *writer, FILE *stream)
+{
+  writer->stream = stream;
+  writer->length = 0;
+  writer->failed = false;
+}
+
+/*
+ * Předání obsahu vyrovnávací paměti do proudu.
+ *
+ * Vrací false, pokud některý zápis od inicializace selhal.
+ */
+bool writer_flush(writer_t *writer)
+{
+  if (writer->length > 0 &&
+      fwrite(writer->buffer, 1, writer->length, writer->stream) !=
+          writer->length)
+  {
+    writer->failed = true;
+  }
+  writer->length = 0;
+  return !writer->failed;
+}
+
+/*
+ * Zápis length bajtů z data.
+ */
+void writer_bytes(writer_t *writer, const void *data, size_t length)
+{
+  if (writer->length + length > WRITER_BUFFER_SIZE)
+  {
+    writer_flush(writer);
+    if (length > WRITER_BUFFER_SIZE)
+    {
+      // Velké bloky jdou přímo do proudu
+      if (fwrite(data, 1, length, writer->stream) != length)
+      {
+        writer->failed = true;
+      }
+      return;
+    }
+  }
+  memcpy(writer->buffer + writer->length, data, length);
+  writer->length += length;
+}
+
+/*
+ * Zápis jednoho znaku.
+ */
+void writer_char(writer_t *writer, char c)
+{
+  if (writer->length == WRITER_BUFFER_SIZE)
+  {
+    writer_flush(writer);
+  }
+  writer->buffer[writer->length++] = c;
+}
+
+/*
+ * Zápis řetězce ukončeného nulou (bez ukončovací nuly).
+ */
+void writer_string(writer_t *writer, const char *string)
+{
+  writer_bytes(writer, string, strlen(string));
+}
+
+/*
+ * Zápis celého čísla bez znaménka v desítkové soustavě.
+ */
+void writer_unsigned(writer_t *writer, unsigned long long value)
+{
+  char digits[20];
+  int count = 0;
+
+  do
+  {
+    digits[sizeof(digits) - 1 - count++] = (char)('0' + value % 10);
+    value /= 10;
+  } while (value != 0);
+  writer_bytes(writer, digits + sizeof(digits) - count, count);
+}
+
+/*
+ * Zápis celého čísla se znaménkem v desítkové soustavě.
+ */
+void writer_int(writer_t *writer, long long value)
+{
+  if (value < 0)
+  {
+    writer_char(writer, '-');
+    writer_unsigned(writer, 0ULL - (unsigned long long)value);
+  }
+  else
+  {
+    writer_unsigned(writer, value);
+  }
+}
+
+/*
+ * Zápis čísla s pevným počtem desetinných míst (jako "%.*f").
+ *
+ * Součin hodnoty typu float a 10^decimals je pro decimals nejvýše
+ * WRITER_FLOAT_MAX_DECIMALS v typu double přesný, zaokrouhlení na sudou
+ * proto dává stejný výsledek jako printf. Hodnoty mimo rozsah a větší
+ * počty míst se formátují přes snprintf.
+ */
+void writer_float(writer_t *writer, float value, int decimals)
+{
+  double scale = 1;
+  for (int i = 0; i < decimals && i < WRITER_FLOAT_MAX_DECIMALS; i++)
+  {
+    scale *= 10;
+  }
+  double scaled = fabs((double)value) * scale;
+
+  if (decimals < 0 || decimals > WRITER_FLOAT_MAX_DECIMALS ||
+      !isfinite(value) || scaled >= 9007199254740992.0)
+  {
+    char text[64];
+    int length = snprintf(text, sizeof(text), "%.*f", decimals, value);
+    if (length > 0 && length < (int)sizeof(text))
+    {
+      writer_bytes(writer, text, length);
+    }
+    else
+    {
+      // Delší výpis (až stovky číslic) mimo vyrovnávací paměť
+      writer_flush(writer);
+      if (fprintf(writer->stream, "%.*f", decimals, value) < 0)
+      {
+        writer->failed = true;
+      }
+    }
+    return;
+  }
+
+  // Zaokrouhlení na nejbližší, při shodě na sudou
+  unsigned long long whole = (unsigned long long)scaled;
+  double fraction = scaled - (double)whole;
+  if (fraction > 0.5 || (fraction == 0.5 && whole % 2 == 1))
+  {
+    whole++;
+  }
+
+  if (signbit(value))
+  {
+    writer_char(writer, '-');
+  }
+
+  unsigned long long divisor = (unsigned long long)scale;
+  writer_unsigned(writer, whole / divisor);
+  if (decimals > 0)
+  {
+    char digits[WRITER_FLOAT_MAX_DECIMALS + 1];
+    unsigned long long rest = whole % divisor;
+    digits[0] = '.';
+    for (int i = decimals; i > 0; i--)
+    {
+      digits[i] = (char)('0' + rest % 10);
+      rest /= 10;
+    }
+    writer_bytes(writer, digits, decimals + 1);
+  }
+}
+
+/*
+ * Zápis jednoho bajtu.
+ */
+void writer_u8(writer_t *writer, uint8_t value)
+{
+  writer_char(writer, (char)value);
+}
+
+/*
+ * Zápis 32bitového čísla v pořadí little-endian.
+ */
+void writer_u32(writer_t *writer, uint32_t value)
+{
+  unsigned char bytes[4] = {value & 0xff, (value >> 8) & 0xff,
+                            (value >> 16) & 0xff, value >> 24};
+  writer_bytes(writer, bytes, sizeof(bytes));
+}
+
+/*
+ * Zápis čísla v proměnné délce (LEB128).
+ */
+void writer_varint(writer_t *writer, uint64_t value)
+{
+  unsigned char bytes[10];
+  int count = 0;
+
+  while (value >= 0x80)
+  {
+    bytes[count++] = (unsigned char)(value | 0x80);
+    value >>= 7;
+  }
+  bytes[count++] = (unsigned char)value;
+  writer_bytes(writer, bytes, count);
+}
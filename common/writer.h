@@ -0,0 +1,41 @@
+/*
+ * Hlavičkový soubor pro bufferovaný zápis textových a binárních výpisů.
+ */
+
+#ifndef IAL_WRITER_H
+#define IAL_WRITER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Velikost vyrovnávací paměti zapisovače
+#define WRITER_BUFFER_SIZE 65536
+
+// Nejvyšší počet desetinných míst, pro který je writer_float přesný
+#define WRITER_FLOAT_MAX_DECIMALS 8
+
+// Zapisovač do proudu s vlastní vyrovnávací pamětí
+typedef struct writer {
+  FILE *stream;                     // cílový proud
+  size_t length;                    // počet obsazených bajtů
+  bool failed;                      // došlo k chybě zápisu
+  char buffer[WRITER_BUFFER_SIZE];  // vyrovnávací paměť
+} writer_t;
+
+void writer_init(writer_t *writer, FILE *stream);
+bool writer_flush(writer_t *writer);
+
+void writer_bytes(writer_t *writer, const void *data, size_t length);
+void writer_char(writer_t *writer, char c);
+void writer_string(writer_t *writer, const char *string);
+void writer_int(writer_t *writer, long long value);
+void writer_unsigned(writer_t *writer, unsigned long long value);
+void writer_float(writer_t *writer, float value, int decimals);
+
+void writer_u8(writer_t *writer, uint8_t value);
+void writer_u32(writer_t *writer, uint32_t value);
+void writer_varint(writer_t *writer, uint64_t value);
+
+#endif
@@ -0,0 +1,143 @@
+/*
+ * Měření výkonu počítání frekvence slov a n-gramů.
+ *
+ * Vygeneruje text zadané velikosti ze slovníku s četnostmi podle Zipfova
+ * zákona a započítá ho po úsecích velikosti FREQ_CHUNK_SIZE. Výstup je ve
+ * formátu CSV: operace, velikost vstupu v bajtech, počet různých klíčů,
+ * propustnost v MB/s.
+ *
+ * Použití: ./bench [velikost_v_MB] [velikost_slovníku]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "freq.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static double now_s()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t next_random(uint64_t *state)
+{
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+  return *state;
+}
+
+/*
+ * Vygeneruje text délky length ze slovníku vocabulary slov. Slova se
+ * vybírají podle kumulativního Zipfova rozdělení s exponentem 1.
+ */
+static char *generate_text(size_t length, int vocabulary)
+{
+  char *text = malloc(length);
+  double *cumulative = malloc(vocabulary * sizeof(double));
+  char (*words)[12] = malloc(vocabulary * sizeof(*words));
+  uint64_t state = 88172645463325252ull;
+  double sum = 0;
+
+  for (int i = 0; i < vocabulary; i++)
+  {
+    sum += 1.0 / (i + 1);
+    cumulative[i] = sum;
+    int word_length = 2 + next_random(&state) % 9;
+    for (int j = 0; j < word_length; j++)
+    {
+      words[i][j] = 'a' + next_random(&state) % 26;
+    }
+    words[i][word_length] = '\0';
+  }
+
+  size_t position = 0;
+  while (position < length)
+  {
+    double target = (next_random(&state) >> 11) * 0x1.0p-53 * sum;
+    int low = 0;
+    int high = vocabulary - 1;
+    while (low < high)
+    {
+      int mid = (low + high) / 2;
+      if (cumulative[mid] < target)
+      {
+        low = mid + 1;
+      }
+      else
+      {
+        high = mid;
+      }
+    }
+    for (const char *ch = words[low]; *ch != '\0' && position < length; ch++)
+    {
+      text[position++] = *ch;
+    }
+    if (position < length)
+    {
+      text[position++] = next_random(&state) % 12 == 0 ? '.' : ' ';
+    }
+  }
+
+  free(cumulative);
+  free(words);
+  return text;
+}
+
+static void bench_counter(const char *name, int n, const char *text,
+                          size_t length)
+{
+  freq_counter_t counter;
+  freq_items_t top = {NULL, 0, 0};
+
+  freq_init(&counter, n);
+  double start = now_s();
+  for (size_t i = 0; i < length; i += FREQ_CHUNK_SIZE)
+  {
+    size_t chunk = length - i < FREQ_CHUNK_SIZE ? length - i : FREQ_CHUNK_SIZE;
+    freq_feed(&counter, text + i, chunk);
+  }
+  freq_finish(&counter);
+  freq_top(&counter, 10, &top);
+  double elapsed = now_s() - start;
+
+  printf("%s,%zu,%zu,%.1f\n", name, length, counter.table.size,
+         length / elapsed / 1e6);
+  free(top.items);
+  freq_dispose(&counter);
+}
+
+int main(int argc, char *argv[])
+{
+  size_t megabytes = argc > 1 ? strtoul(argv[1], NULL, 10) : 256;
+  int vocabulary = argc > 2 ? atoi(argv[2]) : 100000;
+
+  if (megabytes < 1)
+  {
+    megabytes = 1;
+  }
+  if (vocabulary < 1)
+  {
+    vocabulary = 1;
+  }
+
+  size_t length = megabytes << 20;
+  char *text = generate_text(length, vocabulary);
+  if (text == NULL)
+  {
+    return 1;
+  }
+
+  printf("operation,bytes,distinct,mb_per_s\n");
+  bench_counter("words", 0, text, length);
+  bench_counter("bigrams", 2, text, length);
+  bench_counter("trigrams", 3, text, length);
+
+  free(text);
+  return 0;
+}
@@ -0,0 +1,444 @@
+/*
+ * Počítání frekvence slov a n-gramů
+ *
+ * Počty výskytů se ukládají do tabulky s rozptýlenými položkami s explicitně
+ * zřetězenými synonymy, stejně jako v ../hashtable. Protože počet různých
+ * klíčů není předem známý, tabulka zdvojnásobí počet seznamů synonym,
+ * jakmile průměrná délka seznamu překročí jedna.
+ *
+ * Slovo je nejdelší posloupnost písmen a-z (bez ohledu na velikost). N-gramy
+ * se počítají nad znaky převedenými stejně jako v letter_count: písmena na
+ * malá, mezera zůstává, ostatní znaky se nahradí podtržítkem.
+ *
+ * Vstup lze předávat po libovolných úsecích, rozpracované slovo a posledních
+ * n - 1 znaků se přenáší do dalšího úseku. Znaky n-gramu se drží v jednom
+ * 64bitovém čísle, posun okna je tak jediný posun bitů.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "freq.h"
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Počáteční počet seznamů synonym
+#define FREQ_INITIAL_CAPACITY 1024
+
+/*
+ * Rozptylovací funkce pro slova je FNV-1a počítaná průběžně po znacích.
+ * Vrací se úplná hodnota, index seznamu se získá maskováním podle aktuální
+ * velikosti tabulky.
+ */
+#define FREQ_HASH_INIT 14695981039346656037ull
+
+static size_t freq_hash_step(size_t hash, char ch)
+{
+  return (size_t)(((uint64_t)hash ^ (unsigned char)ch) * 1099511628211ull);
+}
+
+/*
+ * Rozptylovací funkce pro n-gramy zabalené do jednoho 64bitového čísla.
+ * Funkce je prostá, různé n-gramy tak mají vždy různou hodnotu.
+ */
+static size_t freq_hash_window(uint64_t window)
+{
+  window ^= window >> 31;
+  window *= 0x9e3779b97f4a7c15ull;
+  window ^= window >> 29;
+  return (size_t)window;
+}
+
+/*
+ * Pomocná funkce pro zdvojnásobení počtu seznamů synonym.
+ */
+static void freq_table_grow(freq_table_t *table)
+{
+  size_t capacity = table->capacity * 2;
+  freq_item_t **buckets = calloc(capacity, sizeof(freq_item_t *));
+  if (buckets == NULL)
+  {
+    return;
+  }
+
+  for (size_t i = 0; i < table->capacity; i++)
+  {
+    freq_item_t *item = table->buckets[i];
+    while (item != NULL)
+    {
+      freq_item_t *next = item->next;
+      size_t index = item->hash & (capacity - 1);
+      item->next = buckets[index];
+      buckets[index] = item;
+      item = next;
+    }
+  }
+
+  free(table->buckets);
+  table->buckets = buckets;
+  table->capacity = capacity;
+}
+
+/*
+ * Přičtení count výskytů klíče key s hodnotou rozptylovací funkce hash.
+ *
+ * Seznam synonym se projde jen jednou; pokud prvek neexistuje, vloží se na
+ * začátek seznamu.
+ */
+static void freq_table_add(freq_table_t *table, const char *key, int length,
+                           size_t hash, size_t count)
+{
+  freq_item_t **bucket = &table->buckets[hash & (table->capacity - 1)];
+
+  for (freq_item_t *item = *bucket; item != NULL; item = item->next)
+  {
+    if (item->hash == hash && item->length == length &&
+        memcmp(item->key, key, length) == 0)
+    {
+      item->count += count;
+      return;
+    }
+  }
+
+  freq_item_t *item = malloc(sizeof(freq_item_t) + length + 1);
+  if (item == NULL)
+  {
+    return;
+  }
+  item->hash = hash;
+  item->count = count;
+  item->length = length;
+  memcpy(item->key, key, length);
+  item->key[length] = '\0';
+  item->next = *bucket;
+  *bucket = item;
+
+  if (++table->size > table->capacity)
+  {
+    freq_table_grow(table);
+  }
+}
+
+/*
+ * Inicializace počítadla.
+ *
+ * Pro n = 0 počítá slova, pro n = 1 až FREQ_MAX_NGRAM n-gramy znaků.
+ */
+void freq_init(freq_counter_t *counter, int n)
+{
+  if (n < 0 || n > FREQ_MAX_NGRAM)
+  {
+    n = 0;
+  }
+  counter->n = n;
+  counter->carry_length = 0;
+  counter->carry_hash = FREQ_HASH_INIT;
+  counter->window = 0;
+  counter->table.capacity = FREQ_INITIAL_CAPACITY;
+  counter->table.size = 0;
+  counter->table.buckets = calloc(FREQ_INITIAL_CAPACITY, sizeof(freq_item_t *));
+  if (counter->table.buckets == NULL)
+  {
+    counter->table.capacity = 0;
+  }
+}
+
+/* Převod znaku stejně jako v letter_count */
+static char freq_fold(char ch)
+{
+  if (ch >= 'A' && ch <= 'Z')
+  {
+    return ch + ('a' - 'A');
+  }
+  if ((ch >= 'a' && ch <= 'z') || ch == ' ')
+  {
+    return ch;
+  }
+  return '_';
+}
+
+/* Započítání slov v úseku */
+static void freq_feed_words(freq_counter_t *counter, const char *input,
+                            size_t length)
+{
+  for (size_t i = 0; i < length; i++)
+  {
+    char ch = freq_fold(input[i]);
+    if (ch != ' ' && ch != '_')
+    {
+      if (counter->carry_length < FREQ_MAX_WORD)
+      {
+        counter->carry[counter->carry_length++] = ch;
+        counter->carry_hash = freq_hash_step(counter->carry_hash, ch);
+      }
+    }
+    else if (counter->carry_length > 0)
+    {
+      freq_table_add(&counter->table, counter->carry, counter->carry_length,
+                     counter->carry_hash, 1);
+      counter->carry_length = 0;
+      counter->carry_hash = FREQ_HASH_INIT;
+    }
+  }
+}
+
+/* Započítání n-gramů v úseku */
+static void freq_feed_ngrams(freq_counter_t *counter, const char *input,
+                             size_t length)
+{
+  int n = counter->n;
+  uint64_t mask = n == 8 ? UINT64_MAX : (UINT64_C(1) << (8 * n)) - 1;
+  uint64_t window = counter->window;
+  char key[FREQ_MAX_NGRAM];
+
+  for (size_t i = 0; i < length; i++)
+  {
+    window = ((window << 8) | (unsigned char)freq_fold(input[i])) & mask;
+    if (counter->carry_length < n)
+    {
+      counter->carry_length++;
+    }
+    if (counter->carry_length == n)
+    {
+      for (int j = 0; j < n; j++)
+      {
+        key[j] = (char)(window >> (8 * (n - 1 - j)));
+      }
+      freq_table_add(&counter->table, key, n, freq_hash_window(window), 1);
+    }
+  }
+  counter->window = window;
+}
+
+/*
+ * Započítání dalšího úseku vstupu.
+ */
+void freq_feed(freq_counter_t *counter, const char *input, size_t length)
+{
+  if (counter->table.capacity == 0)
+  {
+    return;
+  }
+  if (counter->n == 0)
+  {
+    freq_feed_words(counter, input, length);
+  }
+  else
+  {
+    freq_feed_ngrams(counter, input, length);
+  }
+}
+
+/*
+ * Započítání celého vstupu ze souborového deskriptoru.
+ *
+ * Vstup se čte po úsecích velikosti FREQ_CHUNK_SIZE, takže může jít i o
+ * rouru. Vrací 0, nebo -1 při chybě čtení.
+ */
+int freq_feed_fd(freq_counter_t *counter, int fd)
+{
+  char *buffer = malloc(FREQ_CHUNK_SIZE);
+  int result = 0;
+
+  if (buffer == NULL)
+  {
+    return -1;
+  }
+  while (true)
+  {
+    ssize_t length = read(fd, buffer, FREQ_CHUNK_SIZE);
+    if (length > 0)
+    {
+      freq_feed(counter, buffer, length);
+    }
+    else if (length == 0)
+    {
+      break;
+    }
+    else if (errno != EINTR)
+    {
+      result = -1;
+      break;
+    }
+  }
+  free(buffer);
+  return result;
+}
+
+/*
+ * Ukončení vstupu — započítá rozpracované slovo.
+ */
+void freq_finish(freq_counter_t *counter)
+{
+  if (counter->n == 0 && counter->carry_length > 0)
+  {
+    freq_table_add(&counter->table, counter->carry, counter->carry_length,
+                   counter->carry_hash, 1);
+  }
+  counter->carry_length = 0;
+  counter->carry_hash = FREQ_HASH_INIT;
+  counter->window = 0;
+}
+
+/*
+ * Pomocná funkce pro uložení prvku do pole prvků.
+ */
+static void freq_add_item(freq_item_t *item, freq_items_t *items)
+{
+  if (items->capacity < items->size + 1)
+  {
+    items->capacity = items->capacity * 2 + 8;
+    items->items = realloc(items->items, items->capacity * sizeof(freq_item_t *));
+  }
+  items->items[items->size] = item;
+  items->size++;
+}
+
+static int freq_compare_keys(const void *a, const void *b)
+{
+  const freq_item_t *first = *(freq_item_t *const *)a;
+  const freq_item_t *second = *(freq_item_t *const *)b;
+  return strcmp(first->key, second->key);
+}
+
+/*
+ * Všechny prvky seřazené podle klíče.
+ *
+ * Prvky se přidají na konec pole items a zůstávají ve vlastnictví počítadla.
+ */
+void freq_sorted(freq_counter_t *counter, freq_items_t *items)
+{
+  int first = items->size;
+
+  for (size_t i = 0; i < counter->table.capacity; i++)
+  {
+    for (freq_item_t *item = counter->table.buckets[i]; item != NULL;
+         item = item->next)
+    {
+      freq_add_item(item, items);
+    }
+  }
+  qsort(items->items + first, items->size - first, sizeof(freq_item_t *),
+        freq_compare_keys);
+}
+
+/*
+ * Porovnání podle četnosti — vrací true, pokud je prvek a méně častý než b
+ * (při shodě rozhoduje pořadí klíčů, aby byl výsledek jednoznačný).
+ */
+static bool freq_less(const freq_item_t *a, const freq_item_t *b)
+{
+  if (a->count != b->count)
+  {
+    return a->count < b->count;
+  }
+  return strcmp(a->key, b->key) > 0;
+}
+
+/* Obnovení vlastnosti haldy směrem dolů od indexu index */
+static void freq_sift_down(freq_item_t **heap, int size, int index)
+{
+  while (true)
+  {
+    int smallest = index;
+    int left = 2 * index + 1;
+    int right = left + 1;
+    if (left < size && freq_less(heap[left], heap[smallest]))
+    {
+      smallest = left;
+    }
+    if (right < size && freq_less(heap[right], heap[smallest]))
+    {
+      smallest = right;
+    }
+    if (smallest == index)
+    {
+      return;
+    }
+    freq_item_t *swap = heap[index];
+    heap[index] = heap[smallest];
+    heap[smallest] = swap;
+    index = smallest;
+  }
+}
+
+/*
+ * Nejvýše k nejčastějších prvků seřazených sestupně podle četnosti.
+ *
+ * Prvky se vybírají pomocí haldy omezené na k prvků v čase O(n log k).
+ * Prvky se přidají na konec pole items a zůstávají ve vlastnictví počítadla.
+ */
+void freq_top(freq_counter_t *counter, int k, freq_items_t *items)
+{
+  freq_item_t **heap;
+  int size = 0;
+
+  if (k <= 0 || (heap = malloc(k * sizeof(freq_item_t *))) == NULL)
+  {
+    return;
+  }
+
+  for (size_t i = 0; i < counter->table.capacity; i++)
+  {
+    for (freq_item_t *item = counter->table.buckets[i]; item != NULL;
+         item = item->next)
+    {
+      if (size < k)
+      {
+        // Nový prvek probublá nahoru
+        int index = size++;
+        heap[index] = item;
+        while (index > 0 && freq_less(heap[index], heap[(index - 1) / 2]))
+        {
+          freq_item_t *swap = heap[index];
+          heap[index] = heap[(index - 1) / 2];
+          heap[(index - 1) / 2] = swap;
+          index = (index - 1) / 2;
+        }
+      }
+      else if (freq_less(heap[0], item))
+      {
+        heap[0] = item;
+        freq_sift_down(heap, size, 0);
+      }
+    }
+  }
+
+  // Odebíráním minima vznikne vzestupné pořadí, ukládáme ho odzadu
+  int first = items->size;
+  for (int i = 0; i < size; i++)
+  {
+    freq_add_item(NULL, items);
+  }
+  while (size > 0)
+  {
+    items->items[first + size - 1] = heap[0];
+    heap[0] = heap[--size];
+    freq_sift_down(heap, size, 0);
+  }
+  free(heap);
+}
+
+/*
+ * Zrušení počítadla a uvolnění všech prvků.
+ */
+void freq_dispose(freq_counter_t *counter)
+{
+  for (size_t i = 0; i < counter->table.capacity; i++)
+  {
+    freq_item_t *item = counter->table.buckets[i];
+    while (item != NULL)
+    {
+      freq_item_t *next = item->next;
+      free(item);
+      item = next;
+    }
+  }
+  free(counter->table.buckets);
+  counter->table.buckets = NULL;
+  counter->table.capacity = 0;
+  counter->table.size = 0;
+  counter->carry_length = 0;
+}
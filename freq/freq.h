@@ -0,0 +1,62 @@
+/*
+ * Hlavičkový soubor pro počítání frekvence slov a n-gramů.
+ */
+
+#ifndef IAL_FREQ_H
+#define IAL_FREQ_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Nejdelší započítané slovo, delší slova se zkrátí
+#define FREQ_MAX_WORD 64
+
+// Nejdelší podporovaný n-gram
+#define FREQ_MAX_NGRAM 8
+
+// Velikost úseku, po kterém se čte vstup ze souborového deskriptoru
+#define FREQ_CHUNK_SIZE (1 << 20)
+
+// Prvek tabulky
+typedef struct freq_item {
+  struct freq_item *next; // ukazatel na další synonymum
+  size_t hash;            // úplná hodnota rozptylovací funkce klíče
+  size_t count;           // počet výskytů
+  int length;             // délka klíče
+  char key[];             // klíč ukončený znakem '\0'
+} freq_item_t;
+
+// Tabulka s rozptýlenými položkami, jejíž velikost roste s počtem prvků
+typedef struct freq_table {
+  freq_item_t **buckets; // pole seznamů synonym
+  size_t capacity;       // počet seznamů, vždy mocnina dvou
+  size_t size;           // počet prvků
+} freq_table_t;
+
+// Počítadlo frekvence
+typedef struct freq_counter {
+  freq_table_t table;        // počty výskytů
+  int n;                     // délka n-gramu, 0 pro počítání slov
+  char carry[FREQ_MAX_WORD]; // rozpracované slovo
+  int carry_length;          // délka rozpracovaného slova nebo n-gramu
+  size_t carry_hash;         // rozptylovací funkce rozpracovaného slova
+  uint64_t window;           // posledních n znaků, jeden znak na bajt
+} freq_counter_t;
+
+// Pole prvků
+typedef struct freq_items {
+  freq_item_t **items; // pole prvků
+  int capacity;        // kapacita alokované paměti v počtu položek
+  int size;            // aktuální velikost pole v počtu položek
+} freq_items_t;
+
+void freq_init(freq_counter_t *counter, int n);
+void freq_feed(freq_counter_t *counter, const char *input, size_t length);
+int freq_feed_fd(freq_counter_t *counter, int fd);
+void freq_finish(freq_counter_t *counter);
+void freq_sorted(freq_counter_t *counter, freq_items_t *items);
+void freq_top(freq_counter_t *counter, int k, freq_items_t *items);
+void freq_dispose(freq_counter_t *counter);
+
+#endif
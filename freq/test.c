@@ -0,0 +1,74 @@
+#include "freq.h"
+#include "test_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+const char *TEST_TEXT = "The quick brown fox jumps over the lazy dog. "
+                        "The dog sleeps, the fox runs!";
+
+void init_test() {
+  printf("Frequency counter - testing script\n");
+  printf("----------------------------------\n");
+  printf("\n");
+}
+
+TEST(test_words_sorted, "Count words and list them sorted by key", 0)
+freq_feed_string(&test_counter, TEST_TEXT);
+freq_finish(&test_counter);
+freq_sorted(&test_counter, &test_items);
+ENDTEST
+
+TEST(test_words_top, "List the three most frequent words", 0)
+freq_feed_string(&test_counter, TEST_TEXT);
+freq_finish(&test_counter);
+freq_top(&test_counter, 3, &test_items);
+ENDTEST
+
+TEST(test_words_chunks, "Count words split across chunks", 0)
+const char *text = TEST_TEXT;
+size_t length = strlen(text);
+for (size_t i = 0; i < length; i += 7) {
+  freq_feed(&test_counter, text + i, length - i < 7 ? length - i : 7);
+}
+freq_finish(&test_counter);
+freq_top(&test_counter, 3, &test_items);
+ENDTEST
+
+TEST(test_bigrams_top, "List the five most frequent bigrams", 2)
+freq_feed_string(&test_counter, TEST_TEXT);
+freq_finish(&test_counter);
+freq_top(&test_counter, 5, &test_items);
+ENDTEST
+
+TEST(test_trigrams_chunks, "Count trigrams split across chunks", 3)
+freq_feed_string(&test_counter, "abcab");
+freq_feed_string(&test_counter, "cABC");
+freq_finish(&test_counter);
+freq_sorted(&test_counter, &test_items);
+ENDTEST
+
+TEST(test_words_grow, "Count many distinct words", 0)
+char word[8];
+for (int i = 0; i < 5000; i++) {
+  for (int j = 0; j < 4; j++) {
+    word[j] = 'a' + (i >> (j * 3)) % 8;
+  }
+  word[4] = ' ';
+  freq_feed(&test_counter, word, 5);
+}
+freq_finish(&test_counter);
+printf("Distinct words: %zu\n", test_counter.table.size);
+freq_top(&test_counter, 4, &test_items);
+ENDTEST
+
+int main(int argc, char *argv[]) {
+  init_test();
+
+  test_words_sorted();
+  test_words_top();
+  test_words_chunks();
+  test_bigrams_top();
+  test_trigrams_chunks();
+  test_words_grow();
+}
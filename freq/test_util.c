@@ -0,0 +1,15 @@
+#include "test_util.h"
+#include <stdio.h>
+#include <string.h>
+
+void freq_print_items(freq_items_t *items) {
+  printf("Items:\n");
+  for (int i = 0; i < items->size; i++) {
+    printf("(%s,%zu)", items->items[i]->key, items->items[i]->count);
+  }
+  printf("\n");
+}
+
+void freq_feed_string(freq_counter_t *counter, const char *input) {
+  freq_feed(counter, input, strlen(input));
+}
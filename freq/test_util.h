@@ -0,0 +1,25 @@
+#ifndef IAL_FREQ_TEST_UTIL_H
+#define IAL_FREQ_TEST_UTIL_H
+
+#include "freq.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TEST(NAME, DESCRIPTION, N)                                             \
+  void NAME() {                                                                \
+    printf("[%s] %s\n", #NAME, DESCRIPTION);                                   \
+    freq_counter_t test_counter;                                               \
+    freq_items_t test_items = {NULL, 0, 0};                                    \
+    freq_init(&test_counter, N);
+
+#define ENDTEST                                                                \
+  freq_print_items(&test_items);                                               \
+  printf("\n");                                                                \
+  free(test_items.items);                                                      \
+  freq_dispose(&test_counter);                                                 \
+  }
+
+void freq_print_items(freq_items_t *items);
+void freq_feed_string(freq_counter_t *counter, const char *input);
+
+#endif
@@ -0,0 +1,881 @@
+/*
+ * Měření výkonu tabulky s rozptýlenými položkami.
+ *
+ * Vkládání, vyhledávání a odstraňování se měří pro náhodné, seřazené
+ * a Zipfovy klíče z prostoru BENCH_KEY_SPACE řetězců s počtem operací od
+ * BENCH_MIN_OPS do max_operací (po násobcích deseti). Výstup je ve formátu
+ * CSV popsaném v common/bench.c. Tabulka s uspořádaným průchodem (ordered.c)
+ * se měří stejně a navíc průchodem přes prefix klíče. Cache (cache.c) pro
+ * čtvrtinu prostoru klíčů se měří vkládáním a získáváním hodnot; podíl
+ * úspěšných získání se vypisuje na standardní chybový výstup. Tabulka
+ * s klíči ze společného úložiště řetězců (interned.c) se měří vkládáním
+ * a vyhledáváním podle předem uložených klíčů. Počítání výskytů klíčů se
+ * měří dvojicí ht_get a ht_insert a jedním voláním ht_upsert (upsert.c).
+ *
+ * Režim latency měří rozložení doby jednotlivých vyhledání v zřetězené
+ * tabulce (HT_SIZE = MAX_HT_SIZE) a v tabulce s kukaččím hashováním
+ * (cuckoo.c) při různém zaplnění. Vypisuje tabulku latencí z common/bench.c.
+ *
+ * Režim frozen měří pro frozen_keys klíčů sestavení neměnné tabulky
+ * (frozen.c) a rozložení doby vyhledání v ní a v zřetězené tabulce. Doba
+ * sestavení na klíč, paměť na klíč a bity metadat na klíč se vypisují na
+ * standardní chybový výstup.
+ *
+ * Režim bloom měří pro bloom_keys klíčů rozložení doby vyhledání
+ * existujících a chybějících klíčů v zřetězené tabulce a v tabulce
+ * s Bloomovým filtrem (bloom.c). Podíl falešně pozitivních odpovědí filtru
+ * se vypisuje na standardní chybový výstup, a to i po odstranění tří
+ * čtvrtin klíčů.
+ *
+ * Režim sharded porovnává tabulku chráněnou jedním zámkem s tabulkou
+ * rozdělenou na úseky (sharded.c) pro 1, 2, 4, ... max_vláken vláken.
+ * Rozdělená tabulka má tolik úseků, kolik je zadávajících vláken, a ta
+ * posílají požadavky po dávkách HT_SHARDED_BATCH.
+ *
+ * Použití: ./bench [max_operací]
+ *          ./bench latency [počet_vyhledání]
+ *          ./bench frozen [počet_vyhledání]
+ *          ./bench bloom [počet_vyhledání]
+ *          ./bench sharded [max_vláken] [operací]
+ */
+
+#include "../common/bench.h"
+#include "bloom.h"
+#include "cache.h"
+#include "cuckoo.h"
+#include "frozen.h"
+#include "hashtable.h"
+#include "interned.h"
+#include "ordered.h"
+#include "sharded.h"
+#include "upsert.h"
+#include <pthread.h>
+#include "perf.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Počet různých klíčů
+#define BENCH_KEY_SPACE 1024
+
+// Počet odstranění, po kterých se odstraněné klíče vrátí do tabulky
+#define DELETE_BATCH 256
+
+// Výchozí počet měřených vyhledání v režimu latency
+#define LATENCY_SAMPLES 200000
+
+// Počty míst tabulky s kukaččím hashováním a jejich cílová zaplnění
+static const long latency_slots[] = {1024, 8192};
+static const double latency_loads[] = {0.5, 0.9, 0.95};
+
+// Počty klíčů neměnné tabulky v režimu frozen
+static const long frozen_keys[] = {1024, 16384, 65536};
+
+// Počty klíčů tabulky s filtrem v režimu bloom
+static const long bloom_keys[] = {1024, 16384};
+
+// Výchozí počet vláken a operací v režimu sharded
+#define SHARDED_THREADS 4
+#define SHARDED_OPS 400000L
+
+// Řetězcové klíče
+static char key_names[BENCH_KEY_SPACE][16];
+
+/*
+ * Vkládání, vyhledávání a odstraňování pro ops klíčů s rozdělením
+ * distribution.
+ */
+static void bench_table_operations(bench_distribution_t distribution, long ops)
+{
+  const char *name = bench_distribution_name(distribution);
+  int *keys = malloc(ops * sizeof(int));
+  ht_table_t *table = malloc(sizeof(ht_table_t));
+  long hits = 0;
+
+  bench_keys(distribution, keys, ops, BENCH_KEY_SPACE,
+             2463534242u + distribution);
+
+  ht_init(table);
+  double start = bench_now_ns();
+  for (long i = 0; i < ops; i++)
+  {
+    ht_insert(table, key_names[keys[i]], (float)i);
+  }
+  bench_report("insert", name, 1, ops, BENCH_KEY_SPACE,
+               bench_now_ns() - start);
+
+  start = bench_now_ns();
+  for (long i = 0; i < ops; i++)
+  {
+    hits += ht_search(table, key_names[keys[i]]) != NULL;
+  }
+  bench_report("search", name, 1, ops, BENCH_KEY_SPACE,
+               bench_now_ns() - start);
+
+  start = bench_now_ns();
+  for (long i = 0; i < ops; i++)
+  {
+    hits -= ht_get(table, key_names[keys[i]]) != NULL;
+  }
+  bench_report("get", name, 1, ops, BENCH_KEY_SPACE, bench_now_ns() - start);
+
+  double elapsed = 0;
+  for (long batch = 0; batch < ops; batch += DELETE_BATCH)
+  {
+    long end = batch + DELETE_BATCH < ops ? batch + DELETE_BATCH : ops;
+    start = bench_now_ns();
+    for (long i = batch; i < end; i++)
+    {
+      ht_delete(table, key_names[keys[i]]);
+    }
+    elapsed += bench_now_ns() - start;
+    for (long i = batch; i < end; i++)
+    {
+      ht_insert(table, key_names[keys[i]], (float)i);
+    }
+  }
+  bench_report("delete", name, 1, ops, BENCH_KEY_SPACE, elapsed);
+
+  if (hits != 0)
+  {
+    fprintf(stderr, "[W] Search and get disagree\n");
+  }
+  ht_delete_all(table);
+  free(table);
+  free(keys);
+}
+
+/*
+ * Vkládání, vyhledávání, průchod přes prefix a odstraňování v tabulce
+ * s uspořádaným průchodem.
+ */
+static void bench_ordered_operations(bench_distribution_t distribution,
+                                     long ops)
+{
+  const char *name = bench_distribution_name(distribution);
+  int *keys = malloc(ops * sizeof(int));
+  ht_ordered_t *ordered = malloc(sizeof(ht_ordered_t));
+  ht_ordered_iter_t iter;
+  long visited = 0;
+
+  bench_keys(distribution, keys, ops, BENCH_KEY_SPACE,
+             2463534242u + distribution);
+
+  ht_ordered_init(ordered);
+  double start = bench_now_ns();
+  for (long i = 0; i < ops; i++)
+  {
+    ht_ordered_insert(ordered, key_names[keys[i]], (float)i);
+  }
+  bench_report("ordered_insert", name, 1, ops, BENCH_KEY_SPACE,
+               bench_now_ns() - start);
+
+  start = bench_now_ns();
+  for (long i = 0; i < ops; i++)
+  {
+    visited += ht_ordered_search(ordered, key_names[keys[i]]) != NULL;
+  }
+  bench_report("ordered_search", name, 1, ops, BENCH_KEY_SPACE,
+               bench_now_ns() - start);
+
+  start = bench_now_ns();
+  for (long i = 0; i < ops; i++)
+  {
+    ht_ordered_prefix(ordered, &iter, key_names[keys[i]]);
+    while (ht_ordered_next(&iter) != NULL)
+    {
+      visited--;
+    }
+  }
+  bench_report("ordered_prefix", name, 1, ops, BENCH_KEY_SPACE,
+               bench_now_ns() - start);
+
+  double elapsed = 0;
+  for (long batch = 0; batch < ops; batch += DELETE_BATCH)
+  {
+    long end = batch + DELETE_BATCH < ops ? batch + DELETE_BATCH : ops;
+    start = bench_now_ns();
+    for (long i = batch; i < end; i++)
+    {
+      ht_ordered_delete(ordered, key_names[keys[i]]);
+    }
+    elapsed += bench_now_ns() - start;
+    for (long i = batch; i < end; i++)
+    {
+      ht_ordered_insert(ordered, key_names[keys[i]], (float)i);
+    }
+  }
+  bench_report("ordered_delete", name, 1, ops, BENCH_KEY_SPACE, elapsed);
+
+  if (visited > 0)
+  {
+    fprintf(stderr, "[W] Prefix scan missed searched keys\n");
+  }
+  ht_ordered_delete_all(ordered);
+  free(ordered);
+  free(keys);
+}
+
+/*
+ * Vkládání a získávání hodnot v cache pro čtvrtinu prostoru klíčů.
+ */
+static void bench_cache_operations(bench_distribution_t distribution, long ops)
+{
+  const char *name = bench_distribution_name(distribution);
+  int *keys = malloc(ops * sizeof(int));
+  ht_cache_t *cache = malloc(sizeof(ht_cache_t));
+
+  bench_keys(distribution, keys, ops, BENCH_KEY_SPACE,
+             2463534242u + distribution);
+
+  ht_cache_init(cache, BENCH_KEY_SPACE / 4, 0);
+  double start = bench_now_ns();
+  for (long i = 0; i < ops; i++)
+  {
+    ht_cache_insert(cache, key_names[keys[i]], (float)i);
+  }
+  bench_report("cache_insert", name, 1, ops, BENCH_KEY_SPACE,
+               bench_now_ns() - start);
+
+  start = bench_now_ns();
+  for (long i = 0; i < ops; i++)
+  {
+    if (ht_cache_get(cache, key_names[keys[i]]) == NULL)
+    {
+      ht_cache_insert(cache, key_names[keys[i]], (float)i);
+    }
+  }
+  bench_report("cache_get", name, 1, ops, BENCH_KEY_SPACE,
+               bench_now_ns() - start);
+  fprintf(stderr, "cache,%s,%ld,hit_rate=%.3f,evictions=%llu\n", name, ops,
+          ht_cache_hit_rate(cache),
+          (unsigned long long)cache->stats.evictions);
+
+  ht_cache_delete_all(cache);
+  free(cache);
+  free(keys);
+}
+
+/*
+ * Vkládání a vyhledávání v tabulce s klíči ze společného úložiště řetězců.
+ */
+static void bench_interned_operations(bench_distribution_t distribution,
+                                      long ops)
+{
+  const char *name = bench_distribution_name(distribution);
+  int *keys = malloc(ops * sizeof(int));
+  ht_table_t *table = malloc(sizeof(ht_table_t));
+  intern_pool_t pool;
+  const char *handles[BENCH_KEY_SPACE];
+  long hits = 0;
+
+  bench_keys(distribution, keys, ops, BENCH_KEY_SPACE,
+             2463534242u + distribution);
+  intern_init(&pool);
+  for (int i = 0; i < BENCH_KEY_SPACE; i++)
+  {
+    handles[i] = intern(&pool, key_names[i]);
+  }
+
+  ht_init(table);
+  double start = bench_now_ns();
+  for (long i = 0; i < ops; i++)
+  {
+    ht_interned_insert(table, handles[keys[i]], (float)i);
+  }
+  bench_report("interned_insert", name, 1, ops, BENCH_KEY_SPACE,
+               bench_now_ns() - start);
+
+  start = bench_now_ns();
+  for (long i = 0; i < ops; i++)
+  {
+    hits += ht_interned_search(table, handles[keys[i]]) != NULL;
+  }
+  bench_report("interned_search", name, 1, ops, BENCH_KEY_SPACE,
+               bench_now_ns() - start);
+
+  if (hits != ops)
+  {
+    fprintf(stderr, "[W] Interned search missed inserted keys\n");
+  }
+  ht_interned_delete_all(table);
+  intern_dispose(&pool);
+  free(table);
+  free(keys);
+}
+
+/* Přičtení jedničky k počtu výskytů */
+static float bench_increment(float value)
+{
+  return value + 1;
+}
+
+/*
+ * Počítání výskytů klíčů dvojicí ht_get a ht_insert a funkcí ht_upsert.
+ */
+static void bench_count_operations(bench_distribution_t distribution,
+                                   long ops)
+{
+  const char *name = bench_distribution_name(distribution);
+  int *keys = malloc(ops * sizeof(int));
+  ht_table_t *table = malloc(sizeof(ht_table_t));
+  float total = 0;
+
+  bench_keys(distribution, keys, ops, BENCH_KEY_SPACE,
+             2463534242u + distribution);
+
+  ht_init(table);
+  double start = bench_now_ns();
+  for (long i = 0; i < ops; i++)
+  {
+    float *count = ht_get(table, key_names[keys[i]]);
+    ht_insert(table, key_names[keys[i]], count != NULL ? *count + 1 : 1);
+  }
+  bench_report("count_get_insert", name, 1, ops, BENCH_KEY_SPACE,
+               bench_now_ns() - start);
+  for (int i = 0; i < BENCH_KEY_SPACE; i++)
+  {
+    float *count = ht_get(table, key_names[i]);
+    total -= count != NULL ? *count : 0;
+  }
+  ht_delete_all(table);
+
+  start = bench_now_ns();
+  for (long i = 0; i < ops; i++)
+  {
+    ht_upsert(table, key_names[keys[i]], 1, bench_increment);
+  }
+  bench_report("count_upsert", name, 1, ops, BENCH_KEY_SPACE,
+               bench_now_ns() - start);
+  for (int i = 0; i < BENCH_KEY_SPACE; i++)
+  {
+    float *count = ht_get(table, key_names[i]);
+    total += count != NULL ? *count : 0;
+  }
+
+  if (total != 0)
+  {
+    fprintf(stderr, "[W] Get and insert and upsert counts disagree\n");
+  }
+  ht_delete_all(table);
+  free(table);
+  free(keys);
+}
+
+/*
+ * Doby samples vyhledání klíčů keys[] v obou tabulkách. Klíče z names[0]
+ * až names[count - 1] jsou v tabulkách, ostatní ne.
+ */
+static void bench_latency_lookups(const char *operation, ht_table_t *table,
+                                  ht_cuckoo_t *cuckoo, char (*names)[16],
+                                  long count, int keys[], double samples[],
+                                  long sample_count)
+{
+  long found = 0;
+
+  for (long i = 0; i < sample_count; i++)
+  {
+    double start = bench_now_ns();
+    found += ht_search(table, names[keys[i]]) != NULL;
+    samples[i] = bench_now_ns() - start;
+  }
+  bench_latency_report(operation, "chained", count, (double)count / HT_SIZE,
+                       samples, sample_count);
+
+  for (long i = 0; i < sample_count; i++)
+  {
+    double start = bench_now_ns();
+    found -= ht_cuckoo_search(cuckoo, names[keys[i]]) != NULL;
+    samples[i] = bench_now_ns() - start;
+  }
+  bench_latency_report(operation, "cuckoo", count,
+                       ht_cuckoo_load_factor(cuckoo), samples, sample_count);
+
+  if (found != 0)
+  {
+    fprintf(stderr, "[W] Chained and cuckoo tables disagree\n");
+  }
+}
+
+/*
+ * Percentily doby vyhledání existujících i chybějících klíčů při
+ * zaplnění latency_loads tabulky s kukaččím hashováním.
+ */
+static void bench_latency(long sample_count)
+{
+  long max_count = latency_slots[sizeof(latency_slots) /
+                                 sizeof(latency_slots[0]) - 1];
+  char (*names)[16] = malloc(2 * max_count * sizeof(names[0]));
+  int *keys = malloc(sample_count * sizeof(int));
+  double *samples = malloc(sample_count * sizeof(double));
+  ht_table_t *table = malloc(sizeof(ht_table_t));
+  ht_cuckoo_t cuckoo;
+  uint64_t state = 2463534242u;
+
+  HT_SIZE = MAX_HT_SIZE;
+  for (long i = 0; i < 2 * max_count; i++)
+  {
+    snprintf(names[i], sizeof(names[i]), "%s%ld", i % 2 ? "miss" : "key",
+             i / 2);
+  }
+
+  for (long i = 0; i < sample_count; i++)
+  {
+    double start = bench_now_ns();
+    samples[i] = bench_now_ns() - start;
+  }
+  bench_latency_header();
+  bench_latency_report("clock", "-", 0, 0, samples, sample_count);
+
+  for (size_t s = 0; s < sizeof(latency_slots) / sizeof(latency_slots[0]);
+       s++)
+  {
+    for (size_t l = 0; l < sizeof(latency_loads) / sizeof(latency_loads[0]);
+         l++)
+    {
+      long count = (long)(latency_slots[s] * latency_loads[l]);
+
+      ht_init(table);
+      ht_cuckoo_init(&cuckoo);
+      ht_cuckoo_reserve(&cuckoo, latency_slots[s]);
+      for (long i = 0; i < count; i++)
+      {
+        ht_insert(table, names[2 * i], (float)i);
+        ht_cuckoo_insert(&cuckoo, names[2 * i], (float)i);
+      }
+
+      for (long i = 0; i < sample_count; i++)
+      {
+        keys[i] = 2 * (bench_random(&state) % count);
+      }
+      bench_latency_lookups("search_hit", table, &cuckoo, names, count, keys,
+                            samples, sample_count);
+      for (long i = 0; i < sample_count; i++)
+      {
+        keys[i]++;
+      }
+      bench_latency_lookups("search_miss", table, &cuckoo, names, count,
+                            keys, samples, sample_count);
+
+      ht_delete_all(table);
+      ht_cuckoo_delete_all(&cuckoo);
+    }
+  }
+
+  free(table);
+  free(samples);
+  free(keys);
+  free(names);
+}
+
+/*
+ * Doby samples vyhledání klíčů keys[] v zřetězené a neměnné tabulce.
+ */
+static void bench_frozen_lookups(const char *operation, ht_table_t *table,
+                                 ht_frozen_t *frozen, char (*names)[16],
+                                 int keys[], double samples[],
+                                 long sample_count)
+{
+  long found = 0;
+
+  for (long i = 0; i < sample_count; i++)
+  {
+    double start = bench_now_ns();
+    found += ht_get(table, names[keys[i]]) != NULL;
+    samples[i] = bench_now_ns() - start;
+  }
+  bench_latency_report(operation, "chained", frozen->size,
+                       (double)frozen->size / HT_SIZE, samples, sample_count);
+
+  for (long i = 0; i < sample_count; i++)
+  {
+    double start = bench_now_ns();
+    found -= ht_frozen_get(frozen, names[keys[i]]) != NULL;
+    samples[i] = bench_now_ns() - start;
+  }
+  bench_latency_report(operation, "frozen", frozen->size,
+                       (double)frozen->size / frozen->slots, samples,
+                       sample_count);
+
+  if (found != 0)
+  {
+    fprintf(stderr, "[W] Chained and frozen tables disagree\n");
+  }
+}
+
+/*
+ * Sestavení neměnné tabulky a percentily doby vyhledání pro frozen_keys
+ * klíčů. Paměť zřetězené tabulky počítá prvky, klíče a pole seznamů bez
+ * režie alokátoru.
+ */
+static void bench_frozen(long sample_count)
+{
+  long max_count = frozen_keys[sizeof(frozen_keys) /
+                               sizeof(frozen_keys[0]) - 1];
+  char (*names)[16] = malloc(2 * max_count * sizeof(names[0]));
+  int *keys = malloc(sample_count * sizeof(int));
+  double *samples = malloc(sample_count * sizeof(double));
+  ht_table_t *table = malloc(sizeof(ht_table_t));
+  ht_frozen_t frozen;
+  uint64_t state = 88172645463325252u;
+
+  HT_SIZE = MAX_HT_SIZE;
+  for (long i = 0; i < 2 * max_count; i++)
+  {
+    snprintf(names[i], sizeof(names[i]), "%s%ld", i % 2 ? "miss" : "key",
+             i / 2);
+  }
+
+  bench_latency_header();
+  for (size_t k = 0; k < sizeof(frozen_keys) / sizeof(frozen_keys[0]); k++)
+  {
+    long count = frozen_keys[k];
+    size_t chained_bytes = sizeof(ht_table_t);
+
+    ht_init(table);
+    for (long i = 0; i < count; i++)
+    {
+      ht_insert(table, names[2 * i], (float)i);
+      chained_bytes += sizeof(ht_item_t) + strlen(names[2 * i]) + 1;
+    }
+
+    double start = bench_now_ns();
+    if (!ht_freeze(table, &frozen))
+    {
+      fprintf(stderr, "[E] Freezing %ld keys failed\n", count);
+      ht_delete_all(table);
+      break;
+    }
+    double elapsed = bench_now_ns() - start;
+    fprintf(stderr,
+            "frozen,%ld,build_ns_per_key=%.1f,bytes_per_key=%.2f,"
+            "metadata_bits_per_key=%.2f,chained_bytes_per_key=%.2f\n",
+            count, elapsed / count, (double)ht_frozen_bytes(&frozen) / count,
+            ht_frozen_metadata_bits(&frozen), (double)chained_bytes / count);
+
+    for (long i = 0; i < sample_count; i++)
+    {
+      keys[i] = 2 * (bench_random(&state) % count);
+    }
+    bench_frozen_lookups("get_hit", table, &frozen, names, keys, samples,
+                         sample_count);
+    for (long i = 0; i < sample_count; i++)
+    {
+      keys[i]++;
+    }
+    bench_frozen_lookups("get_miss", table, &frozen, names, keys, samples,
+                         sample_count);
+
+    ht_frozen_dispose(&frozen);
+    ht_delete_all(table);
+  }
+
+  free(table);
+  free(samples);
+  free(keys);
+  free(names);
+}
+
+/*
+ * Doby samples vyhledání klíčů keys[] v zřetězené tabulce a v tabulce
+ * s filtrem.
+ */
+static void bench_bloom_lookups(const char *operation, ht_table_t *table,
+                                ht_bloom_t *bloom, char (*names)[16],
+                                int keys[], double samples[],
+                                long sample_count)
+{
+  long found = 0;
+
+  for (long i = 0; i < sample_count; i++)
+  {
+    double start = bench_now_ns();
+    found += ht_search(table, names[keys[i]]) != NULL;
+    samples[i] = bench_now_ns() - start;
+  }
+  bench_latency_report(operation, "chained", bloom->size,
+                       (double)bloom->size / HT_SIZE, samples, sample_count);
+
+  for (long i = 0; i < sample_count; i++)
+  {
+    double start = bench_now_ns();
+    found -= ht_bloom_search(bloom, names[keys[i]]) != NULL;
+    samples[i] = bench_now_ns() - start;
+  }
+  bench_latency_report(operation, "bloom", bloom->size,
+                       (double)bloom->size / HT_SIZE, samples, sample_count);
+
+  if (found != 0)
+  {
+    fprintf(stderr, "[W] Chained and bloom tables disagree\n");
+  }
+}
+
+/* Podíl falešně pozitivních odpovědí filtru na standardní chybový výstup */
+static void bench_bloom_report(ht_bloom_t *bloom, const char *phase)
+{
+  fprintf(stderr,
+          "bloom,%zu,%s,false_positive_rate=%.4f,bits_per_key=%.2f,"
+          "rebuilds=%llu\n",
+          bloom->size, phase, ht_bloom_false_positive_rate(bloom),
+          bloom->size > 0 ? 512.0 * bloom->block_count / bloom->size : 0,
+          (unsigned long long)bloom->stats.rebuilds);
+}
+
+/*
+ * Percentily doby vyhledání v tabulce s filtrem pro bloom_keys klíčů před
+ * odstraněním tří čtvrtin klíčů a po něm.
+ */
+static void bench_bloom(long sample_count)
+{
+  long max_count = bloom_keys[sizeof(bloom_keys) / sizeof(bloom_keys[0]) - 1];
+  char (*names)[16] = malloc(2 * max_count * sizeof(names[0]));
+  int *keys = malloc(sample_count * sizeof(int));
+  double *samples = malloc(sample_count * sizeof(double));
+  ht_table_t *table = malloc(sizeof(ht_table_t));
+  ht_bloom_t *bloom = malloc(sizeof(ht_bloom_t));
+  uint64_t state = 2463534242u;
+
+  HT_SIZE = MAX_HT_SIZE;
+  for (long i = 0; i < 2 * max_count; i++)
+  {
+    snprintf(names[i], sizeof(names[i]), "%s%ld", i % 2 ? "miss" : "key",
+             i / 2);
+  }
+
+  bench_latency_header();
+  for (size_t k = 0; k < sizeof(bloom_keys) / sizeof(bloom_keys[0]); k++)
+  {
+    long count = bloom_keys[k];
+
+    ht_init(table);
+    ht_bloom_init(bloom);
+    for (long i = 0; i < count; i++)
+    {
+      ht_insert(table, names[2 * i], (float)i);
+      ht_bloom_insert(bloom, names[2 * i], (float)i);
+    }
+
+    for (int phase = 0; phase < 2; phase++)
+    {
+      long live = phase == 0 ? count : count / 4;
+      for (long i = 0; i < sample_count; i++)
+      {
+        keys[i] = 2 * (bench_random(&state) % live);
+      }
+      bench_bloom_lookups(phase == 0 ? "search_hit" : "search_hit_deleted",
+                          table, bloom, names, keys, samples, sample_count);
+      for (long i = 0; i < sample_count; i++)
+      {
+        keys[i]++;
+      }
+      bloom->stats.rejected = 0;
+      bloom->stats.passed = 0;
+      bloom->stats.false_positives = 0;
+      bench_bloom_lookups(phase == 0 ? "search_miss" : "search_miss_deleted",
+                          table, bloom, names, keys, samples, sample_count);
+      bench_bloom_report(bloom, phase == 0 ? "full" : "deleted");
+
+      for (long i = count / 4; phase == 0 && i < count; i++)
+      {
+        ht_delete(table, names[2 * i]);
+        ht_bloom_delete(bloom, names[2 * i]);
+      }
+    }
+
+    ht_delete_all(table);
+    ht_bloom_delete_all(bloom);
+  }
+
+  free(bloom);
+  free(table);
+  free(samples);
+  free(keys);
+  free(names);
+}
+
+// Práce jednoho vlákna v režimu sharded
+typedef struct bench_worker {
+  pthread_t thread;           // vlákno
+  ht_table_t *table;          // tabulka se zámkem, nebo NULL
+  pthread_mutex_t *lock;      // zámek tabulky
+  ht_sharded_t *sharded;      // rozdělená tabulka, nebo NULL
+  ht_sharded_op_t op;         // prováděná operace
+  int *keys;                  // klíče vlákna
+  long ops;                   // počet operací
+} bench_worker_t;
+
+/* Operace nad tabulkou s jedním zámkem */
+static void *bench_locked_worker(void *argument)
+{
+  bench_worker_t *worker = argument;
+
+  for (long i = 0; i < worker->ops; i++)
+  {
+    char *key = key_names[worker->keys[i]];
+    pthread_mutex_lock(worker->lock);
+    if (worker->op == HT_SHARDED_INSERT)
+    {
+      ht_insert(worker->table, key, (float)i);
+    }
+    else
+    {
+      ht_get(worker->table, key);
+    }
+    pthread_mutex_unlock(worker->lock);
+  }
+  return NULL;
+}
+
+/* Operace nad rozdělenou tabulkou po dávkách */
+static void *bench_sharded_worker(void *argument)
+{
+  bench_worker_t *worker = argument;
+  ht_sharded_request_t batch[HT_SHARDED_BATCH];
+
+  for (long i = 0; i < worker->ops; i += HT_SHARDED_BATCH)
+  {
+    int count = 0;
+    for (; count < HT_SHARDED_BATCH && i + count < worker->ops; count++)
+    {
+      batch[count].op = worker->op;
+      batch[count].key = key_names[worker->keys[i + count]];
+      batch[count].value = (float)(i + count);
+    }
+    ht_sharded_submit(worker->sharded, batch, count);
+  }
+  return NULL;
+}
+
+/*
+ * Spuštění threads vláken, která celkem provedou ops operací op, vrací
+ * dobu do jejich dokončení v ns.
+ */
+static double bench_run_workers(bench_worker_t workers[], int threads,
+                                ht_sharded_op_t op, int *keys, long ops)
+{
+  double start = bench_now_ns();
+
+  for (int t = 0; t < threads; t++)
+  {
+    workers[t].op = op;
+    workers[t].keys = keys + ops / threads * t;
+    workers[t].ops = t == threads - 1 ? ops - ops / threads * t
+                                      : ops / threads;
+    pthread_create(&workers[t].thread, NULL,
+                   workers[t].sharded != NULL ? bench_sharded_worker
+                                              : bench_locked_worker,
+                   &workers[t]);
+  }
+  for (int t = 0; t < threads; t++)
+  {
+    pthread_join(workers[t].thread, NULL);
+  }
+  return bench_now_ns() - start;
+}
+
+/*
+ * Vkládání a získávání hodnot v tabulce s jedním zámkem a v rozdělené
+ * tabulce pro 1 až max_threads vláken.
+ */
+static void bench_sharded(int max_threads, long ops)
+{
+  int *keys = malloc(ops * sizeof(int));
+  bench_worker_t *workers = malloc(max_threads * sizeof(bench_worker_t));
+  ht_table_t *table = malloc(sizeof(ht_table_t));
+  pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+  ht_sharded_t sharded;
+
+  bench_keys(BENCH_RANDOM, keys, ops, BENCH_KEY_SPACE, 2463534242u);
+  bench_header();
+  for (int threads = 1; threads <= max_threads; threads *= 2)
+  {
+    ht_init(table);
+    for (int t = 0; t < threads; t++)
+    {
+      workers[t].table = table;
+      workers[t].lock = &lock;
+      workers[t].sharded = NULL;
+    }
+    bench_report("locked_insert", "random", threads, ops, BENCH_KEY_SPACE,
+                 bench_run_workers(workers, threads, HT_SHARDED_INSERT, keys,
+                                   ops));
+    bench_report("locked_get", "random", threads, ops, BENCH_KEY_SPACE,
+                 bench_run_workers(workers, threads, HT_SHARDED_GET, keys,
+                                   ops));
+    ht_delete_all(table);
+
+    if (!ht_sharded_init(&sharded, threads))
+    {
+      fprintf(stderr, "[W] Cannot start %d shards\n", threads);
+      break;
+    }
+    for (int t = 0; t < threads; t++)
+    {
+      workers[t].sharded = &sharded;
+    }
+    bench_report("sharded_insert", "random", threads, ops, BENCH_KEY_SPACE,
+                 bench_run_workers(workers, threads, HT_SHARDED_INSERT, keys,
+                                   ops));
+    bench_report("sharded_get", "random", threads, ops, BENCH_KEY_SPACE,
+                 bench_run_workers(workers, threads, HT_SHARDED_GET, keys,
+                                   ops));
+    ht_sharded_dispose(&sharded);
+  }
+
+  free(table);
+  free(workers);
+  free(keys);
+}
+
+int main(int argc, char *argv[])
+{
+  if (argc > 1 && strcmp(argv[1], "latency") == 0)
+  {
+    bench_latency(argc > 2 ? atol(argv[2]) : LATENCY_SAMPLES);
+    HT_PERF_REPORT(stderr);
+    return 0;
+  }
+  if (argc > 1 && strcmp(argv[1], "bloom") == 0)
+  {
+    bench_bloom(argc > 2 ? atol(argv[2]) : LATENCY_SAMPLES);
+    HT_PERF_REPORT(stderr);
+    return 0;
+  }
+  if (argc > 1 && strcmp(argv[1], "frozen") == 0)
+  {
+    bench_frozen(argc > 2 ? atol(argv[2]) : LATENCY_SAMPLES);
+    HT_PERF_REPORT(stderr);
+    return 0;
+  }
+
+  for (int i = 0; i < BENCH_KEY_SPACE; i++)
+  {
+    snprintf(key_names[i], sizeof(key_names[i]), "key%d", i);
+  }
+  if (argc > 1 && strcmp(argv[1], "sharded") == 0)
+  {
+    bench_sharded(argc > 2 ? atoi(argv[2]) : SHARDED_THREADS,
+                  argc > 3 ? atol(argv[3]) : SHARDED_OPS);
+    HT_PERF_REPORT(stderr);
+    return 0;
+  }
+
+  long max_ops = argc > 1 ? atol(argv[1]) : BENCH_DEFAULT_MAX_OPS;
+
+  bench_header();
+  for (int distribution = 0; distribution < BENCH_DISTRIBUTIONS;
+       distribution++)
+  {
+    for (long ops = BENCH_MIN_OPS; ops <= max_ops; ops *= 10)
+    {
+      bench_table_operations(distribution, ops);
+      bench_ordered_operations(distribution, ops);
+      bench_cache_operations(distribution, ops);
+      bench_interned_operations(distribution, ops);
+      bench_count_operations(distribution, ops);
+    }
+  }
+  HT_PERF_REPORT(stderr);
+  return 0;
+}
@@ -0,0 +1,242 @@
+/*
+ * Tabulka s rozptýlenými položkami s blokovým Bloomovým filtrem
+ *
+ * Před seznamy synonym obyčejné ht_table_t stojí Bloomův filtr rozdělený na
+ * bloky o velikosti řádku cache. Klíč nastaví HT_BLOOM_HASHES bitů v jediném
+ * bloku, takže vyhledání chybějícího klíče filtr většinou zamítne po čtení
+ * jednoho řádku, bez průchodu seznamem a bez strcmp. Filtr používá
+ * 64bitovou rozptylovací funkci ht_hash64 (hash.h) nezávislou na get_hash.
+ *
+ * Z Bloomova filtru nelze klíč odstranit. Odstraněné klíče ve filtru zůstanou
+ * (jen zvyšují podíl falešně pozitivních odpovědí) a jakmile jich je víc než
+ * HT_BLOOM_STALE_PERCENT % prvků v tabulce, filtr se přestaví z prvků
+ * tabulky. Přestaví se také, když počet prvků překročí kapacitu filtru. Nový
+ * filtr má vždy místo pro dvojnásobek prvků. Pokud se paměť pro nový filtr
+ * nepodaří alokovat, zůstane původní, který je stále správný, jen méně
+ * přesný.
+ */
+
+#include "bloom.h"
+#include "hash.h"
+#include "upsert.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Počet bitů bloku
+#define BLOOM_BLOCK_BITS 512
+
+/* Blok klíče s hashem hash */
+static ht_bloom_block_t *bloom_block(ht_bloom_block_t *blocks,
+                                     size_t block_count, uint64_t hash)
+{
+  return &blocks[((hash >> 32) * block_count) >> 32];
+}
+
+/*
+ * Nastavení bitů klíče. Bity se berou po devíti z druhého promíchání hashe,
+ * aby nezávisely na bitech určujících blok.
+ */
+static void bloom_add(ht_bloom_block_t *blocks, size_t block_count,
+                      uint64_t hash)
+{
+  ht_bloom_block_t *block = bloom_block(blocks, block_count, hash);
+  uint64_t bits = ht_mix64(hash + 0x9e3779b97f4a7c15u);
+
+  for (int i = 0; i < HT_BLOOM_HASHES; i++, bits >>= 9)
+  {
+    block->words[(bits >> 6) & 7] |= (uint64_t)1 << (bits & 63);
+  }
+}
+
+/* Test, zda klíč může být v tabulce */
+static bool bloom_may_contain(ht_bloom_t *bloom, const char *key)
+{
+  if (bloom->blocks == NULL)
+  {
+    return bloom->size > 0;
+  }
+
+  uint64_t hash = ht_hash64(key, 0);
+  ht_bloom_block_t *block = bloom_block(bloom->blocks, bloom->block_count,
+                                        hash);
+  uint64_t bits = ht_mix64(hash + 0x9e3779b97f4a7c15u);
+  uint64_t missing = 0;
+
+  for (int i = 0; i < HT_BLOOM_HASHES; i++, bits >>= 9)
+  {
+    missing |= ~block->words[(bits >> 6) & 7] & ((uint64_t)1 << (bits & 63));
+  }
+  return missing == 0;
+}
+
+/* Počet prvků, pro které má filtr místo */
+static size_t bloom_capacity(size_t block_count)
+{
+  return block_count * BLOOM_BLOCK_BITS / HT_BLOOM_BITS_PER_KEY;
+}
+
+/* Počet bloků filtru s místem pro dvojnásobek size prvků */
+static size_t bloom_block_count(size_t size)
+{
+  size_t bits = 2 * size * HT_BLOOM_BITS_PER_KEY;
+  return bits > 0 ? (bits + BLOOM_BLOCK_BITS - 1) / BLOOM_BLOCK_BITS : 1;
+}
+
+/*
+ * Pomocná funkce pro sestavení filtru s block_count bloky z prvků tabulky.
+ */
+static bool bloom_build(ht_bloom_t *bloom, size_t block_count)
+{
+  ht_bloom_block_t *blocks =
+      aligned_alloc(_Alignof(ht_bloom_block_t),
+                    block_count * sizeof(ht_bloom_block_t));
+  if (blocks == NULL)
+  {
+    return false;
+  }
+  memset(blocks, 0, block_count * sizeof(ht_bloom_block_t));
+
+  for (int i = 0; i < HT_SIZE; i++)
+  {
+    for (ht_item_t *item = bloom->table[i]; item != NULL; item = item->next)
+    {
+      bloom_add(blocks, block_count, ht_hash64(item->key, 0));
+    }
+  }
+
+  free(bloom->blocks);
+  bloom->blocks = blocks;
+  bloom->block_count = block_count;
+  bloom->stale = 0;
+  bloom->stats.rebuilds++;
+  return true;
+}
+
+/*
+ * Inicializace tabulky. Filtr se alokuje až při prvním vložení.
+ */
+void ht_bloom_init(ht_bloom_t *bloom)
+{
+  ht_init(&bloom->table);
+  bloom->blocks = NULL;
+  bloom->block_count = 0;
+  bloom->size = 0;
+  bloom->stale = 0;
+  memset(&bloom->stats, 0, sizeof(ht_bloom_stats_t));
+}
+
+/*
+ * Vyhledání prvku. Klíče zamítnuté filtrem se v tabulce nehledají.
+ */
+ht_item_t *ht_bloom_search(ht_bloom_t *bloom, char *key)
+{
+  if (!bloom_may_contain(bloom, key))
+  {
+    bloom->stats.rejected++;
+    return NULL;
+  }
+
+  ht_item_t *item = ht_search(&bloom->table, key);
+  bloom->stats.passed++;
+  if (item == NULL)
+  {
+    bloom->stats.false_positives++;
+  }
+  return item;
+}
+
+/*
+ * Vložení prvku, nebo náhrada hodnoty existujícího prvku. Nový klíč se
+ * přidá do filtru; překročí-li počet prvků kapacitu filtru, filtr se
+ * přestaví s dvojnásobnou kapacitou.
+ */
+void ht_bloom_insert(ht_bloom_t *bloom, char *key, float value)
+{
+  bool inserted;
+  float *slot = ht_get_or_insert(&bloom->table, key, value, &inserted);
+
+  if (slot == NULL)
+  {
+    return;
+  }
+  if (!inserted)
+  {
+    *slot = value;
+    return;
+  }
+
+  bloom->size++;
+  if (bloom->size > bloom_capacity(bloom->block_count))
+  {
+    if (bloom_build(bloom, bloom_block_count(bloom->size)))
+    {
+      return;
+    }
+  }
+  if (bloom->blocks != NULL)
+  {
+    bloom_add(bloom->blocks, bloom->block_count, ht_hash64(key, 0));
+  }
+}
+
+/*
+ * Získání ukazatele na hodnotu prvku, nebo NULL.
+ */
+float *ht_bloom_get(ht_bloom_t *bloom, char *key)
+{
+  ht_item_t *item = ht_bloom_search(bloom, key);
+  return item != NULL ? &item->value : NULL;
+}
+
+/*
+ * Odstranění prvku. Klíč zůstane ve filtru až do jeho přestavby, ke které
+ * dojde, když je odstraněných klíčů ve filtru víc než
+ * HT_BLOOM_STALE_PERCENT % prvků.
+ */
+void ht_bloom_delete(ht_bloom_t *bloom, char *key)
+{
+  if (!bloom_may_contain(bloom, key) || ht_search(&bloom->table, key) == NULL)
+  {
+    return;
+  }
+
+  ht_delete(&bloom->table, key);
+  bloom->size--;
+  bloom->stale++;
+  if (bloom->stale * 100 > bloom->size * HT_BLOOM_STALE_PERCENT)
+  {
+    ht_bloom_rebuild(bloom);
+  }
+}
+
+/*
+ * Odstranění všech prvků a uvolnění filtru.
+ */
+void ht_bloom_delete_all(ht_bloom_t *bloom)
+{
+  ht_delete_all(&bloom->table);
+  free(bloom->blocks);
+  bloom->blocks = NULL;
+  bloom->block_count = 0;
+  bloom->size = 0;
+  bloom->stale = 0;
+}
+
+/*
+ * Přestavba filtru z prvků tabulky s místem pro dvojnásobek aktuálního počtu
+ * prvků. Vrací false, pokud se nepodařilo alokovat paměť; původní filtr
+ * pak zůstane.
+ */
+bool ht_bloom_rebuild(ht_bloom_t *bloom)
+{
+  return bloom_build(bloom, bloom_block_count(bloom->size));
+}
+
+/*
+ * Podíl chybějících klíčů, které filtr propustil do seznamu synonym.
+ */
+double ht_bloom_false_positive_rate(ht_bloom_t *bloom)
+{
+  uint64_t misses = bloom->stats.rejected + bloom->stats.false_positives;
+  return misses > 0 ? (double)bloom->stats.false_positives / misses : 0;
+}
@@ -0,0 +1,55 @@
+/*
+ * Hlavičkový soubor pro tabulku s rozptýlenými položkami s blokovým Bloomovým
+ * filtrem pro rychlé neúspěšné vyhledání.
+ */
+
+#ifndef IAL_HASHTABLE_BLOOM_H
+#define IAL_HASHTABLE_BLOOM_H
+
+#include "hashtable.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Počet bitů filtru na jeden klíč
+#define HT_BLOOM_BITS_PER_KEY 10
+
+// Počet bitů nastavených pro jeden klíč (po 9 bitech z 64bitového hashe)
+#define HT_BLOOM_HASHES 6
+
+// Podíl odstraněných klíčů ve filtru vůči prvkům (v %), po kterém se filtr
+// přestaví
+#define HT_BLOOM_STALE_PERCENT 25
+
+// Blok filtru zarovnaný na jeden řádek cache (512 bitů)
+typedef struct ht_bloom_block {
+  _Alignas(64) uint64_t words[8];
+} ht_bloom_block_t;
+
+// Počítadla filtru
+typedef struct ht_bloom_stats {
+  uint64_t rejected;        // vyhledání zamítnutá filtrem
+  uint64_t passed;          // vyhledání propuštěná do seznamu synonym
+  uint64_t false_positives; // propuštěná vyhledání chybějících klíčů
+  uint64_t rebuilds;        // přestavby filtru
+} ht_bloom_stats_t;
+
+// Tabulka s filtrem před seznamy synonym
+typedef struct ht_bloom {
+  ht_table_t table;         // seznamy synonym
+  ht_bloom_block_t *blocks; // bloky filtru, nebo NULL
+  size_t block_count;       // počet bloků
+  size_t size;              // počet prvků
+  size_t stale;             // odstraněné klíče, které zůstaly ve filtru
+  ht_bloom_stats_t stats;   // počítadla
+} ht_bloom_t;
+
+void ht_bloom_init(ht_bloom_t *bloom);
+ht_item_t *ht_bloom_search(ht_bloom_t *bloom, char *key);
+void ht_bloom_insert(ht_bloom_t *bloom, char *key, float value);
+float *ht_bloom_get(ht_bloom_t *bloom, char *key);
+void ht_bloom_delete(ht_bloom_t *bloom, char *key);
+void ht_bloom_delete_all(ht_bloom_t *bloom);
+bool ht_bloom_rebuild(ht_bloom_t *bloom);
+double ht_bloom_false_positive_rate(ht_bloom_t *bloom);
+
+#endif
@@ -0,0 +1,246 @@
+/*
+ * Tabulka s rozptýlenými položkami s omezenou velikostí
+ *
+ * Každý prvek ht_cache_item_t začíná prvkem tabulky ht_item_t, který je
+ * zařazený do seznamu synonym, a zároveň leží v obousměrném seznamu podle
+ * posledního použití. Vložení i úspěšné ht_cache_get přesunou prvek na
+ * začátek seznamu. Po vložení se z konce seznamu vyhazují nejdéle
+ * nepoužité prvky, dokud počet prvků ani obsazená paměť (prvek, klíč)
+ * nepřekračuje nastavené meze.
+ *
+ * Prvek s dobou platnosti se neodstraňuje aktivně; prošlý prvek se
+ * odstraní až při vyhledání.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "cache.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Výchozí zdroj času (monotónní hodiny) */
+static uint64_t cache_now(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000u + now.tv_nsec;
+}
+
+/* Vyjmutí prvku ze seznamu podle použití */
+static void cache_unlink(ht_cache_t *cache, ht_cache_item_t *item)
+{
+  if (item->newer != NULL)
+  {
+    item->newer->older = item->older;
+  }
+  else
+  {
+    cache->newest = item->older;
+  }
+  if (item->older != NULL)
+  {
+    item->older->newer = item->newer;
+  }
+  else
+  {
+    cache->oldest = item->newer;
+  }
+}
+
+/* Zařazení prvku na začátek seznamu podle použití */
+static void cache_push(ht_cache_t *cache, ht_cache_item_t *item)
+{
+  item->newer = NULL;
+  item->older = cache->newest;
+  if (cache->newest != NULL)
+  {
+    cache->newest->newer = item;
+  }
+  else
+  {
+    cache->oldest = item;
+  }
+  cache->newest = item;
+}
+
+/* Odstranění prvku ze seznamu synonym, ze seznamu podle použití a z paměti */
+static void cache_remove(ht_cache_t *cache, ht_cache_item_t *item)
+{
+  ht_item_t **link = &cache->table[get_hash(item->item.key)];
+
+  while (*link != &item->item)
+  {
+    link = &(*link)->next;
+  }
+  *link = item->item.next;
+  cache_unlink(cache, item);
+  cache->size--;
+  cache->bytes -= item->bytes;
+  free(item->item.key);
+  free(item);
+}
+
+/* Vyhledání platného prvku; prošlý prvek se odstraní */
+static ht_cache_item_t *cache_find(ht_cache_t *cache, char *key)
+{
+  ht_cache_item_t *item = (ht_cache_item_t *)ht_search(&cache->table, key);
+
+  if (item != NULL && item->expires != 0 && cache->clock() >= item->expires)
+  {
+    cache_remove(cache, item);
+    cache->stats.expirations++;
+    return NULL;
+  }
+  return item;
+}
+
+/*
+ * Inicializace prázdné cache s nejvýše max_size prvky a max_bytes bajty
+ * obsazené paměti (0 znamená bez omezení).
+ */
+void ht_cache_init(ht_cache_t *cache, size_t max_size, size_t max_bytes)
+{
+  ht_init(&cache->table);
+  cache->newest = NULL;
+  cache->oldest = NULL;
+  cache->size = 0;
+  cache->bytes = 0;
+  cache->max_size = max_size;
+  cache->max_bytes = max_bytes;
+  cache->ttl = 0;
+  cache->clock = cache_now;
+  cache->stats = (ht_cache_stats_t){0, 0, 0, 0};
+}
+
+/*
+ * Vyhledání platného prvku bez změny pořadí použití a počítadel.
+ */
+ht_item_t *ht_cache_search(ht_cache_t *cache, char *key)
+{
+  ht_cache_item_t *item = cache_find(cache, key);
+  return item != NULL ? &item->item : NULL;
+}
+
+/*
+ * Vložení prvku s výchozí dobou platnosti cache->ttl.
+ */
+void ht_cache_insert(ht_cache_t *cache, char *key, float value)
+{
+  ht_cache_insert_ttl(cache, key, value, cache->ttl);
+}
+
+/*
+ * Vložení prvku s dobou platnosti ttl ns (0 znamená bez omezení), nebo
+ * náhrada hodnoty a doby platnosti existujícího prvku. Prvek se stane
+ * naposledy použitým, potom se vyhodí prvky nad meze cache. Vložený prvek
+ * se nevyhazuje, ani když sám překračuje mez obsazené paměti.
+ */
+void ht_cache_insert_ttl(ht_cache_t *cache, char *key, float value,
+                         uint64_t ttl)
+{
+  ht_cache_item_t *item = (ht_cache_item_t *)ht_search(&cache->table, key);
+
+  if (item != NULL)
+  {
+    cache_unlink(cache, item);
+  }
+  else
+  {
+    item = malloc(sizeof(ht_cache_item_t));
+    if (item == NULL)
+      return;
+    size_t length = strlen(key) + 1;
+    item->item.key = malloc(length);
+    if (item->item.key == NULL)
+    {
+      free(item);
+      return;
+    }
+    memcpy(item->item.key, key, length);
+
+    int index = get_hash(key);
+    item->item.next = cache->table[index];
+    cache->table[index] = &item->item;
+    item->bytes = sizeof(ht_cache_item_t) + length;
+    cache->size++;
+    cache->bytes += item->bytes;
+  }
+
+  item->item.value = value;
+  item->expires = ttl != 0 ? cache->clock() + ttl : 0;
+  cache_push(cache, item);
+
+  while (cache->oldest != item &&
+         ((cache->max_size != 0 && cache->size > cache->max_size) ||
+          (cache->max_bytes != 0 && cache->bytes > cache->max_bytes)))
+  {
+    cache_remove(cache, cache->oldest);
+    cache->stats.evictions++;
+  }
+}
+
+/*
+ * Získání hodnoty platného prvku, nebo NULL. Nalezený prvek se stane
+ * naposledy použitým.
+ */
+float *ht_cache_get(ht_cache_t *cache, char *key)
+{
+  ht_cache_item_t *item = cache_find(cache, key);
+
+  if (item == NULL)
+  {
+    cache->stats.misses++;
+    return NULL;
+  }
+  cache->stats.hits++;
+  if (cache->newest != item)
+  {
+    cache_unlink(cache, item);
+    cache_push(cache, item);
+  }
+  return &item->item.value;
+}
+
+/*
+ * Odstranění prvku. Pokud prvek neexistuje, funkce nedělá nic.
+ */
+void ht_cache_delete(ht_cache_t *cache, char *key)
+{
+  ht_cache_item_t *item = (ht_cache_item_t *)ht_search(&cache->table, key);
+
+  if (item != NULL)
+  {
+    cache_remove(cache, item);
+  }
+}
+
+/*
+ * Odstranění všech prvků; meze, zdroj času a počítadla zůstanou.
+ */
+void ht_cache_delete_all(ht_cache_t *cache)
+{
+  ht_cache_item_t *item = cache->newest;
+
+  while (item != NULL)
+  {
+    ht_cache_item_t *older = item->older;
+    free(item->item.key);
+    free(item);
+    item = older;
+  }
+  ht_init(&cache->table);
+  cache->newest = NULL;
+  cache->oldest = NULL;
+  cache->size = 0;
+  cache->bytes = 0;
+}
+
+/*
+ * Podíl úspěšných ht_cache_get.
+ */
+double ht_cache_hit_rate(ht_cache_t *cache)
+{
+  uint64_t total = cache->stats.hits + cache->stats.misses;
+  return total > 0 ? (double)cache->stats.hits / total : 0;
+}
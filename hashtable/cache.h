@@ -0,0 +1,57 @@
+/*
+ * Hlavičkový soubor pro tabulku s rozptýlenými položkami s omezenou
+ * velikostí (cache s vyhazováním LRU a dobou platnosti).
+ */
+
+#ifndef IAL_HASHTABLE_CACHE_H
+#define IAL_HASHTABLE_CACHE_H
+
+#include "hashtable.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Zdroj času v ns
+typedef uint64_t (*ht_cache_clock_t)(void);
+
+// Prvek tabulky zařazený zároveň do seznamu podle posledního použití
+typedef struct ht_cache_item {
+  ht_item_t item;              // prvek tabulky, musí být první
+  struct ht_cache_item *newer; // naposledy použitý dříve, nebo NULL
+  struct ht_cache_item *older; // použitý ještě dříve, nebo NULL
+  uint64_t expires;            // konec platnosti v ns, nebo 0
+  size_t bytes;                // obsazená paměť
+} ht_cache_item_t;
+
+// Počítadla pro určení velikosti cache
+typedef struct ht_cache_stats {
+  uint64_t hits;        // úspěšná ht_cache_get
+  uint64_t misses;      // neúspěšná ht_cache_get (včetně prošlých)
+  uint64_t expirations; // prvky odstraněné po uplynutí platnosti
+  uint64_t evictions;   // prvky vyhozené kvůli velikosti
+} ht_cache_stats_t;
+
+// Tabulka s omezeným počtem prvků nebo obsazenou pamětí
+typedef struct ht_cache {
+  ht_table_t table;        // seznamy synonym
+  ht_cache_item_t *newest; // naposledy použitý prvek
+  ht_cache_item_t *oldest; // nejdéle nepoužitý prvek
+  size_t size;             // počet prvků
+  size_t bytes;            // paměť obsazená prvky
+  size_t max_size;         // největší počet prvků, nebo 0
+  size_t max_bytes;        // největší obsazená paměť, nebo 0
+  uint64_t ttl;            // výchozí doba platnosti v ns, nebo 0
+  ht_cache_clock_t clock;  // zdroj času
+  ht_cache_stats_t stats;  // počítadla
+} ht_cache_t;
+
+void ht_cache_init(ht_cache_t *cache, size_t max_size, size_t max_bytes);
+ht_item_t *ht_cache_search(ht_cache_t *cache, char *key);
+void ht_cache_insert(ht_cache_t *cache, char *key, float value);
+void ht_cache_insert_ttl(ht_cache_t *cache, char *key, float value,
+                         uint64_t ttl);
+float *ht_cache_get(ht_cache_t *cache, char *key);
+void ht_cache_delete(ht_cache_t *cache, char *key);
+void ht_cache_delete_all(ht_cache_t *cache);
+double ht_cache_hit_rate(ht_cache_t *cache);
+
+#endif
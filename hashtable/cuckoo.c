@@ -0,0 +1,378 @@
+/*
+ * Tabulka s rozptýlenými položkami s kukaččím hashováním
+ *
+ * Položka může ležet jen v jednom ze dvou kbelíků po HT_CUCKOO_WAYS místech.
+ * Kbelík zabírá jeden řádek cache a vedle ukazatelů na položky obsahuje
+ * 32bitové otisky klíčů. Vyhledání tak čte nejvýše dva řádky s kbelíky
+ * a klíč porovnává jen u položek se shodným otiskem. Skrýš se prochází
+ * jen tehdy, když není prázdná.
+ *
+ * První kbelík je určený dolními bity otisku, druhý vznikne z prvního
+ * operací XOR s rozptýleným otiskem. Z kbelíku a otisku lze tedy spočítat
+ * druhý kbelík bez čtení klíče. Vkládání do plných kbelíků vyhazuje
+ * náhodně zvolené položky do jejich druhého kbelíku, nejvýše
+ * HT_CUCKOO_MAX_KICKS krát. Položka, která zůstane bez místa, se odloží do
+ * skrýše. Při plné skrýši se počet kbelíků zdvojnásobí.
+ *
+ * Položky jsou ht_item_t jako v hashtable.c, ukazatel next se nepoužívá.
+ */
+
+#include "cuckoo.h"
+#include "hash.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Otisk klíče (64bitový hash složený do 32 bitů) */
+static uint32_t cuckoo_tag(const char *key)
+{
+  uint64_t hash = ht_hash64(key, 0);
+  return (uint32_t)(hash ^ (hash >> 32));
+}
+
+/* Druhý kbelík k danému kbelíku a otisku */
+static size_t cuckoo_alternate(size_t mask, size_t bucket, uint32_t tag)
+{
+  return (bucket ^ (((size_t)tag * 0x5bd1e995u >> 7) | 1)) & mask;
+}
+
+/* Vyhledání položky v kbelíku, vrací místo nebo -1 */
+static int cuckoo_find_in(ht_cuckoo_bucket_t *bucket, uint32_t tag,
+                          const char *key)
+{
+  for (int i = 0; i < HT_CUCKOO_WAYS; i++)
+  {
+    if (bucket->tags[i] == tag && bucket->items[i] != NULL &&
+        strcmp(bucket->items[i]->key, key) == 0)
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/* Vložení do volného místa kbelíku, vrací false při plném kbelíku */
+static bool cuckoo_put(ht_cuckoo_bucket_t *bucket, ht_item_t *item,
+                       uint32_t tag)
+{
+  for (int i = 0; i < HT_CUCKOO_WAYS; i++)
+  {
+    if (bucket->items[i] == NULL)
+    {
+      bucket->tags[i] = tag;
+      bucket->items[i] = item;
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * Umístění položky do kbelíků, případně do skrýše. Vrací false, pokud je
+ * skrýš plná; v *item a *tag pak zůstane položka, která se nevešla.
+ */
+static bool cuckoo_add(ht_cuckoo_t *table, ht_item_t **item, uint32_t *tag)
+{
+  size_t bucket = *tag & table->mask;
+
+  if (cuckoo_put(&table->buckets[bucket], *item, *tag))
+  {
+    return true;
+  }
+  bucket = cuckoo_alternate(table->mask, bucket, *tag);
+  if (cuckoo_put(&table->buckets[bucket], *item, *tag))
+  {
+    return true;
+  }
+
+  for (int kick = 0; kick < HT_CUCKOO_MAX_KICKS; kick++)
+  {
+    table->random ^= table->random << 13;
+    table->random ^= table->random >> 7;
+    table->random ^= table->random << 17;
+    int slot = table->random % HT_CUCKOO_WAYS;
+
+    ht_cuckoo_bucket_t *victim = &table->buckets[bucket];
+    ht_item_t *victim_item = victim->items[slot];
+    uint32_t victim_tag = victim->tags[slot];
+    victim->items[slot] = *item;
+    victim->tags[slot] = *tag;
+    *item = victim_item;
+    *tag = victim_tag;
+
+    bucket = cuckoo_alternate(table->mask, bucket, *tag);
+    if (cuckoo_put(&table->buckets[bucket], *item, *tag))
+    {
+      return true;
+    }
+  }
+
+  if (table->stash_count < HT_CUCKOO_STASH)
+  {
+    table->stash_tags[table->stash_count] = *tag;
+    table->stash[table->stash_count++] = *item;
+    return true;
+  }
+  return false;
+}
+
+/* Alokace buckets prázdných kbelíků, vrací false při nedostatku paměti */
+static bool cuckoo_allocate(ht_cuckoo_t *table, size_t buckets)
+{
+  table->buckets = aligned_alloc(_Alignof(ht_cuckoo_bucket_t),
+                                 buckets * sizeof(ht_cuckoo_bucket_t));
+  if (table->buckets == NULL)
+  {
+    return false;
+  }
+  memset(table->buckets, 0, buckets * sizeof(ht_cuckoo_bucket_t));
+  table->mask = buckets - 1;
+  table->stash_count = 0;
+  return true;
+}
+
+/*
+ * Přestavba tabulky na buckets kbelíků. Pokud se všechny položky včetně
+ * item (může být NULL) nevejdou, počet kbelíků se dále zdvojnásobuje. Při
+ * nedostatku paměti zůstane původní tabulka beze změny a funkce vrací
+ * false.
+ */
+static bool cuckoo_rebuild(ht_cuckoo_t *table, size_t buckets,
+                           ht_item_t *item, uint32_t tag)
+{
+  for (;; buckets *= 2)
+  {
+    ht_cuckoo_t grown = *table;
+    bool complete = true;
+
+    if (!cuckoo_allocate(&grown, buckets))
+    {
+      return false;
+    }
+    for (size_t b = 0; table->buckets != NULL && b <= table->mask && complete;
+         b++)
+    {
+      for (int i = 0; i < HT_CUCKOO_WAYS && complete; i++)
+      {
+        ht_item_t *moved = table->buckets[b].items[i];
+        uint32_t moved_tag = table->buckets[b].tags[i];
+        complete = moved == NULL || cuckoo_add(&grown, &moved, &moved_tag);
+      }
+    }
+    for (int i = 0; i < table->stash_count && complete; i++)
+    {
+      ht_item_t *moved = table->stash[i];
+      uint32_t moved_tag = table->stash_tags[i];
+      complete = cuckoo_add(&grown, &moved, &moved_tag);
+    }
+    if (complete && (item == NULL || cuckoo_add(&grown, &item, &tag)))
+    {
+      free(table->buckets);
+      *table = grown;
+      return true;
+    }
+    free(grown.buckets);
+  }
+}
+
+/*
+ * Inicializace prázdné tabulky; kbelíky se alokují až při prvním vložení.
+ */
+void ht_cuckoo_init(ht_cuckoo_t *table)
+{
+  table->buckets = NULL;
+  table->mask = 0;
+  table->size = 0;
+  table->stash_count = 0;
+  table->random = 88172645463325252u;
+}
+
+/*
+ * Vyhledání prvku v tabulce, vrací ukazatel na prvek nebo NULL.
+ */
+ht_item_t *ht_cuckoo_search(ht_cuckoo_t *table, char *key)
+{
+  if (table->buckets == NULL)
+  {
+    return NULL;
+  }
+
+  uint32_t tag = cuckoo_tag(key);
+  size_t bucket = tag & table->mask;
+  int slot = cuckoo_find_in(&table->buckets[bucket], tag, key);
+  if (slot < 0)
+  {
+    bucket = cuckoo_alternate(table->mask, bucket, tag);
+    slot = cuckoo_find_in(&table->buckets[bucket], tag, key);
+  }
+  if (slot >= 0)
+  {
+    return table->buckets[bucket].items[slot];
+  }
+
+  for (int i = 0; i < table->stash_count; i++)
+  {
+    if (table->stash_tags[i] == tag && strcmp(table->stash[i]->key, key) == 0)
+    {
+      return table->stash[i];
+    }
+  }
+  return NULL;
+}
+
+/*
+ * Vložení nového prvku do tabulky, nebo náhrada hodnoty existujícího prvku.
+ */
+void ht_cuckoo_insert(ht_cuckoo_t *table, char *key, float value)
+{
+  ht_item_t *existing_item = ht_cuckoo_search(table, key);
+
+  if (existing_item != NULL)
+  {
+    existing_item->value = value;
+    return;
+  }
+  if (table->buckets == NULL && !cuckoo_allocate(table, HT_CUCKOO_MIN_BUCKETS))
+  {
+    return;
+  }
+
+  ht_item_t *new_item = malloc(sizeof(ht_item_t));
+  if (new_item == NULL)
+    return;
+  new_item->key = malloc(strlen(key) + 1);
+  if (new_item->key == NULL)
+  {
+    free(new_item);
+    return;
+  }
+  strcpy(new_item->key, key);
+  new_item->value = value;
+  new_item->next = NULL;
+
+  ht_item_t *item = new_item;
+  uint32_t tag = cuckoo_tag(key);
+  if (cuckoo_add(table, &item, &tag) ||
+      cuckoo_rebuild(table, 2 * (table->mask + 1), item, tag))
+  {
+    table->size++;
+    return;
+  }
+
+  // Bez paměti pro přestavbu se uvolní položka, která zůstala venku; může
+  // to být i dříve vložená položka vyhozená novou.
+  free(item->key);
+  free(item);
+}
+
+/*
+ * Zvětšení tabulky tak, aby měla alespoň count míst v kbelících. Vrací
+ * false při nedostatku paměti.
+ */
+bool ht_cuckoo_reserve(ht_cuckoo_t *table, size_t count)
+{
+  size_t buckets = HT_CUCKOO_MIN_BUCKETS;
+
+  while (buckets * HT_CUCKOO_WAYS < count)
+  {
+    buckets *= 2;
+  }
+  if (table->buckets != NULL && buckets <= table->mask + 1)
+  {
+    return true;
+  }
+  return cuckoo_rebuild(table, buckets, NULL, 0);
+}
+
+/*
+ * Získání ukazatele na hodnotu prvku, nebo NULL.
+ */
+float *ht_cuckoo_get(ht_cuckoo_t *table, char *key)
+{
+  ht_item_t *item = ht_cuckoo_search(table, key);
+  return item != NULL ? &item->value : NULL;
+}
+
+/*
+ * Smazání prvku z tabulky. Pokud prvek neexistuje, funkce nedělá nic.
+ */
+void ht_cuckoo_delete(ht_cuckoo_t *table, char *key)
+{
+  if (table->buckets == NULL)
+  {
+    return;
+  }
+
+  uint32_t tag = cuckoo_tag(key);
+  size_t bucket = tag & table->mask;
+  ht_item_t *item = NULL;
+
+  for (int pass = 0; pass < 2 && item == NULL; pass++)
+  {
+    int slot = cuckoo_find_in(&table->buckets[bucket], tag, key);
+    if (slot >= 0)
+    {
+      item = table->buckets[bucket].items[slot];
+      table->buckets[bucket].items[slot] = NULL;
+    }
+    bucket = cuckoo_alternate(table->mask, bucket, tag);
+  }
+  for (int i = 0; i < table->stash_count && item == NULL; i++)
+  {
+    if (table->stash_tags[i] == tag && strcmp(table->stash[i]->key, key) == 0)
+    {
+      item = table->stash[i];
+      table->stash_count--;
+      table->stash[i] = table->stash[table->stash_count];
+      table->stash_tags[i] = table->stash_tags[table->stash_count];
+    }
+  }
+
+  if (item != NULL)
+  {
+    free(item->key);
+    free(item);
+    table->size--;
+  }
+}
+
+/*
+ * Smazání všech prvků a uvolnění kbelíků, tabulka zůstane ve stavu po
+ * inicializaci.
+ */
+void ht_cuckoo_delete_all(ht_cuckoo_t *table)
+{
+  if (table->buckets != NULL)
+  {
+    for (size_t b = 0; b <= table->mask; b++)
+    {
+      for (int i = 0; i < HT_CUCKOO_WAYS; i++)
+      {
+        ht_item_t *item = table->buckets[b].items[i];
+        if (item != NULL)
+        {
+          free(item->key);
+          free(item);
+        }
+      }
+    }
+  }
+  for (int i = 0; i < table->stash_count; i++)
+  {
+    free(table->stash[i]->key);
+    free(table->stash[i]);
+  }
+  free(table->buckets);
+  ht_cuckoo_init(table);
+}
+
+/*
+ * Zaplnění kbelíků (podíl položek a míst).
+ */
+double ht_cuckoo_load_factor(ht_cuckoo_t *table)
+{
+  if (table->buckets == NULL)
+  {
+    return 0;
+  }
+  return (double)table->size / ((table->mask + 1) * HT_CUCKOO_WAYS);
+}
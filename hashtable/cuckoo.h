@@ -0,0 +1,51 @@
+/*
+ * Hlavičkový soubor pro tabulku s rozptýlenými položkami s kukaččím
+ * hashováním.
+ */
+
+#ifndef IAL_HASHTABLE_CUCKOO_H
+#define IAL_HASHTABLE_CUCKOO_H
+
+#include "hashtable.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Počet položek v jednom kbelíku
+#define HT_CUCKOO_WAYS 4
+
+// Největší počet přesunů při vkládání, než se položka odloží do skrýše
+#define HT_CUCKOO_MAX_KICKS 128
+
+// Velikost skrýše pro položky, které se nepodařilo umístit
+#define HT_CUCKOO_STASH 8
+
+// Počet kbelíků po prvním vložení
+#define HT_CUCKOO_MIN_BUCKETS 8
+
+// Kbelík zarovnaný na jeden řádek cache
+typedef struct ht_cuckoo_bucket {
+  _Alignas(64) uint32_t tags[HT_CUCKOO_WAYS]; // otisky klíčů
+  ht_item_t *items[HT_CUCKOO_WAYS];           // položky, nebo NULL
+} ht_cuckoo_bucket_t;
+
+// Tabulka s kukaččím hashováním
+typedef struct ht_cuckoo {
+  ht_cuckoo_bucket_t *buckets; // pole kbelíků, nebo NULL
+  size_t mask;                 // počet kbelíků - 1
+  size_t size;                 // počet položek
+  int stash_count;             // počet položek ve skrýši
+  uint32_t stash_tags[HT_CUCKOO_STASH];
+  ht_item_t *stash[HT_CUCKOO_STASH];
+  uint64_t random; // stav generátoru pro volbu vyhazované položky
+} ht_cuckoo_t;
+
+void ht_cuckoo_init(ht_cuckoo_t *table);
+ht_item_t *ht_cuckoo_search(ht_cuckoo_t *table, char *key);
+void ht_cuckoo_insert(ht_cuckoo_t *table, char *key, float value);
+bool ht_cuckoo_reserve(ht_cuckoo_t *table, size_t count);
+float *ht_cuckoo_get(ht_cuckoo_t *table, char *key);
+void ht_cuckoo_delete(ht_cuckoo_t *table, char *key);
+void ht_cuckoo_delete_all(ht_cuckoo_t *table);
+double ht_cuckoo_load_factor(ht_cuckoo_t *table);
+
+#endif
@@ -0,0 +1,72 @@
+/*
+ * Bufferovaný výpis tabulky
+ *
+ * Textový výpis obsahuje pro každý index tabulky jeden řádek se seznamem
+ * synonym ve tvaru "(klíč,hodnota)", hodnoty mají dvě desetinná místa.
+ *
+ * Binární výpis začíná počtem položek (varint), následují položky po
+ * indexech tabulky. Každou položku tvoří délka klíče (varint), klíč a bity
+ * hodnoty typu float (4 B little-endian).
+ */
+
+#include "dump.h"
+#include <string.h>
+
+/*
+ * Pomocná funkce pro výpis položky tabulky ve tvaru "(klíč,hodnota)".
+ */
+void ht_write_item(writer_t *writer, ht_item_t *item)
+{
+  writer_char(writer, '(');
+  writer_string(writer, item->key);
+  writer_char(writer, ',');
+  writer_float(writer, item->value, 2);
+  writer_char(writer, ')');
+}
+
+/*
+ * Textový výpis celé tabulky.
+ */
+void ht_write_table(writer_t *writer, ht_table_t *table)
+{
+  for (int i = 0; i < HT_SIZE; i++)
+  {
+    writer_int(writer, i);
+    writer_string(writer, ": ");
+    for (ht_item_t *item = (*table)[i]; item != NULL; item = item->next)
+    {
+      ht_write_item(writer, item);
+    }
+    writer_char(writer, '\n');
+  }
+}
+
+/*
+ * Binární výpis celé tabulky.
+ */
+void ht_dump_binary(writer_t *writer, ht_table_t *table)
+{
+  uint64_t count = 0;
+
+  for (int i = 0; i < HT_SIZE; i++)
+  {
+    for (ht_item_t *item = (*table)[i]; item != NULL; item = item->next)
+    {
+      count++;
+    }
+  }
+  writer_varint(writer, count);
+
+  for (int i = 0; i < HT_SIZE; i++)
+  {
+    for (ht_item_t *item = (*table)[i]; item != NULL; item = item->next)
+    {
+      size_t length = strlen(item->key);
+      uint32_t bits;
+      memcpy(&bits, &item->value, sizeof(bits));
+      writer_varint(writer, length);
+      writer_bytes(writer, item->key, length);
+      writer_u32(writer, bits);
+    }
+  }
+}
@@ -0,0 +1,15 @@
+/*
+ * Hlavičkový soubor pro bufferovaný textový a binární výpis tabulky.
+ */
+
+#ifndef IAL_HASHTABLE_DUMP_H
+#define IAL_HASHTABLE_DUMP_H
+
+#include "../common/writer.h"
+#include "hashtable.h"
+
+void ht_write_item(writer_t *writer, ht_item_t *item);
+void ht_write_table(writer_t *writer, ht_table_t *table);
+void ht_dump_binary(writer_t *writer, ht_table_t *table);
+
+#endif
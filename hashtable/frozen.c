@@ -0,0 +1,350 @@
+/*
+ * Neměnná tabulka s minimální perfektní rozptylovací funkcí
+ *
+ * ht_freeze sestaví z klíčů tabulky rozptylovací funkci, která každému
+ * klíči přidělí jinou pozici z intervalu <0, n-1>. Vyhledání tak spočítá
+ * jednu pozici a porovná jeden klíč; tabulka nemá seznamy synonym ani
+ * kolize. Klíče a hodnoty se zkopírují, původní tabulka se nemění.
+ *
+ * Klíče se podle hashe rozdělí do skupin po průměrně HT_FROZEN_BUCKET_KEYS
+ * klíčích. Skupiny se od největší umisťují do m = n + n/50 pozic: pro každou
+ * se hledá nejmenší 16bitové semínko, se kterým všechny její klíče padnou
+ * na volné a navzájem různé pozice. Volná pozice navíc zaručuje, že se
+ * i poslední skupiny umístí po několika pokusech. Pozice n až m-1 se nakonec
+ * přemapují na pozice < n, které zůstaly volné. Pokud se některou skupinu
+ * umístit nepodaří, sestavení se opakuje s jinou solí.
+ *
+ * Metadata jsou semínka (16 b na skupinu, asi 4 b na klíč) a tabulka
+ * přemapování (32 b na každou z m-n pozic, asi 0,6 b na klíč).
+ */
+
+#include "frozen.h"
+#include "hash.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Pomocná pole pro sestavení
+typedef struct frozen_build {
+  ht_item_t **items;      // klíče tabulky
+  uint64_t *hashes;       // hash každého klíče
+  uint32_t *positions;    // pozice každého klíče z <0, m-1>
+  uint32_t *bucket_start; // začátek skupiny v poli bucket_keys
+  uint32_t *bucket_keys;  // klíče seřazené podle skupin
+  uint32_t *order;        // skupiny seřazené podle velikosti
+  uint8_t *taken;         // obsazené pozice
+} frozen_build_t;
+
+/* Převod 32bitového čísla na interval <0, range) bez dělení */
+static size_t frozen_range(uint32_t x, size_t range)
+{
+  return ((uint64_t)x * range) >> 32;
+}
+
+/* Skupina klíče */
+static size_t frozen_bucket(ht_frozen_t *frozen, uint64_t hash)
+{
+  return frozen_range(hash >> 32, frozen->buckets);
+}
+
+/* Pozice klíče pro semínko skupiny */
+static size_t frozen_position(ht_frozen_t *frozen, uint64_t hash,
+                              uint16_t seed)
+{
+  uint64_t mixed = ht_mix64(hash ^ ((seed + 1u) * 0x9e3779b97f4a7c15u));
+  return frozen_range((uint32_t)mixed, frozen->slots);
+}
+
+/*
+ * Pomocná funkce pro rozdělení klíčů do skupin a seřazení skupin od
+ * největší.
+ */
+static bool frozen_group(ht_frozen_t *frozen, frozen_build_t *build)
+{
+  size_t max_size = 0;
+
+  memset(build->bucket_start, 0, (frozen->buckets + 1) * sizeof(uint32_t));
+  for (size_t i = 0; i < frozen->size; i++)
+  {
+    build->hashes[i] = ht_hash64(build->items[i]->key, frozen->salt);
+    build->bucket_start[frozen_bucket(frozen, build->hashes[i]) + 1]++;
+  }
+  for (size_t b = 0; b < frozen->buckets; b++)
+  {
+    size_t size = build->bucket_start[b + 1];
+    max_size = size > max_size ? size : max_size;
+    build->bucket_start[b + 1] += build->bucket_start[b];
+  }
+
+  // Rozdělení klíčů, pole order slouží dočasně jako ukazatel zápisu
+  memcpy(build->order, build->bucket_start, frozen->buckets * sizeof(uint32_t));
+  for (size_t i = 0; i < frozen->size; i++)
+  {
+    build->bucket_keys[build->order[frozen_bucket(frozen, build->hashes[i])]++] =
+        i;
+  }
+
+  // Řazení skupin podle velikosti počítáním
+  uint32_t *count = calloc(max_size + 2, sizeof(uint32_t));
+  if (count == NULL)
+  {
+    return false;
+  }
+  for (size_t b = 0; b < frozen->buckets; b++)
+  {
+    count[max_size - (build->bucket_start[b + 1] - build->bucket_start[b]) +
+          1]++;
+  }
+  for (size_t s = 1; s <= max_size + 1; s++)
+  {
+    count[s] += count[s - 1];
+  }
+  for (size_t b = 0; b < frozen->buckets; b++)
+  {
+    size_t size = build->bucket_start[b + 1] - build->bucket_start[b];
+    build->order[count[max_size - size]++] = b;
+  }
+  free(count);
+  return true;
+}
+
+/*
+ * Pomocná funkce pro umístění skupiny b: hledá semínko, se kterým všechny
+ * klíče skupiny padnou na volné a různé pozice. Vrací false, pokud žádné
+ * semínko nevyhovuje.
+ */
+static bool frozen_place(ht_frozen_t *frozen, frozen_build_t *build, size_t b)
+{
+  uint32_t *keys = build->bucket_keys + build->bucket_start[b];
+  size_t size = build->bucket_start[b + 1] - build->bucket_start[b];
+
+  for (uint32_t seed = 0; seed <= UINT16_MAX; seed++)
+  {
+    size_t placed = 0;
+    for (; placed < size; placed++)
+    {
+      size_t position =
+          frozen_position(frozen, build->hashes[keys[placed]], seed);
+      if (build->taken[position])
+      {
+        break;
+      }
+      build->taken[position] = 1;
+      build->positions[keys[placed]] = position;
+    }
+    if (placed == size)
+    {
+      frozen->seeds[b] = seed;
+      return true;
+    }
+    for (size_t j = 0; j < placed; j++)
+    {
+      build->taken[build->positions[keys[j]]] = 0;
+    }
+  }
+  return false;
+}
+
+/* Pokus o umístění všech skupin s aktuální solí */
+static bool frozen_try(ht_frozen_t *frozen, frozen_build_t *build)
+{
+  if (!frozen_group(frozen, build))
+  {
+    return false;
+  }
+  memset(build->taken, 0, frozen->slots);
+  for (size_t i = 0; i < frozen->buckets; i++)
+  {
+    size_t b = build->order[i];
+    if (build->bucket_start[b + 1] > build->bucket_start[b] &&
+        !frozen_place(frozen, build, b))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * Pomocná funkce pro přemapování pozic n až m-1 a zkopírování klíčů
+ * a hodnot na výsledné pozice.
+ */
+static void frozen_fill(ht_frozen_t *frozen, frozen_build_t *build)
+{
+  size_t free_slot = 0;
+  for (size_t p = frozen->size; p < frozen->slots; p++)
+  {
+    if (build->taken[p])
+    {
+      while (build->taken[free_slot])
+      {
+        free_slot++;
+      }
+      frozen->remap[p - frozen->size] = free_slot++;
+    }
+  }
+
+  // Pole bucket_keys už není potřeba, uloží se do něj klíč každé pozice
+  for (size_t i = 0; i < frozen->size; i++)
+  {
+    size_t slot = build->positions[i];
+    if (slot >= frozen->size)
+    {
+      slot = frozen->remap[slot - frozen->size];
+    }
+    build->bucket_keys[slot] = i;
+  }
+
+  size_t offset = 0;
+  for (size_t slot = 0; slot < frozen->size; slot++)
+  {
+    ht_item_t *item = build->items[build->bucket_keys[slot]];
+    size_t length = strlen(item->key) + 1;
+    memcpy(frozen->keys + offset, item->key, length);
+    frozen->offsets[slot] = offset;
+    frozen->values[slot] = item->value;
+    offset += length;
+  }
+}
+
+/*
+ * Sestavení neměnné tabulky z klíčů a hodnot tabulky table. Vrací false
+ * při nedostatku paměti nebo pokud se sestavení nepodaří; frozen je pak
+ * prázdná.
+ */
+bool ht_freeze(ht_table_t *table, ht_frozen_t *frozen)
+{
+  frozen_build_t build = {NULL, NULL, NULL, NULL, NULL, NULL, NULL};
+  bool built = false;
+
+  memset(frozen, 0, sizeof(ht_frozen_t));
+  for (int i = 0; i < HT_SIZE; i++)
+  {
+    for (ht_item_t *item = (*table)[i]; item != NULL; item = item->next)
+    {
+      frozen->size++;
+      frozen->keys_size += strlen(item->key) + 1;
+    }
+  }
+  if (frozen->size == 0)
+  {
+    return true;
+  }
+
+  frozen->slots = frozen->size + (frozen->size + 49) / 50;
+  frozen->buckets = (frozen->size + HT_FROZEN_BUCKET_KEYS - 1) /
+                    HT_FROZEN_BUCKET_KEYS;
+  frozen->seeds = malloc(frozen->buckets * sizeof(uint16_t));
+  frozen->remap = calloc(frozen->slots - frozen->size, sizeof(uint32_t));
+  frozen->offsets = malloc(frozen->size * sizeof(uint32_t));
+  frozen->values = malloc(frozen->size * sizeof(float));
+  frozen->keys = malloc(frozen->keys_size);
+  build.items = malloc(frozen->size * sizeof(ht_item_t *));
+  build.hashes = malloc(frozen->size * sizeof(uint64_t));
+  build.positions = malloc(frozen->size * sizeof(uint32_t));
+  build.bucket_start = malloc((frozen->buckets + 1) * sizeof(uint32_t));
+  build.bucket_keys = malloc(frozen->size * sizeof(uint32_t));
+  build.order = malloc(frozen->buckets * sizeof(uint32_t));
+  build.taken = malloc(frozen->slots);
+
+  if (frozen->seeds != NULL && frozen->remap != NULL &&
+      frozen->offsets != NULL && frozen->values != NULL &&
+      frozen->keys != NULL && build.items != NULL && build.hashes != NULL &&
+      build.positions != NULL && build.bucket_start != NULL &&
+      build.bucket_keys != NULL && build.order != NULL && build.taken != NULL)
+  {
+    size_t count = 0;
+    for (int i = 0; i < HT_SIZE; i++)
+    {
+      for (ht_item_t *item = (*table)[i]; item != NULL; item = item->next)
+      {
+        build.items[count++] = item;
+      }
+    }
+    for (int attempt = 0; attempt < HT_FROZEN_ATTEMPTS && !built; attempt++)
+    {
+      frozen->salt = ht_mix64(attempt + 1);
+      built = frozen_try(frozen, &build);
+    }
+    if (built)
+    {
+      frozen_fill(frozen, &build);
+    }
+  }
+
+  free(build.items);
+  free(build.hashes);
+  free(build.positions);
+  free(build.bucket_start);
+  free(build.bucket_keys);
+  free(build.order);
+  free(build.taken);
+  if (!built)
+  {
+    ht_frozen_dispose(frozen);
+  }
+  return built;
+}
+
+/*
+ * Získání ukazatele na hodnotu klíče, nebo NULL.
+ */
+float *ht_frozen_get(ht_frozen_t *frozen, const char *key)
+{
+  if (frozen->size == 0)
+  {
+    return NULL;
+  }
+
+  uint64_t hash = ht_hash64(key, frozen->salt);
+  size_t slot = frozen_position(frozen, hash,
+                                frozen->seeds[frozen_bucket(frozen, hash)]);
+  if (slot >= frozen->size)
+  {
+    slot = frozen->remap[slot - frozen->size];
+  }
+  if (strcmp(frozen->keys + frozen->offsets[slot], key) != 0)
+  {
+    return NULL;
+  }
+  return &frozen->values[slot];
+}
+
+/*
+ * Paměť obsazená tabulkou v bajtech.
+ */
+size_t ht_frozen_bytes(ht_frozen_t *frozen)
+{
+  return sizeof(ht_frozen_t) + frozen->buckets * sizeof(uint16_t) +
+         (frozen->slots - frozen->size) * sizeof(uint32_t) +
+         frozen->size * (sizeof(uint32_t) + sizeof(float)) +
+         frozen->keys_size;
+}
+
+/*
+ * Velikost metadat rozptylovací funkce (semínka a přemapování) v bitech
+ * na klíč.
+ */
+double ht_frozen_metadata_bits(ht_frozen_t *frozen)
+{
+  if (frozen->size == 0)
+  {
+    return 0;
+  }
+  return 8.0 *
+         (frozen->buckets * sizeof(uint16_t) +
+          (frozen->slots - frozen->size) * sizeof(uint32_t)) /
+         frozen->size;
+}
+
+/*
+ * Uvolnění tabulky, po uvolnění je prázdná.
+ */
+void ht_frozen_dispose(ht_frozen_t *frozen)
+{
+  free(frozen->seeds);
+  free(frozen->remap);
+  free(frozen->offsets);
+  free(frozen->values);
+  free(frozen->keys);
+  memset(frozen, 0, sizeof(ht_frozen_t));
+}
@@ -0,0 +1,39 @@
+/*
+ * Hlavičkový soubor pro neměnnou tabulku s minimální perfektní
+ * rozptylovací funkcí.
+ */
+
+#ifndef IAL_HASHTABLE_FROZEN_H
+#define IAL_HASHTABLE_FROZEN_H
+
+#include "hashtable.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Průměrný počet klíčů v jedné skupině se společným semínkem
+#define HT_FROZEN_BUCKET_KEYS 4
+
+// Počet pokusů o sestavení s různou solí
+#define HT_FROZEN_ATTEMPTS 16
+
+// Neměnná tabulka bez kolizí
+typedef struct ht_frozen {
+  size_t size;        // počet klíčů (n)
+  size_t slots;       // rozsah pozic před přemapováním (m >= n)
+  size_t buckets;     // počet skupin klíčů
+  uint64_t salt;      // sůl rozptylovací funkce
+  uint16_t *seeds;    // semínko pozice pro každou skupinu
+  uint32_t *remap;    // pozice < n pro pozice n až m - 1
+  uint32_t *offsets;  // pozice klíče v poli keys pro každou pozici
+  float *values;      // hodnota pro každou pozici
+  char *keys;         // klíče ukončené '\0'
+  size_t keys_size;   // velikost pole keys
+} ht_frozen_t;
+
+bool ht_freeze(ht_table_t *table, ht_frozen_t *frozen);
+float *ht_frozen_get(ht_frozen_t *frozen, const char *key);
+size_t ht_frozen_bytes(ht_frozen_t *frozen);
+double ht_frozen_metadata_bits(ht_frozen_t *frozen);
+void ht_frozen_dispose(ht_frozen_t *frozen);
+
+#endif
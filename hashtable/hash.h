@@ -0,0 +1,39 @@
+/*
+ * Hlavičkový soubor s 64bitovou rozptylovací funkcí pro řetězcové klíče.
+ *
+ * Pomocné tabulky (bloom.c, frozen.c, cuckoo.c, sharded.c) potřebují hash
+ * nezávislý na get_hash z hashtable.c a s dobře promíchanými vyššími bity.
+ */
+
+#ifndef IAL_HASHTABLE_HASH_H
+#define IAL_HASHTABLE_HASH_H
+
+#include <stdint.h>
+
+/* Promíchání bitů (dokončovací funkce MurmurHash3) */
+static inline uint64_t ht_mix64(uint64_t x)
+{
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdu;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53u;
+  x ^= x >> 33;
+  return x;
+}
+
+/*
+ * Hash klíče (FNV-1a s promícháním). Různé hodnoty salt dávají nezávislé
+ * rozptylovací funkce.
+ */
+static inline uint64_t ht_hash64(const char *key, uint64_t salt)
+{
+  uint64_t hash = 14695981039346656037u ^ salt;
+  for (; *key != '\0'; key++)
+  {
+    hash ^= (unsigned char)*key;
+    hash *= 1099511628211u;
+  }
+  return ht_mix64(hash);
+}
+
+#endif
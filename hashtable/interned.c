@@ -0,0 +1,106 @@
+/*
+ * Tabulka s rozptýlenými položkami s klíči ze společného úložiště řetězců
+ *
+ * Klíče jsou ukazatele vrácené funkcí intern (common/intern.c). Tabulka je
+ * obyčejná ht_table_t inicializovaná funkcí ht_init a lze ji vypsat stejně
+ * jako jiné tabulky. Prvek klíč nekopíruje, ale odkazuje přímo na text
+ * v úložišti; index určuje předem spočítaný hash klíče a klíče se
+ * porovnávají jen ukazateli, bez strcmp.
+ *
+ * Protože se index liší od get_hash a klíče patří úložišti, nesmí se na
+ * tabulku volat ht_search, ht_insert, ht_get, ht_delete ani ht_delete_all.
+ */
+
+#include "interned.h"
+#include <stdlib.h>
+
+/* Index klíče v tabulce */
+static int interned_index(const char *key)
+{
+  return intern_hash(key) % HT_SIZE;
+}
+
+/*
+ * Vyhledání prvku podle klíče z úložiště, vrací prvek nebo NULL.
+ */
+ht_item_t *ht_interned_search(ht_table_t *table, const char *key)
+{
+  ht_item_t *item = (*table)[interned_index(key)];
+
+  while (item != NULL && item->key != key)
+  {
+    item = item->next;
+  }
+  return item;
+}
+
+/*
+ * Vložení prvku, nebo náhrada hodnoty existujícího prvku. Klíč se
+ * nekopíruje.
+ */
+void ht_interned_insert(ht_table_t *table, const char *key, float value)
+{
+  ht_item_t *existing_item = ht_interned_search(table, key);
+
+  if (existing_item != NULL)
+  {
+    existing_item->value = value;
+    return;
+  }
+
+  ht_item_t *new_item = malloc(sizeof(ht_item_t));
+  if (new_item == NULL)
+    return;
+
+  int index = interned_index(key);
+  new_item->key = (char *)key; // text patří úložišti a nemění se
+  new_item->value = value;
+  new_item->next = (*table)[index];
+  (*table)[index] = new_item;
+}
+
+/*
+ * Získání ukazatele na hodnotu prvku, nebo NULL.
+ */
+float *ht_interned_get(ht_table_t *table, const char *key)
+{
+  ht_item_t *item = ht_interned_search(table, key);
+  return item != NULL ? &item->value : NULL;
+}
+
+/*
+ * Odstranění prvku. Pokud prvek neexistuje, funkce nedělá nic.
+ */
+void ht_interned_delete(ht_table_t *table, const char *key)
+{
+  ht_item_t **link = &(*table)[interned_index(key)];
+
+  while (*link != NULL && (*link)->key != key)
+  {
+    link = &(*link)->next;
+  }
+  if (*link != NULL)
+  {
+    ht_item_t *item = *link;
+    *link = item->next;
+    free(item);
+  }
+}
+
+/*
+ * Odstranění všech prvků; klíče zůstanou v úložišti.
+ */
+void ht_interned_delete_all(ht_table_t *table)
+{
+  for (int i = 0; i < HT_SIZE; i++)
+  {
+    ht_item_t *item = (*table)[i];
+    while (item != NULL)
+    {
+      ht_item_t *next_item = item->next;
+      free(item);
+      item = next_item;
+    }
+    (*table)[i] = NULL;
+  }
+}
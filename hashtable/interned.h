@@ -0,0 +1,18 @@
+/*
+ * Hlavičkový soubor pro tabulku s rozptýlenými položkami s klíči ze
+ * společného úložiště řetězců.
+ */
+
+#ifndef IAL_HASHTABLE_INTERNED_H
+#define IAL_HASHTABLE_INTERNED_H
+
+#include "../common/intern.h"
+#include "hashtable.h"
+
+ht_item_t *ht_interned_search(ht_table_t *table, const char *key);
+void ht_interned_insert(ht_table_t *table, const char *key, float value);
+float *ht_interned_get(ht_table_t *table, const char *key);
+void ht_interned_delete(ht_table_t *table, const char *key);
+void ht_interned_delete_all(ht_table_t *table);
+
+#endif
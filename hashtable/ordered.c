@@ -0,0 +1,325 @@
+/*
+ * Tabulka s rozptýlenými položkami a uspořádaným průchodem
+ *
+ * Každý prvek ht_ordered_item_t začíná prvkem tabulky ht_item_t, který je
+ * zařazený do seznamu synonym, a zároveň je uzlem AVL stromu podle klíče.
+ * Klíč je uložený jen jednou. Vyhledání prochází seznam synonym stejně jako
+ * ht_search, vložení a odstranění upraví seznam i strom.
+ *
+ * Iterátory procházejí strom v pořadí strcmp a vracejí prvky s klíčem
+ * v intervalu <from, to) nebo s daným prefixem. Změna tabulky během
+ * průchodu iterátor zneplatní; meze musí platit po celou dobu průchodu.
+ */
+
+#include "ordered.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Výška podstromu */
+static int ordered_height(ht_ordered_item_t *node)
+{
+  return node != NULL ? node->height : 0;
+}
+
+/* Přepočet výšky uzlu z jeho potomků */
+static void ordered_update(ht_ordered_item_t *node)
+{
+  int left = ordered_height(node->left);
+  int right = ordered_height(node->right);
+  node->height = (left > right ? left : right) + 1;
+}
+
+/* Rotace doprava, vrací nový kořen podstromu */
+static ht_ordered_item_t *ordered_rotate_right(ht_ordered_item_t *node)
+{
+  ht_ordered_item_t *left = node->left;
+  node->left = left->right;
+  left->right = node;
+  ordered_update(node);
+  ordered_update(left);
+  return left;
+}
+
+/* Rotace doleva, vrací nový kořen podstromu */
+static ht_ordered_item_t *ordered_rotate_left(ht_ordered_item_t *node)
+{
+  ht_ordered_item_t *right = node->right;
+  node->right = right->left;
+  right->left = node;
+  ordered_update(node);
+  ordered_update(right);
+  return right;
+}
+
+/*
+ * Vyvážení uzlu po vložení nebo odstranění v jednom z podstromů, vrací
+ * nový kořen podstromu.
+ */
+static ht_ordered_item_t *ordered_balance(ht_ordered_item_t *node)
+{
+  int balance = ordered_height(node->left) - ordered_height(node->right);
+
+  if (balance > 1)
+  {
+    if (ordered_height(node->left->left) < ordered_height(node->left->right))
+    {
+      node->left = ordered_rotate_left(node->left);
+    }
+    return ordered_rotate_right(node);
+  }
+  if (balance < -1)
+  {
+    if (ordered_height(node->right->right) < ordered_height(node->right->left))
+    {
+      node->right = ordered_rotate_right(node->right);
+    }
+    return ordered_rotate_left(node);
+  }
+  ordered_update(node);
+  return node;
+}
+
+/* Zařazení nového uzlu do stromu, klíč ve stromu ještě není */
+static ht_ordered_item_t *ordered_attach(ht_ordered_item_t *node,
+                                         ht_ordered_item_t *item)
+{
+  if (node == NULL)
+  {
+    return item;
+  }
+  if (strcmp(item->item.key, node->item.key) < 0)
+  {
+    node->left = ordered_attach(node->left, item);
+  }
+  else
+  {
+    node->right = ordered_attach(node->right, item);
+  }
+  return ordered_balance(node);
+}
+
+/* Vyjmutí nejlevějšího uzlu podstromu do *min */
+static ht_ordered_item_t *ordered_detach_min(ht_ordered_item_t *node,
+                                             ht_ordered_item_t **min)
+{
+  if (node->left == NULL)
+  {
+    *min = node;
+    return node->right;
+  }
+  node->left = ordered_detach_min(node->left, min);
+  return ordered_balance(node);
+}
+
+/*
+ * Vyjmutí uzlu item ze stromu. Uzel se dvěma potomky nahradí nejlevější
+ * uzel pravého podstromu; uzly se přepojují, nekopírují, protože jsou
+ * zároveň zařazené v seznamech synonym.
+ */
+static ht_ordered_item_t *ordered_detach(ht_ordered_item_t *node,
+                                         ht_ordered_item_t *item)
+{
+  if (node == item)
+  {
+    if (node->right == NULL)
+    {
+      return node->left;
+    }
+    ht_ordered_item_t *min;
+    ht_ordered_item_t *right = ordered_detach_min(node->right, &min);
+    min->left = node->left;
+    min->right = right;
+    return ordered_balance(min);
+  }
+  if (strcmp(item->item.key, node->item.key) < 0)
+  {
+    node->left = ordered_detach(node->left, item);
+  }
+  else
+  {
+    node->right = ordered_detach(node->right, item);
+  }
+  return ordered_balance(node);
+}
+
+/*
+ * Inicializace prázdné tabulky.
+ */
+void ht_ordered_init(ht_ordered_t *ordered)
+{
+  ht_init(&ordered->table);
+  ordered->root = NULL;
+  ordered->size = 0;
+}
+
+/*
+ * Vyhledání prvku podle klíče v seznamu synonym.
+ */
+ht_item_t *ht_ordered_search(ht_ordered_t *ordered, char *key)
+{
+  return ht_search(&ordered->table, key);
+}
+
+/*
+ * Vložení nového prvku, nebo náhrada hodnoty existujícího prvku.
+ */
+void ht_ordered_insert(ht_ordered_t *ordered, char *key, float value)
+{
+  ht_item_t *existing_item = ht_search(&ordered->table, key);
+
+  if (existing_item != NULL)
+  {
+    existing_item->value = value;
+    return;
+  }
+
+  ht_ordered_item_t *new_item = malloc(sizeof(ht_ordered_item_t));
+  if (new_item == NULL)
+    return;
+  new_item->item.key = malloc(strlen(key) + 1);
+  if (new_item->item.key == NULL)
+  {
+    free(new_item);
+    return;
+  }
+  strcpy(new_item->item.key, key);
+  new_item->item.value = value;
+  new_item->left = NULL;
+  new_item->right = NULL;
+  new_item->height = 1;
+
+  int index = get_hash(key);
+  new_item->item.next = ordered->table[index];
+  ordered->table[index] = &new_item->item;
+  ordered->root = ordered_attach(ordered->root, new_item);
+  ordered->size++;
+}
+
+/*
+ * Získání ukazatele na hodnotu prvku, nebo NULL.
+ */
+float *ht_ordered_get(ht_ordered_t *ordered, char *key)
+{
+  ht_item_t *item = ht_search(&ordered->table, key);
+  return item != NULL ? &item->value : NULL;
+}
+
+/*
+ * Odstranění prvku ze seznamu synonym i ze stromu. Pokud prvek neexistuje,
+ * funkce nedělá nic.
+ */
+void ht_ordered_delete(ht_ordered_t *ordered, char *key)
+{
+  int index = get_hash(key);
+  ht_item_t **link = &ordered->table[index];
+
+  while (*link != NULL && strcmp((*link)->key, key) != 0)
+  {
+    link = &(*link)->next;
+  }
+  if (*link == NULL)
+    return;
+
+  ht_ordered_item_t *item = (ht_ordered_item_t *)*link;
+  *link = item->item.next;
+  ordered->root = ordered_detach(ordered->root, item);
+  ordered->size--;
+  free(item->item.key);
+  free(item);
+}
+
+/*
+ * Odstranění všech prvků, tabulka zůstane ve stavu po inicializaci.
+ */
+void ht_ordered_delete_all(ht_ordered_t *ordered)
+{
+  for (int i = 0; i < HT_SIZE; i++)
+  {
+    ht_item_t *item = ordered->table[i];
+    while (item != NULL)
+    {
+      ht_item_t *next_item = item->next;
+      free(item->key);
+      free((ht_ordered_item_t *)item);
+      item = next_item;
+    }
+    ordered->table[i] = NULL;
+  }
+  ordered->root = NULL;
+  ordered->size = 0;
+}
+
+/*
+ * Pomocná funkce pro nastavení iterátoru na první klíč větší nebo rovný
+ * from; zásobník obsahuje uzly, jejichž levý podstrom už byl zpracován.
+ */
+static void ordered_seek(ht_ordered_t *ordered, ht_ordered_iter_t *iter,
+                         const char *from)
+{
+  ht_ordered_item_t *node = ordered->root;
+
+  iter->top = 0;
+  while (node != NULL)
+  {
+    if (from == NULL || strcmp(from, node->item.key) <= 0)
+    {
+      iter->stack[iter->top++] = node;
+      node = node->left;
+    }
+    else
+    {
+      node = node->right;
+    }
+  }
+}
+
+/*
+ * Průchod prvky s klíčem v intervalu <from, to). Mez NULL znamená
+ * neomezený interval z dané strany.
+ */
+void ht_ordered_range(ht_ordered_t *ordered, ht_ordered_iter_t *iter,
+                      const char *from, const char *to)
+{
+  ordered_seek(ordered, iter, from);
+  iter->to = to;
+  iter->prefix = NULL;
+  iter->prefix_length = 0;
+}
+
+/*
+ * Průchod prvky, jejichž klíč začíná řetězcem prefix.
+ */
+void ht_ordered_prefix(ht_ordered_t *ordered, ht_ordered_iter_t *iter,
+                       const char *prefix)
+{
+  ordered_seek(ordered, iter, prefix);
+  iter->to = NULL;
+  iter->prefix = prefix;
+  iter->prefix_length = strlen(prefix);
+}
+
+/*
+ * Další prvek průchodu, nebo NULL po jeho konci.
+ */
+ht_item_t *ht_ordered_next(ht_ordered_iter_t *iter)
+{
+  if (iter->top == 0)
+  {
+    return NULL;
+  }
+
+  ht_ordered_item_t *item = iter->stack[--iter->top];
+  if ((iter->to != NULL && strcmp(item->item.key, iter->to) >= 0) ||
+      (iter->prefix != NULL &&
+       strncmp(item->item.key, iter->prefix, iter->prefix_length) != 0))
+  {
+    iter->top = 0;
+    return NULL;
+  }
+
+  for (ht_ordered_item_t *node = item->right; node != NULL; node = node->left)
+  {
+    iter->stack[iter->top++] = node;
+  }
+  return &item->item;
+}
@@ -0,0 +1,52 @@
+/*
+ * Hlavičkový soubor pro tabulku s rozptýlenými položkami a uspořádaným
+ * průchodem.
+ */
+
+#ifndef IAL_HASHTABLE_ORDERED_H
+#define IAL_HASHTABLE_ORDERED_H
+
+#include "hashtable.h"
+#include <stddef.h>
+
+// Největší výška AVL stromu (stačí pro více než 2^44 položek)
+#define HT_ORDERED_MAX_HEIGHT 64
+
+// Prvek tabulky zařazený zároveň do AVL stromu podle klíče
+typedef struct ht_ordered_item {
+  ht_item_t item;                // prvek tabulky, musí být první
+  struct ht_ordered_item *left;  // menší klíče
+  struct ht_ordered_item *right; // větší klíče
+  int height;                    // výška podstromu
+} ht_ordered_item_t;
+
+// Tabulka se stromem nad stejnými prvky
+typedef struct ht_ordered {
+  ht_table_t table;        // seznamy synonym
+  ht_ordered_item_t *root; // kořen AVL stromu
+  size_t size;             // počet prvků
+} ht_ordered_t;
+
+// Iterátor přes interval nebo prefix klíčů
+typedef struct ht_ordered_iter {
+  ht_ordered_item_t *stack[HT_ORDERED_MAX_HEIGHT]; // cesta k dalšímu prvku
+  int top;                                         // počet prvků zásobníku
+  const char *to;     // horní mez (nezahrnutá), nebo NULL
+  const char *prefix; // požadovaný prefix, nebo NULL
+  size_t prefix_length;
+} ht_ordered_iter_t;
+
+void ht_ordered_init(ht_ordered_t *ordered);
+ht_item_t *ht_ordered_search(ht_ordered_t *ordered, char *key);
+void ht_ordered_insert(ht_ordered_t *ordered, char *key, float value);
+float *ht_ordered_get(ht_ordered_t *ordered, char *key);
+void ht_ordered_delete(ht_ordered_t *ordered, char *key);
+void ht_ordered_delete_all(ht_ordered_t *ordered);
+
+void ht_ordered_range(ht_ordered_t *ordered, ht_ordered_iter_t *iter,
+                      const char *from, const char *to);
+void ht_ordered_prefix(ht_ordered_t *ordered, ht_ordered_iter_t *iter,
+                       const char *prefix);
+ht_item_t *ht_ordered_next(ht_ordered_iter_t *iter);
+
+#endif
@@ -0,0 +1,95 @@
+/*
+ * Měřené obaly operací tabulky s rozptýlenými položkami
+ *
+ * Každý obal zavolá původní operaci mezi perf_begin a perf_end a výsledek
+ * přičte do souhrnu své operace. Volání ht_search uvnitř ht_insert a ht_get
+ * obaly neprocházejí a započítají se jen do volající operace.
+ */
+
+#define HT_PERF_NO_REDIRECT
+
+#include "perf.h"
+#include "../common/perf.h"
+
+// Souhrny operací
+static perf_op_t ht_perf_ops[HT_PERF_OPS] = {
+    [HT_PERF_INIT] = PERF_OP("ht_init"),
+    [HT_PERF_SEARCH] = PERF_OP("ht_search"),
+    [HT_PERF_INSERT] = PERF_OP("ht_insert"),
+    [HT_PERF_GET] = PERF_OP("ht_get"),
+    [HT_PERF_DELETE] = PERF_OP("ht_delete"),
+    [HT_PERF_DELETE_ALL] = PERF_OP("ht_delete_all")};
+
+void ht_perf_init(ht_table_t *table)
+{
+  perf_sample_t sample;
+  perf_begin(&sample);
+  ht_init(table);
+  perf_end(&ht_perf_ops[HT_PERF_INIT], &sample);
+}
+
+ht_item_t *ht_perf_search(ht_table_t *table, char *key)
+{
+  perf_sample_t sample;
+  perf_begin(&sample);
+  ht_item_t *result = ht_search(table, key);
+  perf_end(&ht_perf_ops[HT_PERF_SEARCH], &sample);
+  return result;
+}
+
+void ht_perf_insert(ht_table_t *table, char *key, float value)
+{
+  perf_sample_t sample;
+  perf_begin(&sample);
+  ht_insert(table, key, value);
+  perf_end(&ht_perf_ops[HT_PERF_INSERT], &sample);
+}
+
+float *ht_perf_get(ht_table_t *table, char *key)
+{
+  perf_sample_t sample;
+  perf_begin(&sample);
+  float *result = ht_get(table, key);
+  perf_end(&ht_perf_ops[HT_PERF_GET], &sample);
+  return result;
+}
+
+void ht_perf_delete(ht_table_t *table, char *key)
+{
+  perf_sample_t sample;
+  perf_begin(&sample);
+  ht_delete(table, key);
+  perf_end(&ht_perf_ops[HT_PERF_DELETE], &sample);
+}
+
+void ht_perf_delete_all(ht_table_t *table)
+{
+  perf_sample_t sample;
+  perf_begin(&sample);
+  ht_delete_all(table);
+  perf_end(&ht_perf_ops[HT_PERF_DELETE_ALL], &sample);
+}
+
+/*
+ * Počet volání operace op od začátku nebo od posledního ht_perf_reset.
+ */
+uint64_t ht_perf_calls(ht_perf_op_t op)
+{
+  return atomic_load(&ht_perf_ops[op].calls);
+}
+
+/*
+ * Výpis souhrnů operací tabulky ve formátu CSV.
+ */
+void ht_perf_report(FILE *stream)
+{
+  perf_report(stream, ht_perf_ops, HT_PERF_OPS);
+}
+
+/*
+ * Vynulování souhrnů operací tabulky.
+ */
+void ht_perf_reset(void)
+{
+  perf_reset(ht_perf_ops, HT_PERF_OPS);
+}
@@ -0,0 +1,57 @@
+/*
+ * Hlavičkový soubor pro měření operací tabulky s rozptýlenými položkami.
+ *
+ * Při překladu s -DIAL_PERF přesměruje veřejné operace z hashtable.h na
+ * měřené obaly. Soubor se vkládá až za hashtable.h. Bez IAL_PERF zůstávají
+ * volání přímá a HT_PERF_REPORT se přeloží na prázdný příkaz.
+ */
+
+#ifndef IAL_HASHTABLE_PERF_H
+#define IAL_HASHTABLE_PERF_H
+
+#include "hashtable.h"
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef IAL_PERF
+
+// Měřené operace
+typedef enum ht_perf_op {
+  HT_PERF_INIT,
+  HT_PERF_SEARCH,
+  HT_PERF_INSERT,
+  HT_PERF_GET,
+  HT_PERF_DELETE,
+  HT_PERF_DELETE_ALL,
+  HT_PERF_OPS
+} ht_perf_op_t;
+
+void ht_perf_init(ht_table_t *table);
+ht_item_t *ht_perf_search(ht_table_t *table, char *key);
+void ht_perf_insert(ht_table_t *table, char *key, float value);
+float *ht_perf_get(ht_table_t *table, char *key);
+void ht_perf_delete(ht_table_t *table, char *key);
+void ht_perf_delete_all(ht_table_t *table);
+
+uint64_t ht_perf_calls(ht_perf_op_t op);
+void ht_perf_report(FILE *stream);
+void ht_perf_reset(void);
+
+#ifndef HT_PERF_NO_REDIRECT
+#define ht_init(table) ht_perf_init(table)
+#define ht_search(table, key) ht_perf_search(table, key)
+#define ht_insert(table, key, value) ht_perf_insert(table, key, value)
+#define ht_get(table, key) ht_perf_get(table, key)
+#define ht_delete(table, key) ht_perf_delete(table, key)
+#define ht_delete_all(table) ht_perf_delete_all(table)
+#endif
+
+#define HT_PERF_REPORT(stream) ht_perf_report(stream)
+
+#else
+
+#define HT_PERF_REPORT(stream) ((void)0)
+
+#endif // IAL_PERF
+
+#endif
@@ -0,0 +1,332 @@
+/*
+ * Tabulka rozdělená na úseky vlastněné vlákny
+ *
+ * Klíče se podle hashe (jiného než get_hash, aby se úseky nepřekrývaly se
+ * seznamy synonym) rozdělí do úseků. Každý úsek je obyčejná tabulka
+ * ht_table_t, se kterou pracuje výhradně vlákno vlastníka pomocí funkcí
+ * z hashtable.c, takže nepotřebuje žádné zámky.
+ *
+ * Ostatní vlákna posílají požadavky přes frontu úseku s více zapisujícími
+ * a jedním čtenářem bez zámků (kruhové pole s pořadovými čísly míst).
+ * Vlastník vybírá nejvýše HT_SHARDED_BATCH požadavků najednou, výsledky
+ * zapisuje přímo do požadavků a dokončení ohlašuje jedním atomickým
+ * odečtením za každý souvislý úsek požadavků téže dávky. Zadavatel čeká,
+ * až počítadlo nedokončených požadavků jeho dávky klesne na nulu.
+ *
+ * Vlastník bez požadavků chvíli uvolňuje procesor a pak usne na podmínkové
+ * proměnné; zadavatel ho budí jen tehdy, když spí.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "hash.h"
+#include "sharded.h"
+#include <sched.h>
+#include <stdlib.h>
+
+// Počet prázdných průchodů frontou, než vlastník úseku usne
+#define HT_SHARDED_SPINS 64
+
+/* Úsek pro klíč */
+static int sharded_index(ht_sharded_t *sharded, const char *key)
+{
+  return ht_hash64(key, 0) % sharded->count;
+}
+
+/* Probuzení spícího vlastníka úseku */
+static void sharded_wake(ht_shard_t *shard)
+{
+  // Zápis požadavku musí být viditelný dřív, než se přečte příznak spánku.
+  atomic_thread_fence(memory_order_seq_cst);
+  if (atomic_load(&shard->sleeping))
+  {
+    pthread_mutex_lock(&shard->lock);
+    pthread_cond_signal(&shard->wake);
+    pthread_mutex_unlock(&shard->lock);
+  }
+}
+
+/*
+ * Zařazení požadavku do fronty úseku. Při plné frontě se vlastník probudí
+ * a čeká se na uvolnění místa.
+ */
+static void sharded_enqueue(ht_shard_t *shard, ht_sharded_request_t *request,
+                            atomic_long *pending)
+{
+  size_t position = atomic_load_explicit(&shard->tail, memory_order_relaxed);
+
+  for (;;)
+  {
+    ht_sharded_slot_t *slot = &shard->slots[position % HT_SHARDED_QUEUE];
+    size_t sequence =
+        atomic_load_explicit(&slot->sequence, memory_order_acquire);
+
+    if (sequence == position)
+    {
+      if (atomic_compare_exchange_weak_explicit(&shard->tail, &position,
+                                                position + 1,
+                                                memory_order_relaxed,
+                                                memory_order_relaxed))
+      {
+        slot->request = request;
+        slot->pending = pending;
+        atomic_store_explicit(&slot->sequence, position + 1,
+                              memory_order_release);
+        return;
+      }
+    }
+    else if (sequence < position)
+    {
+      sharded_wake(shard);
+      sched_yield();
+      position = atomic_load_explicit(&shard->tail, memory_order_relaxed);
+    }
+    else
+    {
+      position = atomic_load_explicit(&shard->tail, memory_order_relaxed);
+    }
+  }
+}
+
+/* Provedení požadavku nad tabulkou úseku */
+static void sharded_execute(ht_shard_t *shard, ht_sharded_request_t *request)
+{
+  switch (request->op)
+  {
+  case HT_SHARDED_INSERT:
+    ht_insert(&shard->table, request->key, request->value);
+    break;
+  case HT_SHARDED_DELETE:
+    ht_delete(&shard->table, request->key);
+    break;
+  case HT_SHARDED_GET:
+  {
+    float *value = ht_get(&shard->table, request->key);
+    request->found = value != NULL;
+    if (value != NULL)
+    {
+      request->value = *value;
+    }
+    break;
+  }
+  }
+}
+
+/*
+ * Zpracování nejvýše HT_SHARDED_BATCH požadavků z fronty, vrací jejich
+ * počet.
+ */
+static int sharded_drain(ht_shard_t *shard)
+{
+  atomic_long *pending = NULL;
+  long done = 0;
+  int count = 0;
+
+  for (; count < HT_SHARDED_BATCH; count++)
+  {
+    ht_sharded_slot_t *slot = &shard->slots[shard->head % HT_SHARDED_QUEUE];
+    if (atomic_load_explicit(&slot->sequence, memory_order_acquire) !=
+        shard->head + 1)
+    {
+      break;
+    }
+
+    ht_sharded_request_t *request = slot->request;
+    atomic_long *slot_pending = slot->pending;
+    atomic_store_explicit(&slot->sequence, shard->head + HT_SHARDED_QUEUE,
+                          memory_order_release);
+    shard->head++;
+
+    sharded_execute(shard, request);
+    if (slot_pending != pending && pending != NULL)
+    {
+      atomic_fetch_sub_explicit(pending, done, memory_order_release);
+      done = 0;
+    }
+    pending = slot_pending;
+    done++;
+  }
+
+  if (pending != NULL)
+  {
+    atomic_fetch_sub_explicit(pending, done, memory_order_release);
+  }
+  return count;
+}
+
+/* Fronta úseku je prázdná */
+static bool sharded_empty(ht_shard_t *shard)
+{
+  ht_sharded_slot_t *slot = &shard->slots[shard->head % HT_SHARDED_QUEUE];
+  return atomic_load(&slot->sequence) != shard->head + 1;
+}
+
+/* Vlákno vlastníka úseku */
+static void *sharded_worker(void *argument)
+{
+  ht_shard_t *shard = argument;
+  int idle = 0;
+
+  while (!atomic_load(&shard->stop) || !sharded_empty(shard))
+  {
+    if (sharded_drain(shard) > 0)
+    {
+      idle = 0;
+      continue;
+    }
+    if (++idle < HT_SHARDED_SPINS)
+    {
+      sched_yield();
+      continue;
+    }
+
+    pthread_mutex_lock(&shard->lock);
+    atomic_store(&shard->sleeping, true);
+    while (sharded_empty(shard) && !atomic_load(&shard->stop))
+    {
+      pthread_cond_wait(&shard->wake, &shard->lock);
+    }
+    atomic_store(&shard->sleeping, false);
+    pthread_mutex_unlock(&shard->lock);
+    idle = 0;
+  }
+  return NULL;
+}
+
+/* Ukončení vlákna a uvolnění úseku */
+static void sharded_free(ht_shard_t *shard)
+{
+  atomic_store(&shard->stop, true);
+  pthread_mutex_lock(&shard->lock);
+  pthread_cond_signal(&shard->wake);
+  pthread_mutex_unlock(&shard->lock);
+  pthread_join(shard->thread, NULL);
+
+  ht_delete_all(&shard->table);
+  pthread_cond_destroy(&shard->wake);
+  pthread_mutex_destroy(&shard->lock);
+  free(shard);
+}
+
+/*
+ * Inicializace tabulky s count úseky a spuštění jejich vláken. Vrací false,
+ * pokud se úsek nebo vlákno nepodařilo vytvořit.
+ */
+bool ht_sharded_init(ht_sharded_t *sharded, int count)
+{
+  if (count < 1 || count > HT_SHARDED_MAX_SHARDS)
+  {
+    return false;
+  }
+
+  sharded->count = 0;
+  for (int i = 0; i < count; i++)
+  {
+    ht_shard_t *shard = aligned_alloc(_Alignof(ht_shard_t), sizeof(ht_shard_t));
+    if (shard == NULL)
+    {
+      ht_sharded_dispose(sharded);
+      return false;
+    }
+
+    atomic_init(&shard->tail, 0);
+    shard->head = 0;
+    for (size_t s = 0; s < HT_SHARDED_QUEUE; s++)
+    {
+      atomic_init(&shard->slots[s].sequence, s);
+    }
+    atomic_init(&shard->sleeping, false);
+    atomic_init(&shard->stop, false);
+    pthread_mutex_init(&shard->lock, NULL);
+    pthread_cond_init(&shard->wake, NULL);
+    ht_init(&shard->table);
+
+    if (pthread_create(&shard->thread, NULL, sharded_worker, shard) != 0)
+    {
+      pthread_cond_destroy(&shard->wake);
+      pthread_mutex_destroy(&shard->lock);
+      free(shard);
+      ht_sharded_dispose(sharded);
+      return false;
+    }
+    sharded->shards[sharded->count++] = shard;
+  }
+  return true;
+}
+
+/*
+ * Provedení dávky count požadavků. Požadavky se rozešlou vlastníkům
+ * příslušných úseků a funkce čeká na dokončení všech. Požadavky se stejným
+ * klíčem se provedou v pořadí v poli.
+ */
+void ht_sharded_submit(ht_sharded_t *sharded, ht_sharded_request_t requests[],
+                       int count)
+{
+  atomic_long pending;
+  bool touched[HT_SHARDED_MAX_SHARDS] = {false};
+
+  atomic_init(&pending, count);
+  for (int i = 0; i < count; i++)
+  {
+    int index = sharded_index(sharded, requests[i].key);
+    requests[i].found = false;
+    sharded_enqueue(sharded->shards[index], &requests[i], &pending);
+    touched[index] = true;
+  }
+  for (int i = 0; i < sharded->count; i++)
+  {
+    if (touched[i])
+    {
+      sharded_wake(sharded->shards[i]);
+    }
+  }
+
+  while (atomic_load_explicit(&pending, memory_order_acquire) > 0)
+  {
+    sched_yield();
+  }
+}
+
+/*
+ * Vložení prvku, nebo náhrada hodnoty existujícího prvku.
+ */
+void ht_sharded_insert(ht_sharded_t *sharded, char *key, float value)
+{
+  ht_sharded_request_t request = {HT_SHARDED_INSERT, key, value, false};
+  ht_sharded_submit(sharded, &request, 1);
+}
+
+/*
+ * Získání hodnoty prvku do *value, vrací false pokud prvek neexistuje.
+ */
+bool ht_sharded_get(ht_sharded_t *sharded, char *key, float *value)
+{
+  ht_sharded_request_t request = {HT_SHARDED_GET, key, 0, false};
+  ht_sharded_submit(sharded, &request, 1);
+  if (request.found)
+  {
+    *value = request.value;
+  }
+  return request.found;
+}
+
+/*
+ * Odstranění prvku. Pokud prvek neexistuje, funkce nedělá nic.
+ */
+void ht_sharded_delete(ht_sharded_t *sharded, char *key)
+{
+  ht_sharded_request_t request = {HT_SHARDED_DELETE, key, 0, false};
+  ht_sharded_submit(sharded, &request, 1);
+}
+
+/*
+ * Ukončení vláken a uvolnění všech úseků i prvků.
+ */
+void ht_sharded_dispose(ht_sharded_t *sharded)
+{
+  for (int i = 0; i < sharded->count; i++)
+  {
+    sharded_free(sharded->shards[i]);
+  }
+  sharded->count = 0;
+}
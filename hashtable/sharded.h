@@ -0,0 +1,71 @@
+/*
+ * Hlavičkový soubor pro tabulku rozdělenou na úseky vlastněné vlákny.
+ */
+
+#ifndef IAL_HASHTABLE_SHARDED_H
+#define IAL_HASHTABLE_SHARDED_H
+
+#include "hashtable.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+
+// Největší počet úseků
+#define HT_SHARDED_MAX_SHARDS 64
+
+// Kapacita fronty požadavků jednoho úseku (mocnina dvou)
+#define HT_SHARDED_QUEUE 1024
+
+// Největší počet požadavků zpracovaných vlastníkem úseku najednou
+#define HT_SHARDED_BATCH 64
+
+// Operace požadavku
+typedef enum ht_sharded_op {
+  HT_SHARDED_INSERT, // vložení nebo náhrada hodnoty
+  HT_SHARDED_DELETE, // odstranění
+  HT_SHARDED_GET     // získání hodnoty
+} ht_sharded_op_t;
+
+// Požadavek na úsek; klíč musí platit do dokončení dávky
+typedef struct ht_sharded_request {
+  ht_sharded_op_t op; // operace
+  char *key;          // klíč
+  float value;        // vkládaná nebo získaná hodnota
+  bool found;         // HT_SHARDED_GET našel klíč
+} ht_sharded_request_t;
+
+// Místo ve frontě požadavků
+typedef struct ht_sharded_slot {
+  atomic_size_t sequence;        // pořadí, pro které je místo volné/plné
+  ht_sharded_request_t *request; // požadavek
+  atomic_long *pending;          // počítadlo nedokončených požadavků dávky
+} ht_sharded_slot_t;
+
+// Úsek tabulky, se kterým pracuje jen jeho vlákno
+typedef struct ht_shard {
+  _Alignas(64) atomic_size_t tail;           // další místo pro zápis
+  _Alignas(64) size_t head;                  // další místo pro čtení
+  ht_sharded_slot_t slots[HT_SHARDED_QUEUE]; // fronta požadavků
+  atomic_bool sleeping;                      // vlákno čeká na požadavky
+  atomic_bool stop;                          // vlákno má skončit
+  pthread_mutex_t lock;                      // zámek pro čekání
+  pthread_cond_t wake;                       // probuzení vlákna
+  pthread_t thread;                          // vlákno vlastníka
+  ht_table_t table;                          // tabulka úseku
+} ht_shard_t;
+
+// Tabulka rozdělená podle hashe klíče
+typedef struct ht_sharded {
+  int count;                                  // počet úseků
+  ht_shard_t *shards[HT_SHARDED_MAX_SHARDS]; // úseky
+} ht_sharded_t;
+
+bool ht_sharded_init(ht_sharded_t *sharded, int count);
+void ht_sharded_submit(ht_sharded_t *sharded, ht_sharded_request_t requests[],
+                       int count);
+void ht_sharded_insert(ht_sharded_t *sharded, char *key, float value);
+bool ht_sharded_get(ht_sharded_t *sharded, char *key, float *value);
+void ht_sharded_delete(ht_sharded_t *sharded, char *key);
+void ht_sharded_dispose(ht_sharded_t *sharded);
+
+#endif
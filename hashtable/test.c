@@ -1,5 +1,15 @@
+#include "bloom.h"
+#include "cache.h"
+#include "cuckoo.h"
+#include "dump.h"
+#include "frozen.h"
 #include "hashtable.h"
+#include "interned.h"
+#include "ordered.h"
+#include "perf.h"
+#include "sharded.h"
 #include "test_util.h"
+#include "upsert.h"
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -76,6 +86,331 @@ INSERT_TEST_DATA(test_table)
 ht_delete_all(test_table);
 ENDTEST
 
+TEST(test_dump_binary, "Dump the table in the binary format")
+ht_init(test_table);
+ht_insert(test_table, "Tether", 0.86);
+ht_insert(test_table, "XRP", 0.93);
+FILE *stream = tmpfile();
+writer_t *writer = malloc(sizeof(writer_t));
+writer_init(writer, stream);
+ht_dump_binary(writer, test_table);
+writer_flush(writer);
+free(writer);
+long length = ftell(stream);
+rewind(stream);
+printf("Dump (%ld bytes):", length);
+for (int c = fgetc(stream); c != EOF; c = fgetc(stream)) {
+  printf(" %02x", c);
+}
+printf("\n");
+fclose(stream);
+ENDTEST
+
+TEST(test_ordered_range, "Iterate an ordered table by key range")
+ht_init(test_table);
+ht_ordered_t *ordered = malloc(sizeof(ht_ordered_t));
+ht_ordered_iter_t iter;
+ht_ordered_init(ordered);
+for (int i = 0; i < 15; i++) {
+  ht_ordered_insert(ordered, TEST_DATA[i].key, TEST_DATA[i].value);
+}
+ht_ordered_insert(ordered, "Ethereum", 12.34);
+ht_ordered_delete(ordered, "Terra");
+ht_ordered_delete(ordered, "Monero");
+ht_ordered_range(ordered, &iter, NULL, NULL);
+ht_print_iter(&iter);
+ht_ordered_range(ordered, &iter, "C", "Polkadot");
+ht_print_iter(&iter);
+ht_ordered_range(ordered, &iter, "Z", NULL);
+ht_print_iter(&iter);
+ht_print_item_value(ht_ordered_get(ordered, "Ethereum"));
+ht_print_table(&ordered->table);
+ht_ordered_delete_all(ordered);
+free(ordered);
+ENDTEST
+
+TEST(test_ordered_prefix, "Iterate an ordered table by key prefix")
+ht_init(test_table);
+ht_ordered_t *ordered = malloc(sizeof(ht_ordered_t));
+ht_ordered_iter_t iter;
+ht_ordered_init(ordered);
+for (int i = 0; i < 15; i++) {
+  ht_ordered_insert(ordered, TEST_DATA[i].key, TEST_DATA[i].value);
+}
+ht_ordered_insert(ordered, "Binance USD", 1.00);
+ht_ordered_prefix(ordered, &iter, "Bi");
+ht_print_iter(&iter);
+ht_ordered_prefix(ordered, &iter, "Binance ");
+ht_print_iter(&iter);
+ht_ordered_prefix(ordered, &iter, "Bitcoin Cash");
+ht_print_iter(&iter);
+ht_ordered_prefix(ordered, &iter, "");
+ht_print_iter(&iter);
+ht_ordered_delete_all(ordered);
+free(ordered);
+ENDTEST
+
+TEST(test_cuckoo, "Insert, search and delete in a cuckoo table")
+ht_init(test_table);
+ht_cuckoo_t *cuckoo = malloc(sizeof(ht_cuckoo_t));
+ht_cuckoo_init(cuckoo);
+ht_print_item(ht_cuckoo_search(cuckoo, "Ethereum"));
+for (int i = 0; i < 15; i++) {
+  ht_cuckoo_insert(cuckoo, TEST_DATA[i].key, TEST_DATA[i].value);
+}
+ht_cuckoo_insert(cuckoo, "Ethereum", 12.34);
+ht_cuckoo_delete(cuckoo, "Terra");
+ht_cuckoo_delete(cuckoo, "Monero");
+ht_print_item(ht_cuckoo_search(cuckoo, "Ethereum"));
+ht_print_item(ht_cuckoo_search(cuckoo, "Terra"));
+ht_print_item_value(ht_cuckoo_get(cuckoo, "Bitcoin"));
+ht_print_item_value(ht_cuckoo_get(cuckoo, "Monero"));
+printf("Items: %zu, buckets: %zu\n", cuckoo->size, cuckoo->mask + 1);
+ht_cuckoo_delete_all(cuckoo);
+free(cuckoo);
+ENDTEST
+
+TEST(test_cuckoo_grow, "Grow a cuckoo table under high load")
+ht_init(test_table);
+ht_cuckoo_t *cuckoo = malloc(sizeof(ht_cuckoo_t));
+char key[16];
+int found = 0;
+ht_cuckoo_init(cuckoo);
+for (int i = 0; i < 1000; i++) {
+  snprintf(key, sizeof(key), "key%d", i);
+  ht_cuckoo_insert(cuckoo, key, i);
+}
+for (int i = 0; i < 1000; i += 2) {
+  snprintf(key, sizeof(key), "key%d", i);
+  ht_cuckoo_delete(cuckoo, key);
+}
+for (int i = 0; i < 1000; i++) {
+  snprintf(key, sizeof(key), "key%d", i);
+  float *value = ht_cuckoo_get(cuckoo, key);
+  found += value != NULL && *value == i;
+}
+printf("Found: %d, items: %zu, buckets: %zu\n", found, cuckoo->size,
+       cuckoo->mask + 1);
+ht_cuckoo_delete_all(cuckoo);
+free(cuckoo);
+ENDTEST
+
+TEST(test_sharded, "Batch requests to a sharded table")
+ht_init(test_table);
+ht_sharded_t *sharded = malloc(sizeof(ht_sharded_t));
+ht_sharded_request_t batch[17];
+ht_sharded_init(sharded, 3);
+for (int i = 0; i < 15; i++) {
+  batch[i].op = HT_SHARDED_INSERT;
+  batch[i].key = TEST_DATA[i].key;
+  batch[i].value = TEST_DATA[i].value;
+}
+batch[15] = (ht_sharded_request_t){HT_SHARDED_INSERT, "Ethereum", 12.34};
+batch[16] = (ht_sharded_request_t){HT_SHARDED_DELETE, "Terra"};
+ht_sharded_submit(sharded, batch, 17);
+for (int i = 0; i < 4; i++) {
+  batch[i].op = HT_SHARDED_GET;
+}
+batch[0].key = "Ethereum";
+batch[1].key = "Terra";
+batch[2].key = "Bitcoin";
+batch[3].key = "Monero";
+ht_sharded_submit(sharded, batch, 4);
+for (int i = 0; i < 4; i++) {
+  printf("%s: ", batch[i].key);
+  ht_print_item_value(batch[i].found ? &batch[i].value : NULL);
+}
+int count = 0;
+for (int i = 0; i < sharded->count; i++) {
+  for (int j = 0; j < HT_SIZE; j++) {
+    for (ht_item_t *item = sharded->shards[i]->table[j]; item != NULL;
+         item = item->next) {
+      count++;
+    }
+  }
+}
+printf("Items: %d\n", count);
+ht_sharded_dispose(sharded);
+free(sharded);
+ENDTEST
+
+// Čas pro testy doby platnosti v cache
+static uint64_t test_clock_now;
+
+static uint64_t test_clock(void) { return test_clock_now; }
+
+TEST(test_cache_lru, "Evict least recently used items from a cache")
+ht_init(test_table);
+ht_cache_t *cache = malloc(sizeof(ht_cache_t));
+ht_cache_init(cache, 4, 0);
+for (int i = 0; i < 4; i++) {
+  ht_cache_insert(cache, TEST_DATA[i].key, TEST_DATA[i].value);
+}
+ht_cache_get(cache, "Bitcoin");
+ht_cache_insert(cache, "Tether", 0.86);
+ht_cache_insert(cache, "Cardano", 1.99);
+ht_cache_insert(cache, "XRP", 0.93);
+ht_print_item_value(ht_cache_get(cache, "Ethereum"));
+ht_print_item_value(ht_cache_get(cache, "Bitcoin"));
+ht_print_item_value(ht_cache_get(cache, "Cardano"));
+for (ht_cache_item_t *item = cache->newest; item != NULL; item = item->older) {
+  ht_print_item(&item->item);
+}
+printf("Items: %zu, hits: %llu, misses: %llu, evictions: %llu, rate: %.2f\n",
+       cache->size, (unsigned long long)cache->stats.hits,
+       (unsigned long long)cache->stats.misses,
+       (unsigned long long)cache->stats.evictions, ht_cache_hit_rate(cache));
+ht_cache_delete_all(cache);
+free(cache);
+ENDTEST
+
+TEST(test_cache_ttl, "Expire cache items lazily")
+ht_init(test_table);
+ht_cache_t *cache = malloc(sizeof(ht_cache_t));
+ht_cache_init(cache, 0, 3 * (sizeof(ht_cache_item_t) + 9));
+cache->clock = test_clock;
+cache->ttl = 100;
+test_clock_now = 1000;
+ht_cache_insert(cache, "Bitcoin", 53247.71);
+ht_cache_insert_ttl(cache, "Ethereum", 3208.67, 0);
+test_clock_now = 1050;
+ht_cache_insert(cache, "Litecoin", 156.87);
+ht_cache_insert(cache, "Polkadot", 34.99);
+test_clock_now = 1120;
+ht_print_item_value(ht_cache_get(cache, "Bitcoin"));
+ht_print_item_value(ht_cache_get(cache, "Ethereum"));
+ht_print_item_value(ht_cache_get(cache, "Litecoin"));
+test_clock_now = 1150;
+ht_print_item(ht_cache_search(cache, "Litecoin"));
+printf("Items: %zu, bytes: %zu, expirations: %llu, evictions: %llu\n",
+       cache->size, cache->bytes,
+       (unsigned long long)cache->stats.expirations,
+       (unsigned long long)cache->stats.evictions);
+ht_cache_delete_all(cache);
+free(cache);
+ENDTEST
+
+TEST(test_interned, "Key a table by interned strings")
+ht_init(test_table);
+intern_pool_t *pool = malloc(sizeof(intern_pool_t));
+char copy[16] = "Bitcoin";
+intern_init(pool);
+for (int round = 0; round < 2; round++) {
+  for (int i = 0; i < 15; i++) {
+    ht_interned_insert(test_table, intern(pool, TEST_DATA[i].key),
+                       TEST_DATA[i].value + round);
+  }
+}
+const char *bitcoin = intern(pool, copy);
+printf("Same handle: %s, length: %zu\n",
+       bitcoin == intern_find(pool, "Bitcoin") ? "yes" : "no",
+       intern_length(bitcoin));
+ht_print_item(ht_interned_search(test_table, bitcoin));
+ht_interned_delete(test_table, intern(pool, "Terra"));
+ht_print_item_value(ht_interned_get(test_table, intern_find(pool, "Terra")));
+printf("Missing: %s\n", intern_find(pool, "Monero") == NULL ? "NULL" : "?");
+printf("Strings: %zu, bytes: %zu, requested: %zu, deduplicated: %zu\n",
+       pool->stats.strings, pool->stats.bytes, pool->stats.requested_bytes,
+       intern_deduplicated_bytes(pool));
+ht_print_table(test_table);
+ht_interned_delete_all(test_table);
+intern_dispose(pool);
+free(pool);
+ENDTEST
+
+TEST(test_frozen, "Freeze a table into a minimal perfect hash")
+ht_init(test_table);
+ht_frozen_t *frozen = malloc(sizeof(ht_frozen_t));
+INSERT_TEST_DATA(test_table)
+printf("Frozen: %s\n", ht_freeze(test_table, frozen) ? "yes" : "no");
+ht_delete_all(test_table);
+printf("Size: %zu, slots: %zu, buckets: %zu\n", frozen->size, frozen->slots,
+       frozen->buckets);
+for (int i = 0; i < 15; i++) {
+  printf("%s: ", TEST_DATA[i].key);
+  ht_print_item_value(ht_frozen_get(frozen, TEST_DATA[i].key));
+}
+ht_print_item_value(ht_frozen_get(frozen, "Monero"));
+ht_print_item_value(ht_frozen_get(frozen, ""));
+ht_frozen_dispose(frozen);
+printf("Empty frozen: %s\n", ht_freeze(test_table, frozen) ? "yes" : "no");
+ht_print_item_value(ht_frozen_get(frozen, "Bitcoin"));
+free(frozen);
+ENDTEST
+
+static float test_increment(float value) { return value + 1; }
+
+TEST(test_upsert, "Count keys with a single-probe upsert")
+ht_init(test_table);
+bool inserted;
+for (int round = 0; round < 3; round++) {
+  for (int i = round; i < 15; i += 2) {
+    ht_upsert(test_table, TEST_DATA[i].key, 1, test_increment);
+  }
+}
+float *slot = ht_get_or_insert(test_table, "Bitcoin", 0, &inserted);
+printf("Bitcoin inserted: %s, stable: %s\n", inserted ? "yes" : "no",
+       slot == ht_get(test_table, "Bitcoin") ? "yes" : "no");
+*slot += 10;
+slot = ht_get_or_insert(test_table, "Monero", 0.5, &inserted);
+printf("Monero inserted: %s\n", inserted ? "yes" : "no");
+ht_print_item_value(slot);
+ht_upsert(test_table, "Monero", 7, NULL);
+ht_print_table(test_table);
+ht_delete_all(test_table);
+ENDTEST
+
+TEST(test_bloom, "Reject missing keys with a Bloom filter")
+ht_init(test_table);
+ht_bloom_t *bloom = malloc(sizeof(ht_bloom_t));
+ht_bloom_init(bloom);
+for (int i = 0; i < 15; i++) {
+  ht_bloom_insert(bloom, TEST_DATA[i].key, TEST_DATA[i].value);
+}
+ht_bloom_insert(bloom, "Bitcoin", 60000);
+ht_print_item(ht_bloom_search(bloom, "Bitcoin"));
+ht_print_item_value(ht_bloom_get(bloom, "Terra"));
+ht_print_item_value(ht_bloom_get(bloom, "Monero"));
+ht_print_item_value(ht_bloom_get(bloom, "Stellar"));
+printf("Size: %zu, blocks: %zu, passed: %llu, rejected + false: %llu\n",
+       bloom->size, bloom->block_count,
+       (unsigned long long)bloom->stats.passed,
+       (unsigned long long)(bloom->stats.rejected +
+                            bloom->stats.false_positives));
+for (int i = 0; i < 8; i++) {
+  ht_bloom_delete(bloom, TEST_DATA[i].key);
+}
+ht_bloom_delete(bloom, "Monero");
+printf("Size: %zu, stale: %zu, rebuilds: %llu\n", bloom->size, bloom->stale,
+       (unsigned long long)bloom->stats.rebuilds);
+ht_print_item_value(ht_bloom_get(bloom, "Bitcoin"));
+ht_print_item_value(ht_bloom_get(bloom, "Chainlink"));
+ht_print_table(&bloom->table);
+ht_bloom_delete_all(bloom);
+free(bloom);
+ENDTEST
+
+#ifdef IAL_PERF
+
+TEST(test_perf_counters, "Count measured table operations")
+ht_perf_reset();
+ht_init(test_table);
+for (int i = 0; i < 5; i++) {
+  ht_insert(test_table, TEST_DATA[i].key, TEST_DATA[i].value);
+}
+ht_search(test_table, "Bitcoin");
+ht_get(test_table, "Terra");
+ht_delete(test_table, "XRP");
+printf("Calls: init %llu, insert %llu, search %llu, get %llu, delete %llu\n",
+       (unsigned long long)ht_perf_calls(HT_PERF_INIT),
+       (unsigned long long)ht_perf_calls(HT_PERF_INSERT),
+       (unsigned long long)ht_perf_calls(HT_PERF_SEARCH),
+       (unsigned long long)ht_perf_calls(HT_PERF_GET),
+       (unsigned long long)ht_perf_calls(HT_PERF_DELETE));
+ENDTEST
+
+#endif // IAL_PERF
+
 int main(int argc, char *argv[]) {
   init_uninitialized_item();
   init_test();
@@ -90,6 +425,22 @@ int main(int argc, char *argv[]) {
   test_get();
   test_delete();
   test_delete_all();
+  test_dump_binary();
+  test_ordered_range();
+  test_ordered_prefix();
+  test_cuckoo();
+  test_cuckoo_grow();
+  test_sharded();
+  test_cache_lru();
+  test_cache_ttl();
+  test_interned();
+  test_frozen();
+  test_upsert();
+  test_bloom();
+#ifdef IAL_PERF
+  test_perf_counters();
+#endif // IAL_PERF
 
   free(uninitialized_item);
+  HT_PERF_REPORT(stderr);
 }
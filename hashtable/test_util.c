@@ -1,53 +1,83 @@
 #include "test_util.h"
 #include "hashtable.h"
+#include "dump.h"
 #include <stdio.h>
 #include <stdlib.h>
 
 ht_item_t *uninitialized_item;
 
 void ht_print_item_value(float *value) {
+  writer_t writer;
+  writer_init(&writer, stdout);
   if (value != NULL) {
-    printf("%.2f\n", *value);
+    writer_float(&writer, *value, 2);
   } else {
-    printf("NULL\n");
+    writer_string(&writer, "NULL");
   }
+  writer_char(&writer, '\n');
+  writer_flush(&writer);
 }
 
 void ht_print_item(ht_item_t *item) {
+  writer_t writer;
+  writer_init(&writer, stdout);
   if (item != NULL) {
-    printf("(%s,%.2f)\n", item->key, item->value);
+    ht_write_item(&writer, item);
   } else {
-    printf("NULL\n");
+    writer_string(&writer, "NULL");
   }
+  writer_char(&writer, '\n');
+  writer_flush(&writer);
 }
 
 void ht_print_table(ht_table_t *table) {
   int max_count = 0;
   int sum_count = 0;
+  writer_t writer;
+  writer_init(&writer, stdout);
 
-  printf("------------HASH TABLE--------------\n");
+  writer_string(&writer, "------------HASH TABLE--------------\n");
   for (int i = 0; i < HT_SIZE; i++) {
-    printf("%i: ", i);
+    writer_int(&writer, i);
+    writer_string(&writer, ": ");
     int count = 0;
     ht_item_t *item = (*table)[i];
     while (item != NULL) {
-      printf("(%s,%.2f)", item->key, item->value);
+      ht_write_item(&writer, item);
       if (item != uninitialized_item) {
         count++;
       }
       item = item->next;
     }
-    printf("\n");
+    writer_char(&writer, '\n');
     if (count > max_count) {
       max_count = count;
     }
     sum_count += count;
   }
 
-  printf("------------------------------------\n");
-  printf("Total items in hash table: %i\n", sum_count);
-  printf("Maximum hash collisions: %i\n", max_count == 0 ? 0 : max_count - 1);
-  printf("------------------------------------\n");
+  writer_string(&writer, "------------------------------------\n");
+  writer_string(&writer, "Total items in hash table: ");
+  writer_int(&writer, sum_count);
+  writer_string(&writer, "\nMaximum hash collisions: ");
+  writer_int(&writer, max_count == 0 ? 0 : max_count - 1);
+  writer_string(&writer, "\n------------------------------------\n");
+  writer_flush(&writer);
+}
+
+void ht_print_iter(ht_ordered_iter_t *iter) {
+  writer_t writer;
+  writer_init(&writer, stdout);
+  int count = 0;
+  for (ht_item_t *item = ht_ordered_next(iter); item != NULL;
+       item = ht_ordered_next(iter)) {
+    ht_write_item(&writer, item);
+    count++;
+  }
+  writer_string(&writer, "\nItems: ");
+  writer_int(&writer, count);
+  writer_char(&writer, '\n');
+  writer_flush(&writer);
 }
 
 void init_uninitialized_item() {
@@ -2,6 +2,7 @@
 #define IAL_HASHTABLE_TEST_UTIL_H
 
 #include "hashtable.h"
+#include "ordered.h"
 
 #define TEST(NAME, DESCRIPTION)                                                \
   void NAME() {                                                                \
@@ -23,6 +24,7 @@ void ht_print_item_value(float *value);
 void ht_print_item(ht_item_t *item);
 void ht_print_table(ht_table_t *table);
 void ht_insert_many(ht_table_t *table, const ht_item_t items[], int count);
+void ht_print_iter(ht_ordered_iter_t *iter);
 
 void init_uninitialized_item();
 void init_test_table(ht_table_t **table);
@@ -0,0 +1,76 @@
+/*
+ * Vložení nebo úprava prvku jedním průchodem
+ *
+ * ht_insert volá ht_search a při neúspěchu počítá get_hash znovu; počítání
+ * výskytů přes ht_get a ht_insert tak prochází seznam synonym až třikrát.
+ * Funkce v tomto souboru spočítají index jednou a seznamem projdou jednou.
+ *
+ * Vrácený ukazatel na hodnotu zůstává platný až do odstranění prvku, protože
+ * se prvky v tabulce nepřesouvají. Tabulka je obyčejná ht_table_t a lze na
+ * ni volat i funkce z hashtable.c.
+ */
+
+#include "upsert.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Získání ukazatele na hodnotu prvku. Pokud prvek neexistuje, vloží se
+ * s hodnotou init na začátek seznamu synonym. Do inserted (pokud není NULL)
+ * se uloží, zda byl prvek vložen. Při nedostatku paměti vrací NULL.
+ */
+float *ht_get_or_insert(ht_table_t *table, char *key, float init,
+                        bool *inserted)
+{
+  int index = get_hash(key);
+
+  for (ht_item_t *item = (*table)[index]; item != NULL; item = item->next)
+  {
+    if (strcmp(item->key, key) == 0)
+    {
+      if (inserted != NULL)
+        *inserted = false;
+      return &item->value;
+    }
+  }
+
+  if (inserted != NULL)
+    *inserted = false;
+
+  size_t length = strlen(key) + 1;
+  ht_item_t *new_item = malloc(sizeof(ht_item_t));
+  if (new_item == NULL)
+    return NULL;
+  new_item->key = malloc(length);
+  if (new_item->key == NULL)
+  {
+    free(new_item);
+    return NULL;
+  }
+
+  memcpy(new_item->key, key, length);
+  new_item->value = init;
+  new_item->next = (*table)[index];
+  (*table)[index] = new_item;
+  if (inserted != NULL)
+    *inserted = true;
+  return &new_item->value;
+}
+
+/*
+ * Vložení prvku s hodnotou init, nebo nahrazení hodnoty existujícího prvku
+ * výsledkem update (pokud není NULL). Vrací ukazatel na hodnotu prvku, při
+ * nedostatku paměti NULL.
+ */
+float *ht_upsert(ht_table_t *table, char *key, float init,
+                 ht_update_t update)
+{
+  bool inserted;
+  float *value = ht_get_or_insert(table, key, init, &inserted);
+
+  if (value != NULL && !inserted && update != NULL)
+  {
+    *value = update(*value);
+  }
+  return value;
+}
@@ -0,0 +1,18 @@
+/*
+ * Hlavičkový soubor pro vložení nebo úpravu prvku jedním průchodem.
+ */
+
+#ifndef IAL_HASHTABLE_UPSERT_H
+#define IAL_HASHTABLE_UPSERT_H
+
+#include "hashtable.h"
+
+// Funkce vracející novou hodnotu existujícího prvku
+typedef float (*ht_update_t)(float value);
+
+float *ht_get_or_insert(ht_table_t *table, char *key, float init,
+                        bool *inserted);
+float *ht_upsert(ht_table_t *table, char *key, float init,
+                 ht_update_t update);
+
+#endif